@@ -26,6 +26,7 @@ Device Communication Protocol(pinout related) functions:
 Functions                    		Function
 ------------------------------------------------------------------
 init								Initializes clock to set up mode 0.
+SST25_SPI_Hz				Returns the SPI clock the driver runs at
 Send_Byte						Sends one byte using SI pin to send and shift out 1-bit per clock rising edge
 Send_Double_Byte		Sends one byte using SI pin to send and shift out 2-bit per clock rising edge
 Get_Byte						Receives one byte using SO pin to receive and shift in 1-bit per clock falling edge
@@ -59,13 +60,27 @@ Read											Reads one byte from the serial flash and returns byte(max of 25 M
 Read_Cont									Reads multiple bytes(max of 25 MHz CLK frequency)
 HighSpeed_Read						Reads one byte from the serial flash and returns byte(max of 66 MHz CLK frequency)
 HighSpeed_Read_Cont				Reads multiple bytes(max of 66 MHz CLK frequency)
+HighSpeed_Read_Data				Reads any number of bytes into a caller buffer
+HighSpeed_Read_Data_CRC		Reads into a caller buffer and updates a CRC-32 on the way
+HighSpeed_Read_Async			Starts a read that completes in the SPI event handler
+Read_Async_Busy						Tells whether a HighSpeed_Read_Async is on the bus
+HighSpeed_Read_Scatter		Reads a range in one transaction and scatters it over several buffers
+HighSpeed_Read_Hold				Long read that can be paused with HOLD# to lend the bus out
+Hold_Enable								Switches RST#/HOLD# to HOLD and installs the bus lending hooks
+Verify_Data								Compares a flash range against a buffer
+Program_Verify_Enable			Turns read-back verification of page programs on or off
 Page_Program							Programs 1 to 256 data bytes
+Page_Program_Data					Programs 1 to 256 data bytes from a caller buffer
 Dual_Input_Page_Program		Programs 1 to 256 data bytes using dual input
 Chip_Erase								Erases entire serial flash
 Sector_Erase							Erases one sector (4 KB) of the serial flash
 Block_Erase_32K						Erases 32 KByte block memory of the serial flash
 Block_Erase_64K						Erases 64 KByte block memory of the serial flash
 Wait_Busy									Polls status register until busy bit is low
+Wait_Busy_Timeout					Polls status register until busy bit is low or a deadline passes
+SST25_Recover							Resets the SPI master and the serial flash after a timeout or bus error
+SST25_Last_Error					Returns and clears the first error of the plain procedures
+ULBPR											Clears all block protection (SST26 parts only)
 EHLD											Enable Hold pin functionality */
                                                                      
 //"C" LANGUAGE DRIVERS 
@@ -87,18 +102,292 @@ EHLD											Enable Hold pin functionality */
 
 #include <stdio.h>
 #include <stdlib.h>
+#if defined(SST25_TRANSPORT_SPIDEV) || defined(SST25_TRANSPORT_MMAP)
+#include <string.h>
+#include "SST25VF064C_transport.h"
+#define delay_us(us)			sst25_transport_delay_us(us)
+#else
 #include "common.h"
 #include "app_error.h"
 #include "app_util_platform.h"
 #include "spi_master.h"
 #include "nrf_delay.h"
 #include "nrf_gpio.h"
+#include <string.h>
 #include "boards.h"
+#define delay_us(us)			nrf_delay_us(us)
+#endif
 #include "SST25VF064C.h"
+#include "SST25VF064C_crc32.h"
+#ifdef SST25_TRACE
+#include "SST25VF064C_trace.h"
+#endif
 
-unsigned char upper_128[128];	/* global array to store read data */
+unsigned char upper_128[SST25_PROG_CHUNK];	/* global array to store read data */
 unsigned char security_id_32[32];	/* global array to store security_id data */
 
+/* Transfers complete before bus_transfer returns: no completion event, no
+ * async read in flight. */
+#if defined(SST25_SPI_DIRECT) || defined(SST25_TRANSPORT_HOST)
+#define SST25_SPI_POLLED
+#endif
+
+#ifndef SST25_SPI_POLLED
+static volatile bool m_spi_busy = false;	/* set while a transfer is on the bus */
+static sst25_async_handler_t m_async_handler = NULL;	/* completion of HighSpeed_Read_Async */
+static uint8_t  m_async_cmd[SST25_ASYNC_HEADER];	/* command of the running async read */
+static uint16_t m_async_len;
+#ifdef SST25_TRACE
+static uint32_t m_async_t_start;
+#endif
+#endif
+static bool m_program_verify = false;		/* read back after every page program */
+#ifdef SST25_TRANSPORT_HOST
+#define SPI_FREQUENCY_MIN	1000000ul			/* SCK in Hz */
+#else
+#define SPI_FREQUENCY_MIN	SPI_FREQUENCY_FREQUENCY_M1
+#endif
+static uint32_t m_spi_frequency = SPI_FREQUENCY_MIN;	/* until the part is known */
+static bool m_read_fast = true;			/* 0Bh instead of 03h for the buffered reads */
+static uint32_t m_error = NRF_SUCCESS;		/* first error since SST25_Last_Error */
+static bool m_ehld = false;			/* RST#/HOLD# switched to HOLD by EHLD */
+static int16_t m_status_written = -1;		/* last WRSR byte, restored by SST25_Recover */
+#if SST25_HAS_ULBPR
+static bool m_ulbpr = false;			/* ULBPR issued, repeated by SST25_Recover */
+#endif
+
+sst25_health_t sst25_health;
+
+/* Keeps the first error for SST25_Last_Error and the *_Operation status. */
+static void note_error(uint32_t err_code)
+{
+	if (m_error == NRF_SUCCESS)
+	{
+		m_error = err_code;
+	}
+}
+
+static void bus_transfer(uint8_t const * p_tx_data, uint16_t tx_len, uint8_t * p_rx_data, uint16_t rx_len, bool cont);
+
+#ifdef SST25_RADIO_AWARE
+static volatile bool m_radio_active = false;	/* between radio notification ACTIVE and INACTIVE */
+
+/* Waits for the radio-idle window ahead of a transfer of len bytes, with
+ * the budget spi_wait gives such a transfer. A window that does not come,
+ * e.g. after a lost INACTIVE notification, is counted as bus error and
+ * noted as NRF_ERROR_TIMEOUT; the transfer must not be started then. */
+static bool radio_wait(uint16_t len)
+{
+	unsigned long limit_us = (((unsigned long)len * 16u) / (SST25_SPI_Hz() / 1000000ul)) + SST25_XFER_SLACK_US;
+	while (m_radio_active)
+	{
+		if (limit_us == 0)
+		{
+			sst25_health.bus_errors++;
+			note_error(NRF_ERROR_TIMEOUT);
+			return false;
+		}
+		delay_us(1);
+		limit_us--;
+	}
+	return true;
+}
+#endif
+
+#ifdef SST25_MANUAL_CS
+#if !defined(SST25_SPI_SS_PARK_PIN) && !defined(SST25_SPI_POLLED)
+#error "SST25_MANUAL_CS needs SST25_SPI_SS_PARK_PIN, a free pin the SPI master may toggle as its SS"
+#endif
+static sst25_hold_pending_t m_hold_pending = NULL;	/* HOLD mode hooks, see Hold_Enable */
+static sst25_hold_lend_t    m_hold_lend = NULL;
+static unsigned short       m_hold_chunk = 0;
+unsigned long               sst25_hold_count = 0;
+#endif
+
+
+#if defined(SST25_TRANSPORT_HOST)
+/* Transfers, chip select and pins are in SST25VF064C_transport.h. */
+#elif defined(SST25_SPI_DIRECT)
+#if defined(SPI_MASTER_0_ENABLE)
+#define SST25_SPI           NRF_SPI0
+#define SST25_SPI_SCK_PIN   SPIM0_SCK_PIN
+#define SST25_SPI_MOSI_PIN  SPIM0_MOSI_PIN
+#define SST25_SPI_MISO_PIN  SPIM0_MISO_PIN
+#else
+#define SST25_SPI           NRF_SPI1
+#define SST25_SPI_SCK_PIN   SPIM1_SCK_PIN
+#define SST25_SPI_MOSI_PIN  SPIM1_MOSI_PIN
+#define SST25_SPI_MISO_PIN  SPIM1_MISO_PIN
+#endif
+
+/**@brief Function for setting up the SPI peripheral for the polled engine.
+ *
+ * Mode 0, MSB first, no interrupt: the SDK spi_master is not opened.
+ */
+static void spi_direct_init(void)
+{
+    nrf_gpio_pin_clear(SST25_SPI_SCK_PIN);
+    nrf_gpio_cfg_output(SST25_SPI_SCK_PIN);
+    nrf_gpio_cfg_output(SST25_SPI_MOSI_PIN);
+    nrf_gpio_cfg_input(SST25_SPI_MISO_PIN, NRF_GPIO_PIN_NOPULL);
+
+    SST25_SPI->ENABLE       = (SPI_ENABLE_ENABLE_Disabled << SPI_ENABLE_ENABLE_Pos);
+    SST25_SPI->PSELSCK      = SST25_SPI_SCK_PIN;
+    SST25_SPI->PSELMOSI     = SST25_SPI_MOSI_PIN;
+    SST25_SPI->PSELMISO     = SST25_SPI_MISO_PIN;
+    SST25_SPI->FREQUENCY    = m_spi_frequency;
+    SST25_SPI->CONFIG       = (SPI_CONFIG_ORDER_MsbFirst << SPI_CONFIG_ORDER_Pos) |
+                              (SPI_CONFIG_CPHA_Leading << SPI_CONFIG_CPHA_Pos) |
+                              (SPI_CONFIG_CPOL_ActiveHigh << SPI_CONFIG_CPOL_Pos);
+    SST25_SPI->INTENCLR     = SPI_INTENCLR_READY_Msk;
+    SST25_SPI->EVENTS_READY = 0;
+    SST25_SPI->ENABLE       = (SPI_ENABLE_ENABLE_Enabled << SPI_ENABLE_ENABLE_Pos);
+}
+
+/**@brief Function for clocking one transfer through the double-buffered TXD/RXD.
+ *
+ * Two bytes are queued before the first READY event, and every READY
+ * queues the next byte before RXD is read, so the shifter never waits for
+ * the CPU as long as the loop body is shorter than one byte time. Reads
+ * (nothing to send) and writes (nothing to keep) have their own loops.
+ */
+static void spi_direct_transfer(uint8_t const * p_tx_data, uint16_t tx_len, uint8_t * p_rx_data, uint16_t rx_len)
+{
+    NRF_SPI_Type * p_spi = SST25_SPI;
+    uint16_t       len   = (tx_len > rx_len) ? tx_len : rx_len;
+    uint16_t       queued;
+    uint16_t       i;
+
+    if (len == 0)
+    {
+        return;
+    }
+    p_spi->EVENTS_READY = 0;
+    queued = (len > 1) ? 2 : 1;
+
+    if (tx_len == 0)
+    {
+        // Read: clock out 0xFF.
+        p_spi->TXD = 0xFF;
+        if (queued == 2)
+        {
+            p_spi->TXD = 0xFF;
+        }
+        for (i = 0; i < len; i++)
+        {
+            while (p_spi->EVENTS_READY == 0)
+            {
+            }
+            p_spi->EVENTS_READY = 0;
+            if (queued < len)
+            {
+                p_spi->TXD = 0xFF;
+                queued++;
+            }
+            p_rx_data[i] = (uint8_t)p_spi->RXD;
+        }
+    }
+    else if (rx_len == 0)
+    {
+        // Write: RXD has to be read, the bytes are dropped.
+        p_spi->TXD = p_tx_data[0];
+        if (queued == 2)
+        {
+            p_spi->TXD = p_tx_data[1];
+        }
+        for (i = 0; i < len; i++)
+        {
+            while (p_spi->EVENTS_READY == 0)
+            {
+            }
+            p_spi->EVENTS_READY = 0;
+            if (queued < len)
+            {
+                p_spi->TXD = p_tx_data[queued++];
+            }
+            (void)p_spi->RXD;
+        }
+    }
+    else
+    {
+        p_spi->TXD = p_tx_data[0];
+        if (queued == 2)
+        {
+            p_spi->TXD = (tx_len > 1) ? p_tx_data[1] : 0xFF;
+        }
+        for (i = 0; i < len; i++)
+        {
+            uint8_t byte;
+
+            while (p_spi->EVENTS_READY == 0)
+            {
+            }
+            p_spi->EVENTS_READY = 0;
+            if (queued < len)
+            {
+                p_spi->TXD = (queued < tx_len) ? p_tx_data[queued] : 0xFF;
+                queued++;
+            }
+            byte = (uint8_t)p_spi->RXD;
+            if (i < rx_len)
+            {
+                p_rx_data[i] = byte;
+            }
+        }
+    }
+}
+#else
+/* Ends the transfer on the bus; a HighSpeed_Read_Async is completed by
+ * releasing the chip select and calling its handler. */
+static void spi_transfer_done(void)
+{
+	if (m_async_handler != NULL)
+	{
+		sst25_async_handler_t handler = m_async_handler;
+
+		m_async_handler = NULL;
+#ifdef SST25_MANUAL_CS
+		CE_High();
+#ifdef SST25_TRACE
+		SST_Trace_Transfer(NULL, 0, m_async_len, m_async_t_start);
+#endif
+#elif defined(SST25_TRACE)
+		SST_Trace_Transfer(m_async_cmd, SST25_ASYNC_HEADER, SST25_ASYNC_HEADER + m_async_len, m_async_t_start);
+#endif
+		m_spi_busy = false;
+		handler();
+	}
+	else
+	{
+		m_spi_busy = false;
+	}
+}
+
+/* Waits for the transfer on the bus, at most twice the time len bytes take
+ * plus SST25_XFER_SLACK_US.  A transfer that does not complete by then is
+ * counted as bus error and ended as if it had, so the handler of an async
+ * read still runs (its data undefined) and nothing waits forever. */
+static void spi_wait(uint16_t len)
+{
+	unsigned long limit_us = (((unsigned long)len * 16u) / (SST25_SPI_Hz() / 1000000ul)) + SST25_XFER_SLACK_US;
+	while (m_spi_busy)
+	{
+		if (limit_us == 0)
+		{
+			CRITICAL_REGION_ENTER();
+			if (m_spi_busy)
+			{
+				sst25_health.bus_errors++;
+				note_error(NRF_ERROR_TIMEOUT);
+				spi_transfer_done();
+			}
+			CRITICAL_REGION_EXIT();
+			return;
+		}
+		nrf_delay_us(1);
+		limit_us--;
+	}
+}
 
 /**@brief Function for SPI master event callback.
  *
@@ -118,6 +407,7 @@ static void spi_master_event_handler(spi_master_evt_t spi_master_evt)
         
             //Inform application that transfer is completed.
             //m_transfer_completed = true;
+            spi_transfer_done();
             break;
         
         default:
@@ -125,18 +415,320 @@ static void spi_master_event_handler(spi_master_evt_t spi_master_evt)
             break;
     }
 }
+#endif /* SST25_TRANSPORT_HOST, SST25_SPI_DIRECT */
+
+/**@brief Function for running one SPI transaction to completion.
+ *
+ * Starts the transfer and waits for the SPI master completion event, so a
+ * command returns as soon as its bytes are on the bus. The device may still
+ * be busy programming or erasing afterwards; see Wait_Busy(). The flash chip
+ * select is not touched, so other devices on the bus can use this as well.
+ * With SST25_TRACE every transfer is recorded, see SST25VF064C_trace.h.
+ *
+ * @param[in]  p_tx_data  Command, address and data bytes to send.
+ * @param[in]  tx_len     Number of bytes to send.
+ * @param[out] p_rx_data  Buffer for the bytes clocked in, including the
+ *                        ones received while the command was sent.
+ * @param[in]  rx_len     Number of bytes to clock in.
+ */
+void SPI_Bus_Transfer(uint8_t const * p_tx_data, uint16_t tx_len, uint8_t * p_rx_data, uint16_t rx_len)
+{
+	bus_transfer(p_tx_data, tx_len, p_rx_data, rx_len, false);
+}
+
+/* SPI_Bus_Transfer body; cont marks a later segment of a scatter-gather	*/
+/* transaction for the trace recorder.						*/
+static void bus_transfer(uint8_t const * p_tx_data, uint16_t tx_len, uint8_t * p_rx_data, uint16_t rx_len, bool cont)
+{
+#ifdef SST25_RADIO_AWARE
+	if (!radio_wait((tx_len > rx_len) ? tx_len : rx_len))
+	{
+		return;
+	}
+#endif
+#ifdef SST25_TRACE
+	uint32_t t_start = SST_Trace_Time();
+#endif
+#if defined(SST25_TRANSPORT_HOST)
+	uint32_t err_code = sst25_transport_xfer(p_tx_data, tx_len, p_rx_data, rx_len);
+	if (err_code != NRF_SUCCESS)
+	{
+		sst25_health.bus_errors++;
+		note_error(err_code);
+	}
+#elif defined(SST25_SPI_DIRECT)
+	spi_direct_transfer(p_tx_data, tx_len, p_rx_data, rx_len);
+#else
+	spi_wait(SST25_ASYNC_HEADER + m_async_len);	/* a HighSpeed_Read_Async still on the bus */
+	m_spi_busy = true;
+	uint32_t err_code = spi_master_send_recv(SPI_MASTER_HW, p_tx_data, tx_len, p_rx_data, rx_len);
+	if (err_code != NRF_SUCCESS)
+	{
+		m_spi_busy = false;
+		sst25_health.bus_errors++;
+		note_error(err_code);
+	}
+	spi_wait((tx_len > rx_len) ? tx_len : rx_len);	/* SPI_MASTER_EVT_TRANSFER_COMPLETED */
+#endif
+#ifdef SST25_TRACE
+	SST_Trace_Transfer(cont ? NULL : p_tx_data, tx_len, rx_len, t_start);
+#else
+	(void)cont;
+#endif
+}
+
+#ifdef SST25_RADIO_AWARE
+/**@brief Function for passing radio notifications to the driver.
+ *
+ * Register this as the handler of the SDK's ble_radio_notification module,
+ * configured with NRF_RADIO_NOTIFICATION_TYPE_INT_ON_BOTH. The ACTIVE signal
+ * arrives the notification distance before the radio starts, so a transfer
+ * started while idle and no longer than SST25_RADIO_MAX_XFER bytes ends
+ * before the radio event. Longer reads and page programs are split by the
+ * driver, and busy polls are gated the same way. A transfer waits for the
+ * idle window no longer than a lost completion would be waited for; then it
+ * is not started and SST25_Last_Error returns NRF_ERROR_TIMEOUT.
+ *
+ * @param[in] radio_active  true before a radio event, false after it.
+ */
+void SST25_Radio_Notification(bool radio_active)
+{
+	m_radio_active = radio_active;
+}
+#endif /* SST25_RADIO_AWARE */
+
+/**@brief Function for running one flash command as a single transaction.
+ *
+ * With SST25_MANUAL_CS the chip select is driven here, otherwise the SPI
+ * master asserts it for the duration of the transfer.
+ */
+static void spi_transfer(uint8_t const * p_tx_data, uint16_t tx_len, uint8_t * p_rx_data, uint16_t rx_len)
+{
+#ifdef SST25_MANUAL_CS
+	CE_Low();
+	SPI_Bus_Transfer(p_tx_data, tx_len, p_rx_data, rx_len);
+	CE_High();
+#else
+	SPI_Bus_Transfer(p_tx_data, tx_len, p_rx_data, rx_len);
+#endif
+}
+
+#ifdef SST25_MANUAL_CS
+static const uint8_t m_sg_fill[16] = {0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF};
+#else
+static uint8_t m_sg_staging[SST25_SG_STAGING];	/* gather/scatter buffer when CS cannot be held */
+#endif
+
+/**@brief Function for running one flash command from several buffers.
+ *
+ * The segments are clocked back to back under one chip select assertion,
+ * so a command header and the caller's payload need not be contiguous.
+ * With SST25_MANUAL_CS every segment is its own SPI master transfer and no
+ * byte is copied. Otherwise the SPI master drops SS between transfers, so
+ * the segments are gathered into a static staging buffer of
+ * SST25_SG_STAGING bytes, sent as one transfer and scattered back. Segments
+ * that do not fit are not sent; SST25_Last_Error reports
+ * NRF_ERROR_DATA_SIZE.
+ *
+ * @param[in] p_sg   Segments in bus order.
+ * @param[in] count  Number of segments.
+ */
+void SPI_Transfer_SG(sst25_sg_t const * p_sg, uint8_t count)
+{
+	uint8_t i;
+#ifdef SST25_MANUAL_CS
+	CE_Low();
+	for (i = 0; i < count; i++)
+	{
+		if (p_sg[i].len == 0)
+		{
+			continue;
+		}
+		if (p_sg[i].p_tx != NULL)
+		{
+			/* rx_len 0 leaves the buffer untouched, it only has to be valid */
+			bus_transfer(p_sg[i].p_tx, p_sg[i].len,
+			             (p_sg[i].p_rx != NULL) ? p_sg[i].p_rx : (uint8_t *)p_sg[i].p_tx,
+			             (p_sg[i].p_rx != NULL) ? p_sg[i].len : 0, (i != 0));
+		}
+		else if (p_sg[i].p_rx != NULL)
+		{
+			bus_transfer(p_sg[i].p_rx, 0, p_sg[i].p_rx, p_sg[i].len, (i != 0));
+		}
+		else
+		{
+			uint16_t left = p_sg[i].len;
+			while (left)			/* dummy bytes */
+			{
+				uint16_t n = (left > sizeof(m_sg_fill)) ? sizeof(m_sg_fill) : left;
+				bus_transfer(m_sg_fill, n, (uint8_t *)m_sg_fill, 0, (i != 0));
+				left -= n;
+			}
+		}
+	}
+	CE_High();
+#else
+	uint16_t len = 0;
+	for (i = 0; i < count; i++)
+	{
+		if ((len + p_sg[i].len) > SST25_SG_STAGING)
+		{
+			note_error(NRF_ERROR_DATA_SIZE);
+			return;
+		}
+		if (p_sg[i].p_tx != NULL)
+		{
+			memcpy(&m_sg_staging[len], p_sg[i].p_tx, p_sg[i].len);
+		}
+		else
+		{
+			memset(&m_sg_staging[len], 0xFF, p_sg[i].len);
+		}
+		len += p_sg[i].len;
+	}
+	SPI_Bus_Transfer(m_sg_staging, len, m_sg_staging, len);
+	len = 0;
+	for (i = 0; i < count; i++)
+	{
+		if (p_sg[i].p_rx != NULL)
+		{
+			memcpy(p_sg[i].p_rx, &m_sg_staging[len], p_sg[i].len);
+		}
+		len += p_sg[i].len;
+	}
+#endif
+}
+
+#ifdef SST25_TRANSPORT_HOST
+/* Host transport clock for at most mhz, in Hz. */
+static uint32_t spi_frequency(uint8_t mhz)
+{
+	return (uint32_t)mhz * 1000000ul;
+}
+#else
+/* nRF51 SPI master clock setting for at most mhz. */
+static uint32_t spi_frequency(uint8_t mhz)
+{
+	if (mhz >= 8)
+	{
+		return SPI_FREQUENCY_FREQUENCY_M8;
+	}
+	if (mhz >= 4)
+	{
+		return SPI_FREQUENCY_FREQUENCY_M4;
+	}
+	if (mhz >= 2)
+	{
+		return SPI_FREQUENCY_FREQUENCY_M2;
+	}
+	return SPI_FREQUENCY_FREQUENCY_M1;
+}
+#endif
 
 /**@brief Function for SST25VF064C_ initialization.
  *
- * This initialize SST25VF064C
+ * Opens the SPI master at 1 MHz, reads the JEDEC ID and selects the
+ * matching profile (sst25_profile). The SPI master is then reopened at the
+ * fastest clock the part and SST25_SPI_MHZ_MAX allow, the buffered reads
+ * use Read (03h), which needs no dummy byte, when that clock is within its
+ * limit and High-Speed-Read (0Bh) otherwise, and parts without Page-Program
+ * are programmed with AAI.
  *
- * @param[in] spi_master_evt    SPI master driver event.
-*/
-void SST25VF064C_init(void)
+ * @retval NRF_SUCCESS          Part identified.
+ * @retval NRF_ERROR_NOT_FOUND  Unknown JEDEC ID, the compile-time part is assumed.
+ * @return Any other error of spi_master_open, the SPI master is closed.
+ */
+uint32_t SST25VF064C_init(void)
 {
-	spi_master_init(SPI_MASTER_HW,spi_master_event_handler,false);
+	uint32_t err_code = NRF_SUCCESS;
+	const sst25_profile_t * p_profile;
+	uint8_t mhz;
+#if defined(SST25_TRANSPORT_HOST)
+	m_spi_frequency = SPI_FREQUENCY_MIN;
+	sst25_transport_clock(m_spi_frequency);
+#else
+#ifdef SST25_MANUAL_CS
+	nrf_gpio_pin_set(SST25_CS_PIN);
+	nrf_gpio_cfg_output(SST25_CS_PIN);
+#endif
+	m_spi_frequency = SPI_FREQUENCY_MIN;
+#ifdef SST25_SPI_DIRECT
+	spi_direct_init();
+#else
+	err_code = spi_master_init(SPI_MASTER_HW,spi_master_event_handler,false);
+	if (err_code != NRF_SUCCESS)
+	{
+		return err_code;
+	}
+#endif
+#endif /* SST25_TRANSPORT_HOST */
+
+	p_profile = SST25_Profile_Find(Jedec_ID_Read());
+	if (p_profile == NULL)
+	{
+		p_profile = SST25_Profile_Find(SST25_JEDEC_ID);
+		err_code = NRF_ERROR_NOT_FOUND;
+	}
+	sst25_profile = p_profile;
+
+	mhz = (p_profile->fast_read_mhz < SST25_SPI_MHZ_MAX) ? p_profile->fast_read_mhz : SST25_SPI_MHZ_MAX;
+	m_read_fast = (mhz > p_profile->read_mhz);
+	if (spi_frequency(mhz) != m_spi_frequency)
+	{
+		m_spi_frequency = spi_frequency(mhz);
+#if defined(SST25_TRANSPORT_HOST)
+		sst25_transport_clock(m_spi_frequency);
+#elif defined(SST25_SPI_DIRECT)
+		SST25_SPI->FREQUENCY = m_spi_frequency;
+#else
+		uint32_t open_err_code;
+
+		spi_master_close(SPI_MASTER_HW);
+		open_err_code = spi_master_init(SPI_MASTER_HW,spi_master_event_handler,false);
+		if (open_err_code != NRF_SUCCESS)
+		{
+			return open_err_code;
+		}
+#endif
+	}
+	return err_code;
 }
 
+/**@brief Function for reading the SPI clock selected by SST25VF064C_init.
+ *
+ * @return SCK frequency in Hz.
+ */
+unsigned long SST25_SPI_Hz(void)
+{
+#ifdef SST25_TRANSPORT_HOST
+	return m_spi_frequency;
+#else
+	switch (m_spi_frequency)
+	{
+		case SPI_FREQUENCY_FREQUENCY_M8:
+			return 8000000ul;
+		case SPI_FREQUENCY_FREQUENCY_M4:
+			return 4000000ul;
+		case SPI_FREQUENCY_FREQUENCY_M2:
+			return 2000000ul;
+		default:
+			return 1000000ul;
+	}
+#endif
+}
+
+/* Builds the read command the profile selected for Dst, returns its length. */
+static uint16_t read_command(uint8_t * p_tx_data, unsigned long Dst)
+{
+	p_tx_data[0] = m_read_fast ? 0x0B : 0x03;
+	p_tx_data[1] = ((Dst & SST25_ADDR_MASK) >> 16);
+	p_tx_data[2] = ((Dst & 0xFFFF) >> 8);
+	p_tx_data[3] = (Dst & 0xFF);
+	p_tx_data[4] = 0xFF;				/* dummy byte of 0Bh */
+	return m_read_fast ? 5 : 4;
+}
+
+#ifndef SST25_TRANSPORT_HOST
 /************************************************************************/
 /* PROCEDURE: init							*/
 /*									*/
@@ -154,8 +746,10 @@ void SST25VF064C_init(void)
  * @param[in] spi_master_instance       An instance of SPI master module.
  * @param[in] spi_master_event_handler  An event handler for SPI master events.
  * @param[in] lsb                       Bits order LSB if true, MSB if false.
+ *
+ * @return NRF_SUCCESS, or the error of spi_master_open.
  */
-void spi_master_init(spi_master_hw_instance_t spi_master_instance, 
+uint32_t spi_master_init(spi_master_hw_instance_t spi_master_instance, 
                             spi_master_event_handler_t spi_master_event_handler,
                             const bool lsb)
 {
@@ -163,6 +757,7 @@ void spi_master_init(spi_master_hw_instance_t spi_master_instance,
 
     //Configure SPI master.
     spi_master_config_t spi_config = SPI_MASTER_INIT_DEFAULT;
+    spi_config.SPI_Freq = m_spi_frequency;
     
     switch (spi_master_instance)
     {
@@ -172,7 +767,11 @@ void spi_master_init(spi_master_hw_instance_t spi_master_instance,
             spi_config.SPI_Pin_SCK = SPIM0_SCK_PIN;
             spi_config.SPI_Pin_MISO = SPIM0_MISO_PIN;
             spi_config.SPI_Pin_MOSI = SPIM0_MOSI_PIN;
+#ifdef SST25_SPI_SS_PARK_PIN
+            spi_config.SPI_Pin_SS = SST25_SPI_SS_PARK_PIN;
+#else
             spi_config.SPI_Pin_SS = SPIM0_SS_PIN;
+#endif
         }
         break; 
         #endif /* SPI_MASTER_0_ENABLE */
@@ -183,7 +782,11 @@ void spi_master_init(spi_master_hw_instance_t spi_master_instance,
             spi_config.SPI_Pin_SCK = SPIM1_SCK_PIN;
             spi_config.SPI_Pin_MISO = SPIM1_MISO_PIN;
             spi_config.SPI_Pin_MOSI = SPIM1_MOSI_PIN;
+#ifdef SST25_SPI_SS_PARK_PIN
+            spi_config.SPI_Pin_SS = SST25_SPI_SS_PARK_PIN;
+#else
             spi_config.SPI_Pin_SS = SPIM1_SS_PIN;
+#endif
         }
         break;
         #endif /* SPI_MASTER_1_ENABLE */
@@ -195,12 +798,68 @@ void spi_master_init(spi_master_hw_instance_t spi_master_instance,
     spi_config.SPI_CONFIG_ORDER = (lsb ? SPI_CONFIG_ORDER_LsbFirst : SPI_CONFIG_ORDER_MsbFirst);
     
     err_code = spi_master_open(spi_master_instance, &spi_config);
-    APP_ERROR_CHECK(err_code);
+    if (err_code != NRF_SUCCESS)
+    {
+        return err_code;
+    }
     
     //Register event handler for SPI master.
     spi_master_evt_handler_reg(spi_master_instance, spi_master_event_handler);
+    return NRF_SUCCESS;
+}
+#endif /* SST25_TRANSPORT_HOST */
+
+#ifdef SST25_MANUAL_CS
+/************************************************************************/
+/* PROCEDURE: CE_High()							*/
+/*									*/
+/* This procedure set CE = High.  Only available with SST25_MANUAL_CS,	*/
+/* otherwise the SPI master drives the chip select itself.		*/
+/*									*/
+/* Input:								*/
+/*		None							*/
+/*									*/
+/* Output:								*/
+/*		CE							*/
+/************************************************************************/
+void CE_High(void)
+{
+#ifdef SST25_TRANSPORT_HOST
+	uint32_t err_code = sst25_transport_select(false);	/* set CE high */
+	if (err_code != NRF_SUCCESS)
+	{
+		sst25_health.bus_errors++;
+		note_error(err_code);
+	}
+#else
+	nrf_gpio_pin_set(SST25_CS_PIN);				/* set CE high */
+#endif
 }
 
+/************************************************************************/
+/* PROCEDURE: CE_Low()							*/
+/*									*/
+/* This procedure drives the CE of the device to low.  			*/
+/*									*/
+/* Input:								*/
+/*		None							*/
+/*									*/
+/* Output:								*/
+/*		CE							*/
+/************************************************************************/
+void CE_Low(void)
+{
+#if defined(SST25_TRANSPORT_HOST)
+	(void)sst25_transport_select(true);			/* clear CE low */
+#else
+#ifndef SST25_SPI_DIRECT
+	spi_wait(SST25_ASYNC_HEADER + m_async_len);	/* a HighSpeed_Read_Async still holds CE low */
+#endif
+	nrf_gpio_pin_clear(SST25_CS_PIN);			/* clear CE low */
+#endif
+}
+#endif /* SST25_MANUAL_CS */
+
 /************************************************************************/
 /* PROCEDURE: Reset_Hold_Low()						*/
 /*									*/
@@ -214,8 +873,12 @@ void spi_master_init(spi_master_hw_instance_t spi_master_instance,
 /************************************************************************/
 void Reset_Hold_Low(void)
 {
+#ifdef SST25_TRANSPORT_HOST
+	sst25_transport_pin(SST25_TRANSPORT_PIN_RESET_HOLD, false);	/* clear Hold pin */
+#else
 	nrf_gpio_cfg_output(RESET_HOLD_PIN);
 	nrf_gpio_pin_clear(RESET_HOLD_PIN);				/* clear Hold pin */
+#endif
 }
 
 /************************************************************************/
@@ -231,8 +894,12 @@ void Reset_Hold_Low(void)
 /************************************************************************/
 void Reset_Hold_High(void)
 {
+#ifdef SST25_TRANSPORT_HOST
+	sst25_transport_pin(SST25_TRANSPORT_PIN_RESET_HOLD, true);	/* set Hold pin */
+#else
 	nrf_gpio_cfg_output(RESET_HOLD_PIN);
 	nrf_gpio_pin_set(RESET_HOLD_PIN);				/* set Hold pin */
+#endif
 }
 
 /************************************************************************/
@@ -248,8 +915,12 @@ void Reset_Hold_High(void)
 /************************************************************************/
 void WP_Low(void)
 {
+#ifdef SST25_TRANSPORT_HOST
+	sst25_transport_pin(SST25_TRANSPORT_PIN_WP, false);	/* clear WP pin */
+#else
 	nrf_gpio_cfg_output(WRITE_PROTECT_PIN);
 	nrf_gpio_pin_clear(WRITE_PROTECT_PIN);					/* clear WP pin */
+#endif
 }
 
 /************************************************************************/
@@ -265,8 +936,12 @@ void WP_Low(void)
 /************************************************************************/
 void WP_High(void)
 {
+#ifdef SST25_TRANSPORT_HOST
+	sst25_transport_pin(SST25_TRANSPORT_PIN_WP, true);	/* set WP pin */
+#else
 	nrf_gpio_cfg_output(WRITE_PROTECT_PIN);
 	nrf_gpio_pin_set(WRITE_PROTECT_PIN);				/* set WP pin */
+#endif
 }
 
 /************************************************************************/
@@ -285,9 +960,7 @@ unsigned char Read_Status_Register(void)
 	unsigned char byte = 0;
 	uint8_t  p_tx_data[1]={0x05};
 	uint8_t  p_rx_data[sizeof(p_tx_data)+1];
-	uint32_t err_code = spi_master_send_recv(SPI_MASTER_HW, p_tx_data, sizeof(p_tx_data), p_rx_data,sizeof(p_rx_data));
-  APP_ERROR_CHECK(err_code);
-	nrf_delay_ms(DELAY_MS);
+	spi_transfer(p_tx_data, sizeof(p_tx_data), p_rx_data, sizeof(p_rx_data));
 	//Send_Byte(0x05);			/* send RDSR command */
 	byte = p_rx_data[sizeof(p_tx_data)+0];			/* receive byte */
 	return byte;
@@ -308,9 +981,7 @@ void EWSR(void)
 {
 	uint8_t  p_tx_data[1]={0x50};
 	uint8_t  p_rx_data[sizeof(p_tx_data)+0];
-	uint32_t err_code = spi_master_send_recv(SPI_MASTER_HW, p_tx_data, sizeof(p_tx_data), p_rx_data,sizeof(p_rx_data));
-  APP_ERROR_CHECK(err_code);
-	nrf_delay_ms(DELAY_MS);
+	spi_transfer(p_tx_data, sizeof(p_tx_data), p_rx_data, sizeof(p_rx_data));
 }
 
 /************************************************************************/
@@ -326,11 +997,10 @@ void EWSR(void)
 /************************************************************************/
 void WRSR(uint8_t  byte)
 {
+	m_status_written = byte;
 	uint8_t  p_tx_data[2]={0x01,byte};
 	uint8_t  p_rx_data[sizeof(p_tx_data)+0];
-	uint32_t err_code = spi_master_send_recv(SPI_MASTER_HW, p_tx_data, sizeof(p_tx_data), p_rx_data,sizeof(p_rx_data));
-  APP_ERROR_CHECK(err_code);
-	nrf_delay_ms(DELAY_MS);
+	spi_transfer(p_tx_data, sizeof(p_tx_data), p_rx_data, sizeof(p_rx_data));
 	//Send_Byte(0x01);			/* select write to status register */
 	//Send_Byte(byte);			/* data that will change the status of BPx or BPL (only bits 2,3,4,5,7 can be written) */
 }
@@ -351,9 +1021,7 @@ void WREN(void)
 {
 	uint8_t p_tx_data[1]={0x06};
 	uint8_t  p_rx_data[sizeof(p_tx_data)+0];
-	uint32_t err_code = spi_master_send_recv(SPI_MASTER_HW, p_tx_data, sizeof(p_tx_data), p_rx_data,sizeof(p_rx_data));
-	APP_ERROR_CHECK(err_code);
-	nrf_delay_ms(DELAY_MS);
+	spi_transfer(p_tx_data, sizeof(p_tx_data), p_rx_data, sizeof(p_rx_data));
 	//Send_Byte(0x06);			/* send WREN command */
 }
 
@@ -372,9 +1040,7 @@ void WRDI(void)
 {
 	uint8_t p_tx_data[1]={0x04};
 	uint8_t  p_rx_data[sizeof(p_tx_data)+0];
-	uint32_t err_code = spi_master_send_recv(SPI_MASTER_HW, p_tx_data, sizeof(p_tx_data), p_rx_data,sizeof(p_rx_data));
-	APP_ERROR_CHECK(err_code);
-	nrf_delay_ms(DELAY_MS);
+	spi_transfer(p_tx_data, sizeof(p_tx_data), p_rx_data, sizeof(p_rx_data));
 	//Send_Byte(0x04);			/* send WRDI command */
 }
 
@@ -401,9 +1067,7 @@ unsigned long Read_ID(uint8_t ID_addr)
 	unsigned long temp=0;
 	uint8_t  p_tx_data[4]={0x90,0x00,0x00,ID_addr};
 	uint8_t  p_rx_data[sizeof(p_tx_data)+2];
-	uint32_t err_code = spi_master_send_recv(SPI_MASTER_HW, p_tx_data, sizeof(p_tx_data), p_rx_data,sizeof(p_rx_data));
-	APP_ERROR_CHECK(err_code);
-	nrf_delay_ms(DELAY_MS);
+	spi_transfer(p_tx_data, sizeof(p_tx_data), p_rx_data, sizeof(p_rx_data));
 //	Send_Byte(0x90);			/* send read ID command (90h or ABh) */
 //  Send_Byte(0x00);			/* send address */
 //	Send_Byte(0x00);			/* send address */
@@ -437,9 +1101,7 @@ unsigned long Jedec_ID_Read(void)
 	//temp = (temp | Get_Byte()); 	 	/* temp value = 0xBF254B */
 	uint8_t  p_tx_data[1]={0x9F};
 	uint8_t  p_rx_data[sizeof(p_tx_data)+3];
-	uint32_t err_code = spi_master_send_recv(SPI_MASTER_HW, p_tx_data, sizeof(p_tx_data), p_rx_data,sizeof(p_rx_data));
-	APP_ERROR_CHECK(err_code);
-	nrf_delay_ms(DELAY_MS);
+	spi_transfer(p_tx_data, sizeof(p_tx_data), p_rx_data, sizeof(p_rx_data));
 	temp = (temp | p_rx_data[0+sizeof(p_tx_data)]) << 8; 	/* receive byte */
 	temp = (temp | p_rx_data[1+sizeof(p_tx_data)]) << 8;	
 	temp = (temp | p_rx_data[2+sizeof(p_tx_data)]); 	 	/* temp value = 0xBF254B */
@@ -465,11 +1127,9 @@ unsigned long Jedec_ID_Read(void)
 unsigned char Read(unsigned long Dst) 
 {
 	unsigned char byte = 0;	
-	uint8_t p_tx_data[4]={0x03,((Dst & 0xFFFFFF) >> 16),((Dst & 0xFFFF) >> 8),(Dst & 0xFF)};
+	uint8_t p_tx_data[4]={0x03,((Dst & SST25_ADDR_MASK) >> 16),((Dst & 0xFFFF) >> 8),(Dst & 0xFF)};
 	uint8_t  p_rx_data[sizeof(p_tx_data)+1];
-	uint32_t err_code = spi_master_send_recv(SPI_MASTER_HW, p_tx_data, sizeof(p_tx_data), p_rx_data,sizeof(p_rx_data));
-	APP_ERROR_CHECK(err_code);
-	nrf_delay_ms(DELAY_MS);
+	spi_transfer(p_tx_data, sizeof(p_tx_data), p_rx_data, sizeof(p_rx_data));
 	
 	//Send_Byte(0x03); 			/* read command */
 	//Send_Byte(((Dst & 0xFFFFFF) >> 16));	/* send 3 address bytes */
@@ -495,20 +1155,13 @@ unsigned char Read(unsigned long Dst)
 /************************************************************************/
 void Read_Cont(unsigned long Dst, unsigned long no_bytes)
 {
-	unsigned long i = 0;
-	uint8_t p_tx_data[4]={0x03,((Dst & 0xFFFFFF) >> 16),((Dst & 0xFFFF) >> 8),(Dst & 0xFF)};
-	uint8_t  p_rx_data[sizeof(p_tx_data)+no_bytes];
-	uint32_t err_code = spi_master_send_recv(SPI_MASTER_HW, p_tx_data, sizeof(p_tx_data), p_rx_data,sizeof(p_rx_data));
-	APP_ERROR_CHECK(err_code);
-	nrf_delay_ms(DELAY_MS);
+	uint8_t p_tx_data[4]={0x03,((Dst & SST25_ADDR_MASK) >> 16),((Dst & 0xFFFF) >> 8),(Dst & 0xFF)};
+	sst25_sg_t sg[2]={{p_tx_data, NULL, sizeof(p_tx_data)},{NULL, upper_128, (uint16_t)no_bytes}};
+	SPI_Transfer_SG(sg, 2);			/* receive bytes straight into upper_128 */
 	//Send_Byte(0x03); 			/* read command */
 	//Send_Byte(((Dst & 0xFFFFFF) >> 16)); 	/* send 3 address bytes */
 	//Send_Byte(((Dst & 0xFFFF) >> 8));
 	//Send_Byte(Dst & 0xFF);
-	for (i = 0; i < no_bytes; i++)		/* read until no_bytes is reached */
-	{
-		upper_128[i] = p_rx_data[i+sizeof(p_tx_data)];	/* receive bytes */
-	}
 }
 
 /************************************************************************/
@@ -530,11 +1183,9 @@ void Read_Cont(unsigned long Dst, unsigned long no_bytes)
 unsigned char HighSpeed_Read(unsigned long Dst) 
 {
 	unsigned char byte = 0;	
-	uint8_t p_tx_data[5]={0x0B,((Dst & 0xFFFFFF) >> 16),((Dst & 0xFFFF) >> 8),(Dst & 0xFF),0xFF};
+	uint8_t p_tx_data[5]={0x0B,((Dst & SST25_ADDR_MASK) >> 16),((Dst & 0xFFFF) >> 8),(Dst & 0xFF),0xFF};
 	uint8_t  p_rx_data[sizeof(p_tx_data)+1];
-	uint32_t err_code = spi_master_send_recv(SPI_MASTER_HW, p_tx_data, sizeof(p_tx_data), p_rx_data,sizeof(p_rx_data));
-	APP_ERROR_CHECK(err_code);
-	nrf_delay_ms(DELAY_MS);
+	spi_transfer(p_tx_data, sizeof(p_tx_data), p_rx_data, sizeof(p_rx_data));
 	//Send_Byte(0x0B); 			/* read command */
 	//Send_Byte(((Dst & 0xFFFFFF) >> 16));	/* send 3 address bytes */
 	//Send_Byte(((Dst & 0xFFFF) >> 8));
@@ -560,24 +1211,357 @@ unsigned char HighSpeed_Read(unsigned long Dst)
 /************************************************************************/
 void HighSpeed_Read_Cont(unsigned long Dst, unsigned long no_bytes)
 {
-	unsigned long i = 0;
-	uint8_t  p_tx_data[5]={0x0B,((Dst & 0xFFFFFF) >> 16),((Dst & 0xFFFF) >> 8),(Dst & 0xFF),0xFF};
-	uint8_t  p_rx_data[sizeof(p_tx_data)+no_bytes];
-	uint32_t err_code = spi_master_send_recv(SPI_MASTER_HW, p_tx_data, sizeof(p_tx_data), p_rx_data,sizeof(p_rx_data));
-	APP_ERROR_CHECK(err_code);
-	nrf_delay_ms(DELAY_MS);
+	uint8_t  p_tx_data[5]={0x0B,((Dst & SST25_ADDR_MASK) >> 16),((Dst & 0xFFFF) >> 8),(Dst & 0xFF),0xFF};
+	sst25_sg_t sg[2]={{p_tx_data, NULL, sizeof(p_tx_data)},{NULL, upper_128, (uint16_t)no_bytes}};
+	SPI_Transfer_SG(sg, 2);			/* receive bytes straight into upper_128 */
 	//Send_Byte(0x0B); 			/* read command */
 	//Send_Byte(((Dst & 0xFFFFFF) >> 16)); 	/* send 3 address bytes */
 	//Send_Byte(((Dst & 0xFFFF) >> 8));
 	//Send_Byte(Dst & 0xFF);
 	//Send_Byte(0xFF);			/*dummy byte*/
-	for (i = 0; i < no_bytes; i++)		/* read until no_bytes is reached */
+}
+
+
+
+/************************************************************************/
+/* PROCEDURE:	HighSpeed_Read_Data					*/
+/*									*/		
+/* This procedure reads multiple addresses of the device into a caller	*/
+/* buffer.  Any length can be read; the data is fetched in transactions	*/
+/* of up to SST25_READ_BURST bytes.					*/
+/*									*/
+/* Input:								*/
+/*		Dst:		Destination Address 000000H - 7FFFFFH	*/
+/*		p_data:		Buffer for the data read		*/
+/*      	no_bytes	Number of bytes to read			*/
+/*									*/
+/* Returns:								*/
+/*		Nothing							*/
+/*									*/
+/************************************************************************/
+void HighSpeed_Read_Data(unsigned long Dst, unsigned char * p_data, unsigned long no_bytes)
+{
+#ifdef SST25_MANUAL_CS
+	if (m_hold_pending != NULL)
+	{
+		HighSpeed_Read_Hold(Dst, p_data, no_bytes);
+		return;
+	}
+#endif
+	while (no_bytes)
+	{
+		unsigned long n = (no_bytes > SST25_READ_BURST) ? SST25_READ_BURST : no_bytes;
+		uint8_t  p_tx_data[5];
+		sst25_sg_t sg[2]={{p_tx_data, NULL, read_command(p_tx_data, Dst)},{NULL, p_data, (uint16_t)n}};
+		SPI_Transfer_SG(sg, 2);
+		Dst += n;
+		p_data += n;
+		no_bytes -= n;
+	}
+}
+
+#ifdef SST25_MANUAL_CS
+/************************************************************************/
+/* PROCEDURE:	Hold_Enable						*/
+/*									*/		
+/* This procedure switches the RST#/HOLD# pin to its HOLD function	*/
+/* (EHLD) and installs the hooks used by HighSpeed_Read_Hold.  Once	*/
+/* enabled, HighSpeed_Read_Data reads through HighSpeed_Read_Hold.	*/
+/* The pin stays a HOLD pin until the next power cycle.			*/
+/*									*/
+/* Input:								*/
+/*		pending:	Returns true when another device waits	*/
+/*				for the bus				*/
+/*		lend:		Runs the waiting transaction(s) with	*/
+/*				SPI_Bus_Transfer while the flash holds	*/
+/*		chunk:		Bytes read between two pending checks;	*/
+/*				bounds the bus latency of other devices	*/
+/*									*/
+/* Returns:								*/
+/*		Nothing							*/
+/*									*/
+/************************************************************************/
+void Hold_Enable(sst25_hold_pending_t pending, sst25_hold_lend_t lend, unsigned short chunk)
+{
+	Reset_Hold_High();
+	if (sst25_profile->caps & SST25_CAP_EHLD)
+	{
+		EHLD();
+	}
+	m_hold_chunk = (chunk == 0) ? SST25_READ_CHUNK : chunk;
+#ifdef SST25_RADIO_AWARE
+	if (m_hold_chunk > SST25_MAX_XFER)
+	{
+		m_hold_chunk = SST25_MAX_XFER;
+	}
+#endif
+	m_hold_lend = lend;
+	m_hold_pending = pending;
+}
+
+/************************************************************************/
+/* PROCEDURE:	HighSpeed_Read_Hold					*/
+/*									*/		
+/* This procedure reads any number of bytes with a single high speed	*/
+/* read command and CE kept low.  Data is clocked straight into the	*/
+/* caller buffer in pieces of the Hold_Enable chunk size.  Between two	*/
+/* pieces, if another device is waiting, HOLD# is pulled low (SCK is	*/
+/* idle low in mode 0), the bus is lent out and the read then resumes	*/
+/* without resending command and address.				*/
+/*									*/
+/* Input:								*/
+/*		Dst:		Destination Address 000000H - 7FFFFFH	*/
+/*		p_data:		Buffer for the data read		*/
+/*      	no_bytes	Number of bytes to read			*/
+/*									*/
+/* Returns:								*/
+/*		Nothing							*/
+/*									*/
+/************************************************************************/
+void HighSpeed_Read_Hold(unsigned long Dst, unsigned char * p_data, unsigned long no_bytes)
+{
+	uint8_t  p_tx_data[5];
+	uint16_t len = read_command(p_tx_data, Dst);
+	uint8_t  p_rx_data[sizeof(p_tx_data)];
+	CE_Low();
+	SPI_Bus_Transfer(p_tx_data, len, p_rx_data, len);
+	while (no_bytes)
 	{
-		upper_128[i] = p_rx_data[i+sizeof(p_tx_data)];	/* receive byte and store at address 80H - FFH */
+		unsigned short n = (no_bytes > m_hold_chunk) ? m_hold_chunk : (unsigned short)no_bytes;
+		SPI_Bus_Transfer(p_data, 0, p_data, n);	/* nothing to send, clock in n bytes */
+		p_data += n;
+		no_bytes -= n;
+		if (no_bytes && (m_hold_pending != NULL) && m_hold_pending())
+		{
+			Reset_Hold_Low();			/* flash ignores SCK/SI, SO floats */
+			m_hold_lend();
+			Reset_Hold_High();
+			sst25_hold_count++;
+		}
 	}
+	CE_High();
 }
+#endif /* SST25_MANUAL_CS */
 
+/************************************************************************/
+/* PROCEDURE:	HighSpeed_Read_Async					*/
+/*									*/
+/* This procedure starts a High-Speed-Read (0Bh) and returns while the	*/
+/* data is clocked in; handler is called from the SPI master event	*/
+/* handler (interrupt context) when it is complete.  One read can be	*/
+/* in flight; every other command waits for it before it starts.  The	*/
+/* buffer receives the command bytes first, the data starts at		*/
+/* p_buf + SST25_ASYNC_HEADER.  With SST25_SPI_DIRECT or a host	*/
+/* transport there is no completion interrupt and the read runs to	*/
+/* completion before handler is called and this procedure returns.	*/
+/*									*/
+/* Input:								*/
+/*		Dst:		Destination Address 000000H - 7FFFFFH	*/
+/*		p_buf:		SST25_ASYNC_HEADER + no_bytes bytes	*/
+/*      	no_bytes	Number of bytes to read			*/
+/*		handler:	Completion callback			*/
+/*									*/
+/* Returns:								*/
+/*		NRF_SUCCESS, NRF_ERROR_BUSY if a read is in flight or	*/
+/*		NRF_ERROR_DATA_SIZE if no_bytes exceeds			*/
+/*		SST25_ASYNC_MAX, NRF_ERROR_TIMEOUT if the radio-idle	*/
+/*		window did not come (SST25_RADIO_AWARE)			*/
+/************************************************************************/
+uint32_t HighSpeed_Read_Async(unsigned long Dst, unsigned char * p_buf, unsigned short no_bytes, sst25_async_handler_t handler)
+{
+	uint8_t p_tx_data[SST25_ASYNC_HEADER]={0x0B,((Dst & SST25_ADDR_MASK) >> 16),((Dst & 0xFFFF) >> 8),(Dst & 0xFF),0xFF};
+	if (no_bytes > SST25_ASYNC_MAX)
+	{
+		return NRF_ERROR_DATA_SIZE;
+	}
+#ifdef SST25_SPI_POLLED
+	sst25_sg_t sg[2]={{p_tx_data, NULL, SST25_ASYNC_HEADER},{NULL, p_buf + SST25_ASYNC_HEADER, no_bytes}};
+	memcpy(p_buf, p_tx_data, SST25_ASYNC_HEADER);
+	SPI_Transfer_SG(sg, 2);
+	handler();
+	return NRF_SUCCESS;
+#else
+	if (m_spi_busy)
+	{
+		return NRF_ERROR_BUSY;
+	}
+	memcpy(m_async_cmd, p_tx_data, SST25_ASYNC_HEADER);
+	m_async_len = no_bytes;
+#ifdef SST25_MANUAL_CS
+	CE_Low();
+	SPI_Bus_Transfer(m_async_cmd, SST25_ASYNC_HEADER, p_buf, SST25_ASYNC_HEADER);
+	p_buf += SST25_ASYNC_HEADER;		/* data segment only from here */
+#endif
+#ifdef SST25_RADIO_AWARE
+	if (!radio_wait(no_bytes))
+	{
+#ifdef SST25_MANUAL_CS
+		CE_High();
+#endif
+		return NRF_ERROR_TIMEOUT;
+	}
+#endif
+#ifdef SST25_TRACE
+	m_async_t_start = SST_Trace_Time();
+#endif
+	m_async_handler = handler;
+	m_spi_busy = true;
+#ifdef SST25_MANUAL_CS
+	uint32_t err_code = spi_master_send_recv(SPI_MASTER_HW, p_buf, 0, p_buf, no_bytes);
+#else
+	uint32_t err_code = spi_master_send_recv(SPI_MASTER_HW, m_async_cmd, SST25_ASYNC_HEADER, p_buf, SST25_ASYNC_HEADER + no_bytes);
+#endif
+	if (err_code != NRF_SUCCESS)
+	{
+		m_async_handler = NULL;
+		m_spi_busy = false;
+#ifdef SST25_MANUAL_CS
+		CE_High();
+#endif
+		sst25_health.bus_errors++;
+		return err_code;
+	}
+	return NRF_SUCCESS;
+#endif /* SST25_SPI_POLLED */
+}
 
+/************************************************************************/
+/* PROCEDURE:	Read_Async_Busy						*/
+/*									*/
+/* Returns true while a HighSpeed_Read_Async is on the bus.		*/
+/************************************************************************/
+bool Read_Async_Busy(void)
+{
+#ifdef SST25_SPI_POLLED
+	return false;
+#else
+	return m_spi_busy;
+#endif
+}
+
+/************************************************************************/
+/* PROCEDURE:	HighSpeed_Read_Scatter					*/
+/*									*/		
+/* This procedure reads the bytes from Dst on in one transaction and	*/
+/* hands them to the segments in order: a segment with p_rx receives	*/
+/* its bytes, one without discards them, which skips a gap between two	*/
+/* wanted ranges for less than the cost of a new command.  Without	*/
+/* SST25_MANUAL_CS the segments together must fit SST25_SG_STAGING	*/
+/* after the command.  Too many or too long segments are not read,	*/
+/* SST25_Last_Error then reports NRF_ERROR_DATA_SIZE.			*/
+/*									*/
+/* Input:								*/
+/*		Dst:		Destination Address 000000H - 7FFFFFH	*/
+/*		p_sg:		Segments, p_tx NULL			*/
+/*      	count		Number of segments, up to SST25_SCATTER_SEGS */
+/*									*/
+/* Returns:								*/
+/*		Nothing							*/
+/*									*/
+/************************************************************************/
+void HighSpeed_Read_Scatter(unsigned long Dst, sst25_sg_t const * p_sg, uint8_t count)
+{
+	uint8_t  p_tx_data[5];
+	sst25_sg_t sg[SST25_SCATTER_SEGS + 1];
+	if (count > SST25_SCATTER_SEGS)
+	{
+		note_error(NRF_ERROR_DATA_SIZE);
+		return;
+	}
+	sg[0].p_tx = p_tx_data;
+	sg[0].p_rx = NULL;
+	sg[0].len = read_command(p_tx_data, Dst);
+	memcpy(&sg[1], p_sg, count * sizeof(sst25_sg_t));
+	SPI_Transfer_SG(sg, count + 1);
+}
+
+/************************************************************************/
+/* PROCEDURE:	HighSpeed_Read_Data_CRC					*/
+/*									*/		
+/* This procedure reads like HighSpeed_Read_Data and updates a CRC-32	*/
+/* over each transaction as soon as it lands in the caller buffer, so the	*/
+/* integrity check costs no extra pass over the data.			*/
+/*									*/
+/* Input:								*/
+/*		Dst:		Destination Address 000000H - 7FFFFFH	*/
+/*		p_data:		Buffer for the data read		*/
+/*      	no_bytes	Number of bytes to read			*/
+/*		p_crc		CRC-32 of preceding data, or NULL	*/
+/*									*/
+/* Returns:								*/
+/*		CRC-32 including the data read				*/
+/*									*/
+/************************************************************************/
+uint32_t HighSpeed_Read_Data_CRC(unsigned long Dst, unsigned char * p_data, unsigned long no_bytes, uint32_t const * p_crc)
+{
+	uint32_t crc = (p_crc == NULL) ? 0 : *p_crc;	/* CRC of nothing is 0 */
+	while (no_bytes)
+	{
+		unsigned long n = (no_bytes > SST25_READ_CHUNK) ? SST25_READ_CHUNK : no_bytes;
+		uint8_t  p_tx_data[5];
+		sst25_sg_t sg[2]={{p_tx_data, NULL, read_command(p_tx_data, Dst)},{NULL, p_data, (uint16_t)n}};
+		SPI_Transfer_SG(sg, 2);
+		crc = SST_CRC32_Compute(p_data, n, &crc);
+		Dst += n;
+		p_data += n;
+		no_bytes -= n;
+	}
+	return crc;
+}
+
+/************************************************************************/
+/* PROCEDURE:	Verify_Data						*/
+/*									*/		
+/* This procedure reads back a programmed range with the high speed	*/
+/* read command and compares it against the source data.		*/
+/*									*/
+/* Input:								*/
+/*		Dst:		Destination Address 000000H - 7FFFFFH	*/
+/*		p_data:		Expected data				*/
+/*      	no_bytes	Number of bytes to compare		*/
+/*									*/
+/* Returns:								*/
+/*		true if the flash content matches			*/
+/*									*/
+/************************************************************************/
+bool Verify_Data(unsigned long Dst, const unsigned char * p_data, unsigned long no_bytes)
+{
+	while (no_bytes)
+	{
+		unsigned long n = (no_bytes > SST25_READ_CHUNK) ? SST25_READ_CHUNK : no_bytes;
+		uint8_t  p_tx_data[5];
+		uint8_t  p_rx_data[SST25_READ_CHUNK];
+		sst25_sg_t sg[2]={{p_tx_data, NULL, read_command(p_tx_data, Dst)},{NULL, p_rx_data, (uint16_t)n}};
+		SPI_Transfer_SG(sg, 2);
+		if (memcmp(p_data, p_rx_data, n) != 0)
+		{
+			return false;
+		}
+		Dst += n;
+		p_data += n;
+		no_bytes -= n;
+	}
+	return true;
+}
+
+/************************************************************************/
+/* PROCEDURE:	Program_Verify_Enable					*/
+/*									*/		
+/* This procedure turns program-verify mode on or off.  When on, 	*/
+/* Page_Program_Operation and Page_Program_Data_Operation read the	*/
+/* programmed bytes back and report a mismatch.				*/
+/*									*/
+/* Input:								*/
+/*		enable							*/
+/*									*/
+/* Returns:								*/
+/*		Nothing							*/
+/*									*/
+/************************************************************************/
+void Program_Verify_Enable(bool enable)
+{
+	m_program_verify = enable;
+}
 									
 
 /************************************************************************/
@@ -658,11 +1642,9 @@ void HighSpeed_Read_Cont(unsigned long Dst, unsigned long no_bytes)
 /************************************************************************/
 void Chip_Erase(void)
 {						
-	uint8_t  p_tx_data[1]={0x60};
+	uint8_t  p_tx_data[1]={SST25_OP_CHIP_ERASE};
 	uint8_t  p_rx_data[sizeof(p_tx_data)+0];
-	uint32_t err_code = spi_master_send_recv(SPI_MASTER_HW, p_tx_data, sizeof(p_tx_data), p_rx_data,sizeof(p_rx_data));
-	APP_ERROR_CHECK(err_code);
-	nrf_delay_ms(DELAY_MS);
+	spi_transfer(p_tx_data, sizeof(p_tx_data), p_rx_data, sizeof(p_rx_data));
 	//Send_Byte(0x60);			/* send Chip Erase command (60h or C7h) */
 }
 
@@ -682,17 +1664,16 @@ void Chip_Erase(void)
 /************************************************************************/
 void Sector_Erase(unsigned long Dst)
 {
-	uint8_t p_tx_data[4]={0x20,((Dst & 0xFFFFFF) >> 16),((Dst & 0xFFFF) >> 8),(Dst & 0xFF)};
+	uint8_t p_tx_data[4]={0x20,((Dst & SST25_ADDR_MASK) >> 16),((Dst & 0xFFFF) >> 8),(Dst & 0xFF)};
 	uint8_t  p_rx_data[sizeof(p_tx_data)+0];
-	uint32_t err_code = spi_master_send_recv(SPI_MASTER_HW, p_tx_data, sizeof(p_tx_data), p_rx_data,sizeof(p_rx_data));
-	APP_ERROR_CHECK(err_code);
-	nrf_delay_ms(DELAY_MS);
+	spi_transfer(p_tx_data, sizeof(p_tx_data), p_rx_data, sizeof(p_rx_data));
 	//Send_Byte(0x20);			/* send Sector Erase command */
 	//Send_Byte(((Dst & 0xFFFFFF) >> 16)); 	/* send 3 address bytes */
 	//Send_Byte(((Dst & 0xFFFF) >> 8));
 	//Send_Byte(Dst & 0xFF);
 }
 
+#if SST25_BLOCK_32K_SIZE
 /************************************************************************/
 /* PROCEDURE: Block_Erase_32K						*/
 /*									*/
@@ -706,16 +1687,15 @@ void Sector_Erase(unsigned long Dst)
 /************************************************************************/
 void Block_Erase_32K(unsigned long Dst)
 {
-	uint8_t p_tx_data[4]={0x52,((Dst & 0xFFFFFF) >> 16),((Dst & 0xFFFF) >> 8),(Dst & 0xFF)};
+	uint8_t p_tx_data[4]={0x52,((Dst & SST25_ADDR_MASK) >> 16),((Dst & 0xFFFF) >> 8),(Dst & 0xFF)};
 	uint8_t  p_rx_data[sizeof(p_tx_data)+0];
-	uint32_t err_code = spi_master_send_recv(SPI_MASTER_HW, p_tx_data, sizeof(p_tx_data), p_rx_data,sizeof(p_rx_data));
-	APP_ERROR_CHECK(err_code);
-	nrf_delay_ms(DELAY_MS);
+	spi_transfer(p_tx_data, sizeof(p_tx_data), p_rx_data, sizeof(p_rx_data));
 	//Send_Byte(0x52);			/* send 32 KByte Block Erase command */
 	//Send_Byte(((Dst & 0xFFFFFF) >> 16)); 	/* send 3 address bytes */
 	//Send_Byte(((Dst & 0xFFFF) >> 8));
 	//Send_Byte(Dst & 0xFF);
 }
+#endif /* SST25_BLOCK_32K_SIZE */
 
 /************************************************************************/
 /* PROCEDURE: Block_Erase_64K						*/
@@ -730,11 +1710,9 @@ void Block_Erase_32K(unsigned long Dst)
 /************************************************************************/
 void Block_Erase_64K(unsigned long Dst)
 {
-	uint8_t p_tx_data[4]={0xD8,((Dst & 0xFFFFFF) >> 16),((Dst & 0xFFFF) >> 8),(Dst & 0xFF)};
+	uint8_t p_tx_data[4]={0xD8,((Dst & SST25_ADDR_MASK) >> 16),((Dst & 0xFFFF) >> 8),(Dst & 0xFF)};
 	uint8_t  p_rx_data[sizeof(p_tx_data)+0];
-	uint32_t err_code = spi_master_send_recv(SPI_MASTER_HW, p_tx_data, sizeof(p_tx_data), p_rx_data,sizeof(p_rx_data));
-	APP_ERROR_CHECK(err_code);
-	nrf_delay_ms(DELAY_MS);
+	spi_transfer(p_tx_data, sizeof(p_tx_data), p_rx_data, sizeof(p_rx_data));
 	//Send_Byte(0xD8);			/* send 64KByte Block Erase command */
 	//Send_Byte(((Dst & 0xFFFFFF) >> 16)); 	/* send 3 address bytes */
 	//Send_Byte(((Dst & 0xFFFF) >> 8));
@@ -745,75 +1723,187 @@ void Block_Erase_64K(unsigned long Dst)
 /* PROCEDURE: Wait_Busy							*/
 /*									*/
 /* This procedure waits until device is no longer busy (can be used by	*/
-/* Page-Program, Sector-Erase, Block-Erase, Chip-Erase).		*/
+/* Page-Program, Sector-Erase, Block-Erase, Chip-Erase).  The wait is	*/
+/* bounded by the longest command, Chip-Erase.				*/
 /*									*/
 /* Input:								*/
 /*		None							*/
 /*									*/
 /* Returns:								*/
-/*		Nothing							*/
+/*		See Wait_Busy_Timeout					*/
 /************************************************************************/
- 				
-//  void Wait_Busy()
-//{
+uint32_t Wait_Busy(void)
+{
+	return Wait_Busy_Timeout(SST25_TIMEOUT_US(SST25_T_CE_MAX_US));
+}
 
+/************************************************************************/
+/* PROCEDURE: Wait_Busy_Timeout						*/
+/*									*/
+/* This procedure waits until device is no longer busy or timeout_us	*/
+/* have passed.  The status register is polled every SST25_POLL_US;	*/
+/* the time is counted in these pauses, so the real wait is somewhat	*/
+/* longer than timeout_us, never shorter.  A timeout is also kept for	*/
+/* SST25_Last_Error.							*/
+/*									*/
+/* Input:								*/
+/*		timeout_us	Deadline in microseconds		*/
+/*									*/
+/* Returns:								*/
+/*		NRF_SUCCESS, NRF_ERROR_TIMEOUT, or the SPI master error	*/
+/*		of a status read					*/
+/************************************************************************/
+uint32_t Wait_Busy_Timeout(unsigned long timeout_us)
+{
+	unsigned long bus_errors = sst25_health.bus_errors;
+	unsigned long waited = 0;
+	while ((Read_Status_Register() & 0x01) == 0x01)	/* waste time until not busy */
+	{
+		if (sst25_health.bus_errors != bus_errors)
+		{
+			return m_error;				/* status byte not valid */
+		}
+		if (waited >= timeout_us)
+		{
+			sst25_health.timeouts++;
+			note_error(NRF_ERROR_TIMEOUT);
+			return NRF_ERROR_TIMEOUT;
+		}
+		delay_us(SST25_POLL_US);
+		waited += SST25_POLL_US;
+	}
+	if (sst25_health.bus_errors != bus_errors)
+	{
+		return m_error;
+	}
+	if (waited > sst25_health.busy_max_us)
+	{
+		sst25_health.busy_max_us = waited;
+	}
+	return NRF_SUCCESS;
+}
+
+/************************************************************************/
+/* PROCEDURE: SST25_Recover						*/
+/*									*/
+/* This procedure brings the bus and the device back to a known state	*/
+/* after a timeout or a bus error.  The SPI master is reopened, which	*/
+/* ends an async read still pending, and the device is reset: with the	*/
+/* RST# pin (Reset_Hold_Low/High) unless EHLD made it HOLD#, or with	*/
+/* the Reset-Enable/Reset commands on parts that have them; the		*/
+/* SST25VF0xxB have neither and are not reset.  A program		*/
+/* or erase in progress is aborted, its area has to be treated as	*/
+/* undefined.  The status register byte last written by WRSR and a	*/
+/* ULBPR are applied again.						*/
+/*									*/
+/* Input:								*/
+/*		None							*/
+/*									*/
+/* Returns:								*/
+/*		NRF_SUCCESS if the device answers and is not busy,	*/
+/*		NRF_ERROR_BUSY if it still is, or an SPI master error	*/
+/************************************************************************/
+uint32_t SST25_Recover(void)
+{
+#if !defined(SST25_SPI_DIRECT) && !defined(SST25_TRANSPORT_HOST)
+	uint32_t err_code;
+#endif
+
+	sst25_health.resets++;
+#if defined(SST25_SPI_DIRECT)
+	spi_direct_init();
+#elif !defined(SST25_TRANSPORT_HOST)
+	spi_master_close(SPI_MASTER_HW);
+	CRITICAL_REGION_ENTER();
+	if (m_spi_busy)
+	{
+		spi_transfer_done();
+	}
+	CRITICAL_REGION_EXIT();
+	err_code = spi_master_init(SPI_MASTER_HW,spi_master_event_handler,false);
+	if (err_code != NRF_SUCCESS)
+	{
+		return err_code;		/* the bus is closed, the device was not reset */
+	}
+#endif
+#ifdef SST25_MANUAL_CS
+	CE_High();
+#endif
+	m_error = NRF_SUCCESS;
+
+	if ((sst25_profile->caps & SST25_CAP_EHLD) && !m_ehld)
+	{
+		Reset_Hold_Low();
+		delay_us(1);					/* tRST, 100 ns min */
+		Reset_Hold_High();
+	}
+	else if (sst25_profile->caps & SST25_CAP_RESET_CMD)
+	{
+		uint8_t  p_tx_data[1]={0x66};		/* Reset-Enable */
+		uint8_t  p_rx_data[sizeof(p_tx_data)+0];
+		spi_transfer(p_tx_data, sizeof(p_tx_data), p_rx_data, sizeof(p_rx_data));
+		p_tx_data[0] = 0x99;			/* Reset */
+		spi_transfer(p_tx_data, sizeof(p_tx_data), p_rx_data, sizeof(p_rx_data));
+	}
+	delay_us(SST25_T_RECOVERY_US);
 
-//		//unsigned char temp = 0;
-
-//		 //CE=0;
-//		uint8_t * const p_rx_data;
-//    //const uint16_t len;
-//	  uint32_t err_code = spi_master_send_recv(SPI_MASTER_HW, 0x05, 1, p_rx_data, 0);
-//	  	//Send_Byte(0x05);		/* send RDSR command */
-
-////		 SCK=1;
-////		 SCK=0;
-////		 SCK=1;
-////		 SCK=0;
-////		 SCK=1;
-////		 SCK=0;
-////		 SCK=1;
-////		 SCK=0;
-////		 SCK=1;
-////		 SCK=0;
-////		 SCK=1;
-////		 SCK=0;
-////		 SCK=1;
-////		 SCK=0;
-////		 temp=SO;		//Get the Value of Busy bit in the status register
-////		 temp=SO;		//Get the Value of Busy bit in the status register
-////		 temp=SO;		//Get the Value of Busy bit in the status register
-////		 temp=SO;		//Get the Value of Busy bit in the status register
-////		 temp=SO;		//Get the Value of Busy bit in the status register
-
-//		 while (temp==1)
-//		 {
-//		 SCK=1;
-//		 SCK=0;
-//		 SCK=1;
-//		 SCK=0;
-//		 SCK=1;
-//		 SCK=0;
-//		 SCK=1;
-//		 SCK=0;
-//		 SCK=1;
-//		 SCK=0;
-//		 SCK=1;
-//		 SCK=0;
-//		 SCK=1;
-//		 SCK=0;
-//		 SCK=1;
-//		 SCK=0;
-//		 temp=SO;		//Get the Value of Busy bit in the status register
-//		 temp=SO;		//Get the Value of Busy bit in the status register
-//		 temp=SO;		//Get the Value of Busy bit in the status register
-//		 temp=SO;		//Get the Value of Busy bit in the status register
-//		 temp=SO;		//Get the Value of Busy bit in the status register
-
-//		 }
-//		 CE=1;
-
-//}	  
+	if (m_status_written >= 0)
+	{
+		EWSR();
+		WRSR((uint8_t)m_status_written);
+	}
+#if SST25_HAS_ULBPR
+	if (m_ulbpr)
+	{
+		WREN();
+		ULBPR();
+	}
+#endif
+	if (m_error != NRF_SUCCESS)
+	{
+		return SST25_Last_Error();
+	}
+	return (Read_Status_Register() & 0x01) ? NRF_ERROR_BUSY : SST25_Last_Error();
+}
+
+/************************************************************************/
+/* PROCEDURE: SST25_Last_Error						*/
+/*									*/
+/* This procedure returns the first SPI master error, lost transfer or	*/
+/* Wait_Busy timeout since its last call and clears it.  Procedures	*/
+/* without a status of their own leave their errors here.		*/
+/*									*/
+/* Input:								*/
+/*		None							*/
+/*									*/
+/* Returns:								*/
+/*		NRF_SUCCESS or the first error				*/
+/************************************************************************/
+uint32_t SST25_Last_Error(void)
+{
+	uint32_t err_code = m_error;
+	m_error = NRF_SUCCESS;
+	return err_code;
+}
+
+/* Completes the status of one attempt of an *_Operation with the errors
+ * of its other transfers.  Returns true if the attempt failed on the bus
+ * or timed out and is to be repeated after SST25_Recover. */
+static bool operation_retry(uint32_t * p_err_code, uint8_t * p_tries)
+{
+	if (*p_err_code == NRF_SUCCESS)
+	{
+		*p_err_code = SST25_Last_Error();
+	}
+	if ((*p_err_code == NRF_SUCCESS) || (*p_tries >= SST25_RETRIES))
+	{
+		return false;
+	}
+	(*p_tries)++;
+	sst25_health.retries++;
+	SST25_Recover();
+	return true;
+}
 
 /************************************************************************/
 /* PROCEDURE: EHLD			  				*/
@@ -828,14 +1918,104 @@ void Block_Erase_64K(unsigned long Dst)
 
 void EHLD(void)
 {
+	m_ehld = true;
 	uint8_t  p_tx_data[1]={0xaa};
 	uint8_t  p_rx_data[sizeof(p_tx_data)+0];
-	uint32_t err_code = spi_master_send_recv(SPI_MASTER_HW, p_tx_data, sizeof(p_tx_data), p_rx_data,sizeof(p_rx_data));
-	APP_ERROR_CHECK(err_code);
-	nrf_delay_ms(DELAY_MS);
+	spi_transfer(p_tx_data, sizeof(p_tx_data), p_rx_data, sizeof(p_rx_data));
 	//Send_Byte(0xaa);			
 }
 
+#if SST25_HAS_ULBPR
+/************************************************************************/
+/* PROCEDURE: ULBPR							*/
+/*									*/
+/* This procedure clears the block protection of all memory (Global	*/
+/* Block Protection Unlock).  SST26 parts power up protected.  WREN()	*/
+/* must be issued first.						*/
+/*									*/
+/* Input:								*/
+/*		None							*/
+/*									*/
+/* Returns:								*/
+/*		Nothing							*/
+/************************************************************************/
+void ULBPR(void)
+{
+	m_ulbpr = true;
+	uint8_t  p_tx_data[1]={0x98};
+	uint8_t  p_rx_data[sizeof(p_tx_data)+0];
+	spi_transfer(p_tx_data, sizeof(p_tx_data), p_rx_data, sizeof(p_rx_data));
+}
+#endif
+
+
+/************************************************************************/
+/* PROCEDURE:	aai_program						*/
+/*									*/
+/* Page_Program_Data for parts without Page-Program (SST25VF0xxB).	*/
+/* An odd leading or trailing byte is written with Byte-Program (02h),	*/
+/* the rest with Auto Address Increment word programming (ADh), each	*/
+/* word waited for with RDSR and the sequence ended with WRDI.  Like	*/
+/* Page-Program, WREN() must be issued first and only a trailing byte	*/
+/* is left for the caller to wait for.					*/
+/*									*/
+/* Input:								*/
+/*		Dst:		Destination Address			*/
+/*		p_data:		Data to program				*/
+/*		no_bytes:	Number of bytes to program		*/
+/*									*/
+/* Returns:								*/
+/*		Nothing							*/
+/************************************************************************/
+static void aai_program(unsigned long Dst, const unsigned char * p_data, unsigned short no_bytes)
+{
+	uint8_t  p_tx_data[4]={0x02,((Dst & SST25_ADDR_MASK) >> 16),((Dst & 0xFFFF) >> 8),(Dst & 0xFF)};
+	sst25_sg_t sg[2]={{p_tx_data, NULL, sizeof(p_tx_data)},{p_data, NULL, 1}};
+	if ((Dst & 1) && no_bytes)		/* AAI starts at an even address */
+	{
+		SPI_Transfer_SG(sg, 2);		/* Byte-Program */
+		Wait_Busy();
+		WREN();
+		Dst++;
+		p_data++;
+		no_bytes--;
+	}
+	if (no_bytes >= 2)
+	{
+		p_tx_data[0] = 0xAD;
+		p_tx_data[1] = ((Dst & SST25_ADDR_MASK) >> 16);
+		p_tx_data[2] = ((Dst & 0xFFFF) >> 8);
+		p_tx_data[3] = (Dst & 0xFF);
+		sg[0].len = sizeof(p_tx_data);	/* first word carries the address */
+		while (no_bytes >= 2)
+		{
+			sg[1].p_tx = p_data;
+			sg[1].len = 2;
+			SPI_Transfer_SG(sg, 2);
+			Wait_Busy();
+			sg[0].len = 1;
+			Dst += 2;
+			p_data += 2;
+			no_bytes -= 2;
+		}
+		WRDI();				/* leave AAI mode */
+		if (no_bytes)
+		{
+			WREN();
+		}
+	}
+	if (no_bytes)				/* trailing byte, not waited for */
+	{
+		p_tx_data[0] = 0x02;
+		p_tx_data[1] = ((Dst & SST25_ADDR_MASK) >> 16);
+		p_tx_data[2] = ((Dst & 0xFFFF) >> 8);
+		p_tx_data[3] = (Dst & 0xFF);
+		sg[0].len = sizeof(p_tx_data);
+		sg[1].p_tx = p_data;
+		sg[1].len = 1;
+		SPI_Transfer_SG(sg, 2);
+	}
+}
 
 /************************************************************************/
 /* PROCEDURE:	Page_Program						*/
@@ -863,16 +2043,14 @@ void EHLD(void)
 /************************************************************************/
 void Page_Program(unsigned long Dst)
 {
-	unsigned char i=0;
-	uint8_t  p_tx_data[4+128]={0x02,((Dst & 0xFFFFFF) >> 16),((Dst & 0xFFFF) >> 8),(Dst & 0xFF),};
-	for (i=0;i<=127;i++)
-	{	
-		p_tx_data[i+4]=upper_128[i];
+	if (!(sst25_profile->caps & SST25_CAP_PAGE_PROGRAM))
+	{
+		aai_program(Dst, upper_128, SST25_PROG_CHUNK);
+		return;
 	}
-	uint8_t  p_rx_data[sizeof(p_tx_data)+0];
-	uint32_t err_code = spi_master_send_recv(SPI_MASTER_HW, p_tx_data, sizeof(p_tx_data), p_rx_data,sizeof(p_rx_data));
-	APP_ERROR_CHECK(err_code);
-	nrf_delay_ms(DELAY_MS);
+	uint8_t  p_tx_data[4]={0x02,((Dst & SST25_ADDR_MASK) >> 16),((Dst & 0xFFFF) >> 8),(Dst & 0xFF)};
+	sst25_sg_t sg[2]={{p_tx_data, NULL, sizeof(p_tx_data)},{upper_128, NULL, SST25_PROG_CHUNK}};
+	SPI_Transfer_SG(sg, 2);
 	//Send_Byte(0x02); 			/* send Byte Program command */
 	//Send_Byte(((Dst & 0xFFFFFF) >> 16));	/* send 3 address bytes */
 	//Send_Byte(((Dst & 0xFFFF) >> 8));
@@ -882,6 +2060,58 @@ void Page_Program(unsigned long Dst)
 
 
 
+/************************************************************************/
+/* PROCEDURE:	Page_Program_Data					*/
+/*									*/
+/* This procedure programs 1 to 256 bytes from a caller buffer.  Bytes 	*/
+/* past the end of the 256 byte page wrap to the start of the page, so	*/
+/* Dst + no_bytes should not cross a page boundary.  WREN() must be	*/
+/* issued first and the caller has to wait for the device (Wait_Busy) */
+/* before the next command other than RDSR.  This lets the caller do	*/
+/* useful work while tPP elapses.  With SST25_RADIO_AWARE, data that	*/
+/* does not fit one transfer is programmed in pieces; all but the last	*/
+/* are waited for here.  Parts without Page-Program (sst25_profile)	*/
+/* are programmed with AAI words instead, see aai_program.		*/
+/*									*/
+/* Assumption:  Address being programmed is already erased and is NOT	*/
+/*		block protected.					*/
+/*									*/
+/* Input:								*/
+/*		Dst:		Destination Address 000000H - 7FFFFFH	*/
+/*		p_data:		Data to program				*/
+/*		no_bytes:	Number of bytes to program (1 - 256)	*/
+/*									*/
+/* Returns:								*/
+/*		Nothing							*/
+/************************************************************************/
+void Page_Program_Data(unsigned long Dst, const unsigned char * p_data, unsigned short no_bytes)
+{
+	if (no_bytes > SST25_PAGE_SIZE)
+	{
+		no_bytes = SST25_PAGE_SIZE;
+	}
+	if (!(sst25_profile->caps & SST25_CAP_PAGE_PROGRAM))
+	{
+		aai_program(Dst, p_data, no_bytes);
+		return;
+	}
+#ifdef SST25_RADIO_AWARE
+	while ((4u + no_bytes) > SST25_MAX_XFER)	/* each piece has to fit a radio-idle window */
+	{
+		unsigned short n = (unsigned short)(SST25_MAX_XFER - 4u);
+		Page_Program_Data(Dst, p_data, n);
+		Wait_Busy();
+		WREN();
+		Dst += n;
+		p_data += n;
+		no_bytes -= n;
+	}
+#endif
+	uint8_t  p_tx_data[4]={0x02,((Dst & SST25_ADDR_MASK) >> 16),((Dst & 0xFFFF) >> 8),(Dst & 0xFF)};
+	sst25_sg_t sg[2]={{p_tx_data, NULL, sizeof(p_tx_data)},{p_data, NULL, no_bytes}};
+	SPI_Transfer_SG(sg, 2);
+}
+
 /************************************************************************/
 /* PROCEDURE:	Dual_Input_Page_Program					*/
 /*									*/
@@ -923,6 +2153,7 @@ void Page_Program(unsigned long Dst)
 //	CE_High();				/* disable device */
 //}
 
+#if SST25_SID_SIZE
 /************************************************************************/
 /* PROCEDURE:	ReadSID	(Read Security ID)				*/
 /*									*/		
@@ -941,28 +2172,22 @@ void Page_Program(unsigned long Dst)
 void ReadSID(unsigned char Dst, unsigned char security_length) 
 {
 	unsigned char i=0;	
-	if (security_length>32)
+	if (security_length>SST25_SID_SIZE)
 	{ 
-		security_length=32;
+		security_length=SST25_SID_SIZE;
 	}
 	
-	uint8_t p_tx_data[3]={0x88,(Dst & 0xFF),(Dst & 0xFF)};
-	uint8_t  p_rx_data[sizeof(p_tx_data)+security_length+Dst];
-	uint32_t err_code = spi_master_send_recv(SPI_MASTER_HW, p_tx_data, sizeof(p_tx_data), p_rx_data,sizeof(p_rx_data));
-	APP_ERROR_CHECK(err_code);
-	nrf_delay_ms(DELAY_MS);
 	
-	for (i=Dst;i<(security_length+Dst);i++)
-	{ 
-		if (i<32)
-		{
-			security_id_32[i] = p_rx_data[i+sizeof(p_tx_data)]; 
-		}
-		else
-		{
-			security_id_32[i-32] = p_rx_data[i+sizeof(p_tx_data)]; 
-		}
-	}	
+	/* the first Dst bytes are skipped, the rest lands in		*/
+	/* security_id_32[Dst...], wrapping to the start of the array	*/
+	unsigned char first = (Dst < SST25_SID_SIZE) ? Dst : (unsigned char)(Dst - SST25_SID_SIZE);
+	uint8_t p_tx_data[3]={0x88,(Dst & 0xFF),(Dst & 0xFF)};
+	i = (unsigned char)(((first+security_length)>SST25_SID_SIZE) ? (SST25_SID_SIZE-first) : security_length);
+	sst25_sg_t sg[4]={{p_tx_data, NULL, sizeof(p_tx_data)},
+	                  {NULL, NULL, Dst},
+	                  {NULL, &security_id_32[first], i},
+	                  {NULL, security_id_32, (uint16_t)(security_length-i)}};
+	SPI_Transfer_SG(sg, 4);
 	//Send_Byte(0x88); 		
 	//Send_Byte(Dst & 0xFF);
 	//Send_Byte(Dst & 0xFF);  //dummy
@@ -984,16 +2209,9 @@ void ReadSID(unsigned char Dst, unsigned char security_length)
 /************************************************************************/
 void ProgSID(void) 
 {
-	unsigned char i=0;
-	uint8_t p_tx_data[2+24]={0xa5,0x08,};
-	for (i=0;i<24;i++)
-	{	
-		p_tx_data[2+i]=security_id_32[i+8];
-	}
-	uint8_t  p_rx_data[sizeof(p_tx_data)+0];
-	uint32_t err_code = spi_master_send_recv(SPI_MASTER_HW, p_tx_data, sizeof(p_tx_data), p_rx_data,sizeof(p_rx_data));
-	APP_ERROR_CHECK(err_code);
-	nrf_delay_ms(DELAY_MS);
+	uint8_t p_tx_data[2]={0xa5,SST25_SID_USER_OFFSET};
+	sst25_sg_t sg[2]={{p_tx_data, NULL, sizeof(p_tx_data)},{&security_id_32[SST25_SID_USER_OFFSET], NULL, SST25_SID_SIZE-SST25_SID_USER_OFFSET}};
+	SPI_Transfer_SG(sg, 2);
 	//Send_Byte(0xa5); 		
 	//Send_Byte(0x08);	  		/*address of user programmable area*/
 	//for (i=0;i<24;i++)
@@ -1021,12 +2239,12 @@ void LockSID(void)
 {
 	uint8_t p_tx_data[1]={0x85};
 	uint8_t  p_rx_data[sizeof(p_tx_data)+0];
-	uint32_t err_code = spi_master_send_recv(SPI_MASTER_HW, p_tx_data, sizeof(p_tx_data), p_rx_data,sizeof(p_rx_data));
-	APP_ERROR_CHECK(err_code);
-	nrf_delay_ms(DELAY_MS);
+	spi_transfer(p_tx_data, sizeof(p_tx_data), p_rx_data, sizeof(p_rx_data));
 	//Send_Byte(0x85); 		
 }
+#endif /* SST25_SID_SIZE */
 
+#if SST25_BLOCK_32K_SIZE
 /************************************************************************/
 /* PROCEDURE: Block_Erase_32K_Operation					*/
 /*									*/
@@ -1037,30 +2255,36 @@ void LockSID(void)
 /*		Dst:	Destination Address 000000H - 7FFFFFH		*/
 /*									*/
 /* Returns:								*/
-/*		Nothing							*/
+/*		NRF_SUCCESS, or the error of the last attempt		*/
+/*		(see Wait_Busy_Timeout)					*/
 /************************************************************************/ 
-void Block_Erase_32K_Operation(unsigned long Dst)
+uint32_t Block_Erase_32K_Operation(unsigned long Dst)
 {  	
-	//WREN
-	WREN();
-	//Send_Byte(0x06);				/* send WREN command */
+	uint8_t  tries = 0;
+	uint32_t err_code;
+	do
+	{
+		SST25_Last_Error();
+		//WREN
+		WREN();
+		//Send_Byte(0x06);				/* send WREN command */
 	
-	//Block Erase 32K
-	uint8_t p_tx_data[4]={0x52,((Dst & 0xFFFFFF) >> 16),((Dst & 0xFFFF) >> 8),(Dst & 0xFF)};
-	uint8_t  p_rx_data[sizeof(p_tx_data)+0];
-	uint32_t err_code = spi_master_send_recv(SPI_MASTER_HW, p_tx_data, sizeof(p_tx_data), p_rx_data,sizeof(p_rx_data));
-	APP_ERROR_CHECK(err_code);
-	nrf_delay_ms(DELAY_MS);
+		//Block Erase 32K
+		uint8_t p_tx_data[4]={0x52,((Dst & SST25_ADDR_MASK) >> 16),((Dst & 0xFFFF) >> 8),(Dst & 0xFF)};
+		uint8_t  p_rx_data[sizeof(p_tx_data)+0];
+		spi_transfer(p_tx_data, sizeof(p_tx_data), p_rx_data, sizeof(p_rx_data));
 	
-	//Send_Byte(0x52);				/* send 32 KByte Block Erase command */
-	//Send_Byte(((Dst & 0xFFFFFF) >> 16)); 		/* send 3 address bytes */
-	//Send_Byte(((Dst & 0xFFFF) >> 8));
-	//Send_Byte(Dst & 0xFF);
-
-	//Wait Busy
-	while ((Read_Status_Register()& 0x01) == 0x01)	/* waste time until not busy */
-	Read_Status_Register();
+		//Send_Byte(0x52);				/* send 32 KByte Block Erase command */
+		//Send_Byte(((Dst & 0xFFFFFF) >> 16)); 		/* send 3 address bytes */
+		//Send_Byte(((Dst & 0xFFFF) >> 8));
+		//Send_Byte(Dst & 0xFF);
+
+		//Wait Busy
+		err_code = Wait_Busy_Timeout(SST25_TIMEOUT_US(SST25_T_BE_MAX_US));
+	} while (operation_retry(&err_code, &tries));
+	return err_code;
 }
+#endif /* SST25_BLOCK_32K_SIZE */
 
 /************************************************************************/
 /* PROCEDURE: Block_Erase_64K_Operation					*/
@@ -1072,28 +2296,33 @@ void Block_Erase_32K_Operation(unsigned long Dst)
 /*		Dst:	Destination Address 000000H - 7FFFFFH		*/
 /*									*/
 /* Returns:								*/
-/*		Nothing							*/
+/*		NRF_SUCCESS, or the error of the last attempt		*/
+/*		(see Wait_Busy_Timeout)					*/
 /************************************************************************/
-void Block_Erase_64K_Operation(unsigned long Dst)
+uint32_t Block_Erase_64K_Operation(unsigned long Dst)
 {  	
-	//WREN
-	WREN();
-	//Send_Byte(0x06);				/* send WREN command */
-
-	//Block Erase 32K
-	uint8_t p_tx_data[4]={0xD8,((Dst & 0xFFFFFF) >> 16),((Dst & 0xFFFF) >> 8),(Dst & 0xFF)};
-	uint8_t  p_rx_data[sizeof(p_tx_data)+0];
-	uint32_t err_code = spi_master_send_recv(SPI_MASTER_HW, p_tx_data, sizeof(p_tx_data), p_rx_data,sizeof(p_rx_data));
-	APP_ERROR_CHECK(err_code);
-	nrf_delay_ms(DELAY_MS);
-	//Send_Byte(0xD8);				/* send 64KByte Block Erase command */
-	//Send_Byte(((Dst & 0xFFFFFF) >> 16)); 		/* send 3 address bytes */
-	//Send_Byte(((Dst & 0xFFFF) >> 8));
-	//Send_Byte(Dst & 0xFF);
-
-	//Wait Busy
-	while ((Read_Status_Register()& 0x01) == 0x01)	/* waste time until not busy */
-	Read_Status_Register();
+	uint8_t  tries = 0;
+	uint32_t err_code;
+	do
+	{
+		SST25_Last_Error();
+		//WREN
+		WREN();
+		//Send_Byte(0x06);				/* send WREN command */
+
+		//Block Erase 32K
+		uint8_t p_tx_data[4]={0xD8,((Dst & SST25_ADDR_MASK) >> 16),((Dst & 0xFFFF) >> 8),(Dst & 0xFF)};
+		uint8_t  p_rx_data[sizeof(p_tx_data)+0];
+		spi_transfer(p_tx_data, sizeof(p_tx_data), p_rx_data, sizeof(p_rx_data));
+		//Send_Byte(0xD8);				/* send 64KByte Block Erase command */
+		//Send_Byte(((Dst & 0xFFFFFF) >> 16)); 		/* send 3 address bytes */
+		//Send_Byte(((Dst & 0xFFFF) >> 8));
+		//Send_Byte(Dst & 0xFF);
+
+		//Wait Busy
+		err_code = Wait_Busy_Timeout(SST25_TIMEOUT_US(SST25_T_BE_MAX_US));
+	} while (operation_retry(&err_code, &tries));
+	return err_code;
 }
 
 
@@ -1107,28 +2336,33 @@ void Block_Erase_64K_Operation(unsigned long Dst)
 /*		Dst:	Destination Address 000000H - 7FFFFFH		*/
 /*									*/
 /* Returns:								*/
-/*		Nothing							*/
+/*		NRF_SUCCESS, or the error of the last attempt		*/
+/*		(see Wait_Busy_Timeout)					*/
 /************************************************************************/
-void Sector_Erase_Operation(unsigned long Dst)
+uint32_t Sector_Erase_Operation(unsigned long Dst)
 {
-	//WREN
-	WREN();
-	//Send_Byte(0x06);				/* send WREN command */
-
-	//Sector Erase
-	uint8_t p_tx_data[4]={0x20,((Dst & 0xFFFFFF) >> 16),((Dst & 0xFFFF) >> 8),(Dst & 0xFF)};
-	uint8_t  p_rx_data[sizeof(p_tx_data)+0];
-	uint32_t err_code = spi_master_send_recv(SPI_MASTER_HW, p_tx_data, sizeof(p_tx_data), p_rx_data,sizeof(p_rx_data));
-	APP_ERROR_CHECK(err_code);
-	nrf_delay_ms(DELAY_MS);
-	//Send_Byte(0x20);				/* send Sector Erase command */
-	//Send_Byte(((Dst & 0xFFFFFF) >> 16)); 		/* send 3 address bytes */
-	//Send_Byte(((Dst & 0xFFFF) >> 8));
-	//Send_Byte(Dst & 0xFF);
-
-	//Wait Busy
-	while ((Read_Status_Register()& 0x01) == 0x01)	/* waste time until not busy */
-	Read_Status_Register();
+	uint8_t  tries = 0;
+	uint32_t err_code;
+	do
+	{
+		SST25_Last_Error();
+		//WREN
+		WREN();
+		//Send_Byte(0x06);				/* send WREN command */
+
+		//Sector Erase
+		uint8_t p_tx_data[4]={0x20,((Dst & SST25_ADDR_MASK) >> 16),((Dst & 0xFFFF) >> 8),(Dst & 0xFF)};
+		uint8_t  p_rx_data[sizeof(p_tx_data)+0];
+		spi_transfer(p_tx_data, sizeof(p_tx_data), p_rx_data, sizeof(p_rx_data));
+		//Send_Byte(0x20);				/* send Sector Erase command */
+		//Send_Byte(((Dst & 0xFFFFFF) >> 16)); 		/* send 3 address bytes */
+		//Send_Byte(((Dst & 0xFFFF) >> 8));
+		//Send_Byte(Dst & 0xFF);
+
+		//Wait Busy
+		err_code = Wait_Busy_Timeout(SST25_TIMEOUT_US(SST25_T_SE_MAX_US));
+	} while (operation_retry(&err_code, &tries));
+	return err_code;
 }
 
 
@@ -1154,38 +2388,91 @@ void Sector_Erase_Operation(unsigned long Dst)
 /*      								*/
 /*									*/
 /* Returns:								*/
-/*		Nothing							*/
+/*		NRF_SUCCESS, NRF_ERROR_INVALID_DATA if program-verify	*/
+/*		is enabled and the read-back differs, or the error of	*/
+/*		the last attempt (see Wait_Busy_Timeout)		*/
 /*									*/
 /************************************************************************/
-void Page_Program_Operation(unsigned long Dst)
+uint32_t Page_Program_Operation(unsigned long Dst)
 {
-	unsigned char i=0;
-	//WREN
-	WREN();
-	//Send_Byte(0x06);				/* send WREN command */
-
-	//Page Program
-	uint8_t  p_tx_data[4+128]={0x02,((Dst & 0xFFFFFF) >> 16),((Dst & 0xFFFF) >> 8),(Dst & 0xFF),};
-	for (i=0;i<=127;i++)
-	{	
-		p_tx_data[i+4]=upper_128[i];
+	uint8_t  tries = 0;
+	uint32_t err_code;
+	do
+	{
+		SST25_Last_Error();
+		//WREN
+		WREN();
+		//Send_Byte(0x06);				/* send WREN command */
+
+		//Page Program
+		Page_Program(Dst);
+		//Send_Byte(0x02); 				/* send Byte Program command */
+		//Send_Byte(((Dst & 0xFFFFFF) >> 16));		/* send 3 address bytes */
+		//Send_Byte(((Dst & 0xFFFF) >> 8));
+		//Send_Byte(Dst & 0xFF);
+		//for (i=0;i<=127;i++)
+		//{	
+			//Send_Byte(upper_128[i]);		/* send byte to be programmed */
+		//}
+
+		//Wait Busy
+		err_code = Wait_Busy_Timeout(SST25_TIMEOUT_US(SST25_T_PP_MAX_US));
+	} while (operation_retry(&err_code, &tries));
+	if (err_code != NRF_SUCCESS)
+	{
+		return err_code;
 	}
-	uint8_t  p_rx_data[sizeof(p_tx_data)+0];
-	uint32_t err_code = spi_master_send_recv(SPI_MASTER_HW, p_tx_data, sizeof(p_tx_data), p_rx_data,sizeof(p_rx_data));
-	APP_ERROR_CHECK(err_code);
-	nrf_delay_ms(DELAY_MS);
-	//Send_Byte(0x02); 				/* send Byte Program command */
-	//Send_Byte(((Dst & 0xFFFFFF) >> 16));		/* send 3 address bytes */
-	//Send_Byte(((Dst & 0xFFFF) >> 8));
-	//Send_Byte(Dst & 0xFF);
-	//for (i=0;i<=127;i++)
-	//{	
-		//Send_Byte(upper_128[i]);		/* send byte to be programmed */
-	//}
 
-	//Wait Busy
-	while ((Read_Status_Register()& 0x01) == 0x01)	/* waste time until not busy */
-	Read_Status_Register();
+	//Verify
+	if (m_program_verify)
+	{
+		if (!Verify_Data(Dst, upper_128, SST25_PROG_CHUNK))	/* upper_128 is left intact */
+		{
+			return NRF_ERROR_INVALID_DATA;
+		}
+	}
+	return NRF_SUCCESS;
+}
+
+/************************************************************************/
+/* PROCEDURE:	Page_Program_Data_Operation				*/
+/*									*/
+/* This procedure programs 1 to 256 bytes from a caller buffer. WREN()	*/
+/* and Wait_Busy() are included in this procedure.			*/
+/*									*/
+/* Assumption:  Address being programmed is already erased and is NOT	*/
+/*		block protected.					*/
+/*									*/
+/* Input:								*/
+/*		Dst:		Destination Address 000000H - 7FFFFFH	*/
+/*		p_data:		Data to program				*/
+/*		no_bytes:	Number of bytes to program (1 - 256)	*/
+/*									*/
+/* Returns:								*/
+/*		NRF_SUCCESS, NRF_ERROR_INVALID_DATA if program-verify	*/
+/*		is enabled and the read-back differs, or the error of	*/
+/*		the last attempt (see Wait_Busy_Timeout)		*/
+/************************************************************************/
+uint32_t Page_Program_Data_Operation(unsigned long Dst, const unsigned char * p_data, unsigned short no_bytes)
+{
+	uint8_t  tries = 0;
+	uint32_t err_code;
+	do
+	{
+		SST25_Last_Error();
+		WREN();
+		Page_Program_Data(Dst, p_data, no_bytes);
+		err_code = Wait_Busy_Timeout(SST25_TIMEOUT_US(SST25_T_PP_MAX_US));
+	} while (operation_retry(&err_code, &tries));
+	if (err_code != NRF_SUCCESS)
+	{
+		return err_code;
+	}
+	if (m_program_verify && !Verify_Data(Dst, p_data, no_bytes))
+	{
+		return NRF_ERROR_INVALID_DATA;
+	}
+	return NRF_SUCCESS;
 }
 
 /************************************************************************/
@@ -1198,23 +2485,28 @@ void Page_Program_Operation(unsigned long Dst)
 /*		None							*/
 /*									*/
 /* Returns:								*/
-/*		Nothing							*/
+/*		NRF_SUCCESS, or the error of the last attempt		*/
+/*		(see Wait_Busy_Timeout)					*/
 /************************************************************************/
-void Chip_Erase_Operation(void)
+uint32_t Chip_Erase_Operation(void)
 {	
-	 //WREN
-	WREN();
-	//Send_Byte(0x06);				/* send WREN command */
-	
-	//Chip Erase 					
-	uint8_t  p_tx_data[1]={0x60};
-	uint8_t  p_rx_data[sizeof(p_tx_data)+0];
-	uint32_t err_code = spi_master_send_recv(SPI_MASTER_HW, p_tx_data, sizeof(p_tx_data), p_rx_data,sizeof(p_rx_data));
-	APP_ERROR_CHECK(err_code);
-	nrf_delay_ms(DELAY_MS);
-	//Send_Byte(0x60);				/* send Chip Erase command (60h or C7h) */
-
-	//Wait Busy
-	while ((Read_Status_Register()& 0x01) == 0x01)	/* waste time until not busy */
-	Read_Status_Register();
+	uint8_t  tries = 0;
+	uint32_t err_code;
+	do
+	{
+		SST25_Last_Error();
+		//WREN
+		WREN();
+		//Send_Byte(0x06);				/* send WREN command */
+
+		//Chip Erase
+		uint8_t  p_tx_data[1]={SST25_OP_CHIP_ERASE};
+		uint8_t  p_rx_data[sizeof(p_tx_data)+0];
+		spi_transfer(p_tx_data, sizeof(p_tx_data), p_rx_data, sizeof(p_rx_data));
+		//Send_Byte(0x60);				/* send Chip Erase command (60h or C7h) */
+
+		//Wait Busy
+		err_code = Wait_Busy_Timeout(SST25_TIMEOUT_US(SST25_T_CE_MAX_US));
+	} while (operation_retry(&err_code, &tries));
+	return err_code;
 }
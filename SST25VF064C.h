@@ -26,6 +26,7 @@ Device Communication Protocol(pinout related) functions:
 Functions                    		Function
 ------------------------------------------------------------------
 init								Initializes clock to set up mode 0.
+SST25_SPI_Hz				Returns the SPI clock the driver runs at
 Send_Byte						Sends one byte using SI pin to send and shift out 1-bit per clock rising edge
 Send_Double_Byte		Sends one byte using SI pin to send and shift out 2-bit per clock rising edge
 Get_Byte						Receives one byte using SO pin to receive and shift in 1-bit per clock falling edge
@@ -59,13 +60,27 @@ Read											Reads one byte from the serial flash and returns byte(max of 25 M
 Read_Cont									Reads multiple bytes(max of 25 MHz CLK frequency)
 HighSpeed_Read						Reads one byte from the serial flash and returns byte(max of 66 MHz CLK frequency)
 HighSpeed_Read_Cont				Reads multiple bytes(max of 66 MHz CLK frequency)
+HighSpeed_Read_Data				Reads any number of bytes into a caller buffer
+HighSpeed_Read_Data_CRC		Reads into a caller buffer and updates a CRC-32 on the way
+HighSpeed_Read_Async			Starts a read that completes in the SPI event handler
+Read_Async_Busy						Tells whether a HighSpeed_Read_Async is on the bus
+HighSpeed_Read_Scatter		Reads a range in one transaction and scatters it over several buffers
+HighSpeed_Read_Hold				Long read that can be paused with HOLD# to lend the bus out
+Hold_Enable								Switches RST#/HOLD# to HOLD and installs the bus lending hooks
+Verify_Data								Compares a flash range against a buffer
+Program_Verify_Enable			Turns read-back verification of page programs on or off
 Page_Program							Programs 1 to 256 data bytes
+Page_Program_Data					Programs 1 to 256 data bytes from a caller buffer
 Dual_Input_Page_Program		Programs 1 to 256 data bytes using dual input
 Chip_Erase								Erases entire serial flash
 Sector_Erase							Erases one sector (4 KB) of the serial flash
 Block_Erase_32K						Erases 32 KByte block memory of the serial flash
 Block_Erase_64K						Erases 64 KByte block memory of the serial flash
 Wait_Busy									Polls status register until busy bit is low
+Wait_Busy_Timeout					Polls status register until busy bit is low or a deadline passes
+SST25_Recover							Resets the SPI master and the serial flash after a timeout or bus error
+SST25_Last_Error					Returns and clears the first error of the plain procedures
+ULBPR											Clears all block protection (SST26 parts only)
 EHLD											Enable Hold pin functionality */
                                                                      
 //"C" LANGUAGE DRIVERS 
@@ -94,6 +109,21 @@ EHLD											Enable Hold pin functionality */
 #include <stdio.h>
 #include <stdbool.h>
 #include <stdint.h>
+#include "SST25VF064C_device.h"
+
+/* SST25_TRANSPORT_SPIDEV, SST25_TRANSPORT_MMAP: the driver itself runs on a
+ * host, on a Linux spidev device or on an image file mapped into memory,
+ * see SST25VF064C_transport.h. Both imply SST25VF064C_HOST. */
+#if defined(SST25_TRANSPORT_SPIDEV) || defined(SST25_TRANSPORT_MMAP)
+#define SST25_TRANSPORT_HOST
+#ifndef SST25VF064C_HOST
+#define SST25VF064C_HOST
+#endif
+#endif
+
+/* SST25VF064C_HOST builds this header without the nRF51 SDK so that host
+ * tools (see tools/) can link the storage layers against a simulated chip. */
+#ifndef SST25VF064C_HOST
 #include "app_error.h"
 #include "app_util_platform.h"
 #include "spi_master.h"
@@ -105,31 +135,173 @@ EHLD											Enable Hold pin functionality */
 #elif defined(SPI_MASTER_1_ENABLE)
     #define SPI_MASTER_HW SPI_MASTER_1
 #endif
+#else
+/* Error codes returned by the driver, values as in the SDK's nrf_error.h. */
+#define NRF_SUCCESS                 0
+#define NRF_ERROR_INTERNAL          3
+#define NRF_ERROR_NO_MEM            4
+#define NRF_ERROR_NOT_FOUND         5
+#define NRF_ERROR_NOT_SUPPORTED     6
+#define NRF_ERROR_INVALID_PARAM     7
+#define NRF_ERROR_INVALID_STATE     8
+#define NRF_ERROR_INVALID_LENGTH    9
+#define NRF_ERROR_INVALID_DATA      11
+#define NRF_ERROR_DATA_SIZE         12
+#define NRF_ERROR_TIMEOUT           13
+#define NRF_ERROR_INVALID_ADDR      16
+#define NRF_ERROR_BUSY              17
+
+/* Host builds run the storage modules from one thread, with no interrupts
+ * to keep out; app_util_platform.h is not available there. */
+#ifndef CRITICAL_REGION_ENTER
+#define CRITICAL_REGION_ENTER()
+#define CRITICAL_REGION_EXIT()
+#endif
+#endif /* SST25VF064C_HOST */
 
 static volatile bool m_transfer_completed = true; /**< A flag to inform about completed transfer. */
 
 #define TX_RX_BUF_LENGTH    16u     /**< SPI transaction buffer length. */
+/* SST25_RADIO_AWARE: SPI transfers only start while the radio is idle
+ * (see SST25_Radio_Notification) and are kept short enough to finish
+ * within the radio notification distance. */
+#ifdef SST25_RADIO_AWARE
+#ifndef SST25_RADIO_MAX_XFER
+#define SST25_RADIO_MAX_XFER 133u   /**< Longest transfer that fits the notification distance. */
+#endif
+#define SST25_MAX_XFER      SST25_RADIO_MAX_XFER
+#elif defined(SST25_TRANSPORT_SPIDEV)
+#ifndef SST25_SPIDEV_BUFSIZ
+#define SST25_SPIDEV_BUFSIZ 4096u   /**< Bytes per spidev message, the kernel's spidev bufsiz. */
+#endif
+#define SST25_MAX_XFER      SST25_SPIDEV_BUFSIZ
+#else
+#define SST25_MAX_XFER      0xFFFFu
+#endif
+
+#if (SST25_MAX_XFER - 5u) < 128u
+#define SST25_READ_CHUNK    (SST25_MAX_XFER - 5u)
+#else
+#define SST25_READ_CHUNK    128u    /**< Bytes per transaction of the buffered reads. */
+#endif
+
+/* SST25_SPI_DIRECT: transfers run on a polled engine that drives the SPI
+ * peripheral registers (TXD/RXD double buffered) instead of the SDK
+ * spi_master, which takes an interrupt per byte. The driver then owns the
+ * chip select, so SST25_MANUAL_CS is implied, and reads into caller buffers
+ * run as one transaction of up to SST25_READ_BURST bytes. The host
+ * transports behave the same way. */
+#if defined(SST25_SPI_DIRECT) || defined(SST25_TRANSPORT_HOST)
+#ifndef SST25_MANUAL_CS
+#define SST25_MANUAL_CS
+#endif
+#define SST25_READ_BURST    (SST25_MAX_XFER - 5u)
+#else
+#define SST25_READ_BURST    SST25_READ_CHUNK    /**< Bytes per transaction of HighSpeed_Read_Data. */
+#endif
+
+/**@brief One segment of a scatter-gather flash command (SPI_Transfer_SG). */
+typedef struct
+{
+    uint8_t const * p_tx;   /**< Bytes to send, NULL to clock out dummy bytes. */
+    uint8_t *       p_rx;   /**< Buffer for the bytes clocked in, NULL to discard them. */
+    uint16_t        len;    /**< Segment length in bytes. */
+} sst25_sg_t;
+
+#define SST25_SG_STAGING    (4u + SST25_PAGE_SIZE)  /**< Largest command without SST25_MANUAL_CS. */
+#define SST25_SCATTER_SEGS  16u     /**< Segments per HighSpeed_Read_Scatter. */
+
+/* SST25_MANUAL_CS: the driver drives the flash chip select (SST25_CS_PIN)
+ * itself, so a command can span several SPI master transfers. The SPI
+ * master then toggles SST25_SPI_SS_PARK_PIN, which the board has to define
+ * as an unconnected pin (not needed with SST25_SPI_DIRECT). Required for
+ * HighSpeed_Read_Hold. */
+#if defined(SST25_MANUAL_CS) && !defined(SST25_CS_PIN) && !defined(SST25_TRANSPORT_HOST)
+    #if defined(SPI_MASTER_0_ENABLE)
+        #define SST25_CS_PIN SPIM0_SS_PIN
+    #else
+        #define SST25_CS_PIN SPIM1_SS_PIN
+    #endif
+#endif
+
+/**@brief Completion callback of HighSpeed_Read_Async, runs in interrupt context. */
+typedef void (*sst25_async_handler_t)(void);
+
+#define SST25_ASYNC_HEADER  5u      /**< Command bytes in front of the data of an async read. */
+#define SST25_ASYNC_MAX     (SST25_MAX_XFER - SST25_ASYNC_HEADER)   /**< Longest async read. */
+
+/**@brief HOLD mode hook: returns true when another device waits for the bus. */
+typedef bool (*sst25_hold_pending_t)(void);
+/**@brief HOLD mode hook: runs the waiting transactions while the flash holds. */
+typedef void (*sst25_hold_lend_t)(void);
+
+/* Bounded waits: the *_Operation procedures poll the busy bit for at most
+ * SST25_TIMEOUT_US of the datasheet maximum of their command, reset the
+ * part with SST25_Recover and repeat the command up to SST25_RETRIES times
+ * before returning NRF_ERROR_TIMEOUT. SPI master errors and lost transfer
+ * completions no longer end in APP_ERROR_CHECK; they are counted in
+ * sst25_health and kept for SST25_Last_Error, which every *_Operation
+ * attempt clears before it starts. */
+#ifndef SST25_POLL_US
+#define SST25_POLL_US       10u     /**< Pause between two busy polls. */
+#endif
+#ifndef SST25_XFER_SLACK_US
+#define SST25_XFER_SLACK_US 10000u  /**< Allowance for a transfer completion delayed by SoftDevice events. */
+#endif
+#ifndef SST25_RETRIES
+#define SST25_RETRIES       1u      /**< Resets and repeats of an operation that failed on the bus or timed out. */
+#endif
+#define SST25_TIMEOUT_US(max_us)    ((max_us) + ((max_us) / 4u))    /**< Deadline: datasheet maximum plus 25 %. */
+
+/**@brief Error and latency counters of the bounded waits. */
+typedef struct
+{
+    unsigned long timeouts;         /**< Busy waits that reached their deadline. */
+    unsigned long bus_errors;       /**< SPI master errors and transfers that never completed. */
+    unsigned long retries;          /**< Operations repeated after SST25_Recover. */
+    unsigned long resets;           /**< SST25_Recover calls. */
+    unsigned long busy_max_us;      /**< Longest busy wait that ended in time, counted in SST25_POLL_US steps. */
+} sst25_health_t;
+
+extern sst25_health_t sst25_health;
+
+#ifdef SST25_MANUAL_CS
+extern unsigned long sst25_hold_count;	/* reads paused with HOLD# so far */
+#endif
 #define DELAY_MS            100u    /**< Timer delay in milliseconds. */
+#ifndef SST25_SPI_MHZ_MAX
+#define SST25_SPI_MHZ_MAX   8u      /**< Fastest SCK of the SPI master (nRF51: 8 MHz). */
+#endif
 
 //Data buffers.
 static uint8_t m_tx_data[TX_RX_BUF_LENGTH] = {0}; /**< A buffer with data to transfer. */
 static uint8_t m_rx_data[TX_RX_BUF_LENGTH] = {0}; /**< A buffer for incoming data. */
 
-extern unsigned char upper_128[128];	/* global array to store read data */
+extern unsigned char upper_128[SST25_PROG_CHUNK];	/* global array to store read data */
 extern unsigned char security_id_32[32];	/* global array to store security_id data */
 
 /* Function Prototypes */
 
-void SST25VF064C_init(void);
-void spi_master_init(spi_master_hw_instance_t spi_master_instance, 
+uint32_t SST25VF064C_init(void);
+unsigned long SST25_SPI_Hz(void);
+void SPI_Bus_Transfer(uint8_t const * p_tx_data, uint16_t tx_len, uint8_t * p_rx_data, uint16_t rx_len);
+void SPI_Transfer_SG(sst25_sg_t const * p_sg, uint8_t count);
+#ifdef SST25_RADIO_AWARE
+void SST25_Radio_Notification(bool radio_active);
+#endif
+#ifndef SST25VF064C_HOST
+uint32_t spi_master_init(spi_master_hw_instance_t spi_master_instance, 
                             spi_master_event_handler_t spi_master_event_handler,
                             const bool lsb);
+#endif
 //void Send_Byte(unsigned char out);
 //void Send_Double_Byte(unsigned char out);
 //unsigned char Get_Byte();
 //unsigned char Get_Double_Byte();
-//void CE_High();
-//void CE_Low();
+#ifdef SST25_MANUAL_CS
+void CE_High(void);
+void CE_Low(void);
+#endif
 void Reset_Hold_Low(void);
 void Reset_Hold_High(void);
 void WP_Low(void);
@@ -145,26 +317,51 @@ unsigned char Read(unsigned long Dst);
 void Read_Cont(unsigned long Dst, unsigned long no_bytes);
 unsigned char HighSpeed_Read(unsigned long Dst); 
 void HighSpeed_Read_Cont(unsigned long Dst, unsigned long no_bytes);
+void HighSpeed_Read_Data(unsigned long Dst, unsigned char * p_data, unsigned long no_bytes);
+#ifdef SST25_MANUAL_CS
+void HighSpeed_Read_Hold(unsigned long Dst, unsigned char * p_data, unsigned long no_bytes);
+void Hold_Enable(sst25_hold_pending_t pending, sst25_hold_lend_t lend, unsigned short chunk);
+#endif
+uint32_t HighSpeed_Read_Data_CRC(unsigned long Dst, unsigned char * p_data, unsigned long no_bytes, uint32_t const * p_crc);
+uint32_t HighSpeed_Read_Async(unsigned long Dst, unsigned char * p_buf, unsigned short no_bytes, sst25_async_handler_t handler);
+bool Read_Async_Busy(void);
+void HighSpeed_Read_Scatter(unsigned long Dst, sst25_sg_t const * p_sg, uint8_t count);
+bool Verify_Data(unsigned long Dst, const unsigned char * p_data, unsigned long no_bytes);
+void Program_Verify_Enable(bool enable);
 void Chip_Erase(void);
 void Sector_Erase(unsigned long Dst);
+#if SST25_BLOCK_32K_SIZE
 void Block_Erase_32K(unsigned long Dst);
+#endif
 void Block_Erase_64K(unsigned long Dst);
-//void Wait_Busy();
+uint32_t Wait_Busy(void);
+uint32_t Wait_Busy_Timeout(unsigned long timeout_us);
+uint32_t SST25_Recover(void);
+uint32_t SST25_Last_Error(void);
 //void Fast_Read_Dual_IO(unsigned long Dst, unsigned long no_bytes);
 //void Fast_Read_Dual_Output(unsigned long Dst, unsigned long no_bytes);
 void Page_Program(unsigned long Dst);
+void Page_Program_Data(unsigned long Dst, const unsigned char * p_data, unsigned short no_bytes);
 //void Dual_Input_Page_Program(unsigned long Dst);
 void EHLD(void);
+#if SST25_HAS_ULBPR
+void ULBPR(void);
+#endif
+#if SST25_SID_SIZE
 void ReadSID(unsigned char Dst, unsigned char security_length); 
 void ProgSID(void); 
 void LockSID(void); 
+#endif
 
 //The following functions include WREN() function and Wait_Busy() function
 //inside them.
 
-void Block_Erase_32K_Operation(unsigned long Dst);
-void Block_Erase_64K_Operation(unsigned long Dst);
-void Sector_Erase_Operation(unsigned long Dst);
-void Page_Program_Operation(unsigned long Dst);
-void Chip_Erase_Operation(void);
+#if SST25_BLOCK_32K_SIZE
+uint32_t Block_Erase_32K_Operation(unsigned long Dst);
+#endif
+uint32_t Block_Erase_64K_Operation(unsigned long Dst);
+uint32_t Sector_Erase_Operation(unsigned long Dst);
+uint32_t Page_Program_Operation(unsigned long Dst);
+uint32_t Page_Program_Data_Operation(unsigned long Dst, const unsigned char * p_data, unsigned short no_bytes);
+uint32_t Chip_Erase_Operation(void);
 #endif
@@ -0,0 +1,154 @@
+/**@file
+ * @brief Read-only asset packs, see SST25VF064C_asset.h.
+ */
+
+#include <stddef.h>
+#include "SST25VF064C_asset.h"
+#include "SST25VF064C_crc32.h"
+
+#define VERIFY_CHUNK    64u
+
+/* Murmur3 finalizer, spreads every input bit over the word. */
+static uint32_t mix32(uint32_t h)
+{
+    h ^= h >> 16;
+    h *= 0x85EBCA6Bul;
+    h ^= h >> 13;
+    h *= 0xC2B2AE35ul;
+    h ^= h >> 16;
+    return h;
+}
+
+static unsigned long entry_addr(sst_asset_pack_t const * p_pack, uint32_t slot)
+{
+    return p_pack->base + sizeof(sst_asset_header_t) + ((2ul * p_pack->header.buckets + 3u) & ~3ul) +
+           slot * sizeof(sst_asset_entry_t);
+}
+
+uint32_t SST_Asset_Id(const char * p_name)
+{
+    uint32_t h = 0x811C9DC5ul;
+
+    while (*p_name)
+    {
+        h ^= (uint8_t)*p_name++;
+        h *= 0x01000193ul;
+    }
+    return h;
+}
+
+uint32_t SST_Asset_Bucket(uint32_t id, uint32_t buckets)
+{
+    return mix32(id) % buckets;
+}
+
+uint32_t SST_Asset_Slot(uint32_t id, uint16_t displacement, uint32_t slots)
+{
+    return mix32(id + 0x9E3779B9ul * (displacement + 1ul)) % slots;
+}
+
+uint32_t SST_Asset_Open(sst_asset_pack_t * p_pack, unsigned long base)
+{
+    sst_asset_header_t * p_hdr = &p_pack->header;
+    unsigned long        dir_end;
+    unsigned long        Dst;
+    uint32_t             crc = 0;
+
+    if (((base % SST25_PAGE_SIZE) != 0) || !SST25_RANGE_VALID(base, sizeof(*p_hdr)))
+    {
+        return NRF_ERROR_INVALID_PARAM;
+    }
+    p_pack->base = base;
+    HighSpeed_Read_Data(base, (unsigned char *)p_hdr, sizeof(*p_hdr));
+    if (p_hdr->magic != SST_ASSET_MAGIC)
+    {
+        return NRF_ERROR_NOT_FOUND;
+    }
+    if ((p_hdr->header_crc != SST_CRC32_Compute((uint8_t const *)p_hdr, offsetof(sst_asset_header_t, header_crc), NULL)) ||
+        (p_hdr->version != SST_ASSET_VERSION) || (p_hdr->buckets == 0) || (p_hdr->slots < p_hdr->count) ||
+        (p_hdr->buckets > SST25_CAPACITY) || (p_hdr->slots > SST25_CAPACITY))
+    {
+        return NRF_ERROR_INVALID_DATA;
+    }
+    dir_end = entry_addr(p_pack, p_hdr->slots) - base;
+    if (((p_hdr->data_offset % SST25_PAGE_SIZE) != 0) || (p_hdr->data_offset < dir_end) ||
+        !SST25_RANGE_VALID(base, p_hdr->data_offset))
+    {
+        return NRF_ERROR_INVALID_DATA;
+    }
+
+    for (Dst = base + sizeof(*p_hdr); Dst < base + dir_end; )
+    {
+        uint8_t       buf[VERIFY_CHUNK];
+        unsigned long n = base + dir_end - Dst;
+
+        n   = (n > sizeof(buf)) ? sizeof(buf) : n;
+        crc = HighSpeed_Read_Data_CRC(Dst, buf, n, &crc);
+        Dst += n;
+    }
+    return (crc == p_hdr->dir_crc) ? NRF_SUCCESS : NRF_ERROR_INVALID_DATA;
+}
+
+uint32_t SST_Asset_Find_Id(sst_asset_pack_t const * p_pack, uint32_t id, sst_asset_t * p_asset)
+{
+    sst_asset_header_t const * p_hdr = &p_pack->header;
+    sst_asset_entry_t          entry;
+    uint16_t                   displacement;
+
+    if ((id == SST_ASSET_ID_NONE) || (p_hdr->count == 0))
+    {
+        return NRF_ERROR_NOT_FOUND;
+    }
+    HighSpeed_Read_Data(p_pack->base + sizeof(*p_hdr) + 2ul * SST_Asset_Bucket(id, p_hdr->buckets),
+                        (unsigned char *)&displacement, sizeof(displacement));
+    HighSpeed_Read_Data(entry_addr(p_pack, SST_Asset_Slot(id, displacement, p_hdr->slots)),
+                        (unsigned char *)&entry, sizeof(entry));
+    if (entry.id != id)
+    {
+        return NRF_ERROR_NOT_FOUND;
+    }
+    if (!SST25_RANGE_VALID(p_pack->base + entry.offset, entry.length) || (entry.offset > SST25_CAPACITY))
+    {
+        return NRF_ERROR_INVALID_DATA;
+    }
+    p_asset->addr   = p_pack->base + entry.offset;
+    p_asset->length = entry.length;
+    p_asset->crc    = entry.crc;
+    return NRF_SUCCESS;
+}
+
+uint32_t SST_Asset_Find(sst_asset_pack_t const * p_pack, const char * p_name, sst_asset_t * p_asset)
+{
+    return SST_Asset_Find_Id(p_pack, SST_Asset_Id(p_name), p_asset);
+}
+
+unsigned long SST_Asset_Read(sst_asset_t const * p_asset, unsigned long offset, uint8_t * p_data, unsigned long no_bytes)
+{
+    if (offset >= p_asset->length)
+    {
+        return 0;
+    }
+    if (no_bytes > p_asset->length - offset)
+    {
+        no_bytes = p_asset->length - offset;
+    }
+    HighSpeed_Read_Data(p_asset->addr + offset, p_data, no_bytes);
+    return no_bytes;
+}
+
+uint32_t SST_Asset_Verify(sst_asset_t const * p_asset)
+{
+    unsigned long offset = 0;
+    uint32_t      crc    = 0;
+
+    while (offset < p_asset->length)
+    {
+        uint8_t       buf[VERIFY_CHUNK];
+        unsigned long n = p_asset->length - offset;
+
+        n       = (n > sizeof(buf)) ? sizeof(buf) : n;
+        crc     = HighSpeed_Read_Data_CRC(p_asset->addr + offset, buf, n, &crc);
+        offset += n;
+    }
+    return (crc == p_asset->crc) ? NRF_SUCCESS : NRF_ERROR_INVALID_DATA;
+}
@@ -0,0 +1,117 @@
+/**@file
+ * @brief Read-only asset packs in the SST25VF064C with O(1) lookup.
+ *
+ * Fonts, tables and audio prompts are packed on the host by
+ * tools/asset_pack.c into one image that is written to the flash as is.
+ * The image starts with a directory:
+ *
+ *     offset 0    sst_asset_header_t
+ *     offset 32   uint16_t displacement[buckets]
+ *     then        sst_asset_entry_t entry[slots], 4 byte aligned
+ *     data_offset assets, each starting on a 256 byte page
+ *
+ * Assets are identified by a 32 bit ID, the FNV-1a hash of their name
+ * (SST_Asset_Id). The directory is a minimal perfect hash (hash and
+ * displace): the ID selects a bucket, the bucket's displacement selects
+ * the entry slot. A lookup therefore reads one displacement and one entry,
+ * 2 + 16 bytes, whatever the number of assets. The entry carries the ID, so
+ * names not in the pack are rejected.
+ *
+ * All offsets are relative to the image start, so the pack can be placed
+ * at any address. Fields are little endian.
+ */
+
+#ifndef SST25VF064C_ASSET_H__
+#define SST25VF064C_ASSET_H__
+
+#include <stdint.h>
+#include "SST25VF064C.h"
+
+#define SST_ASSET_MAGIC         0x4B504153ul    /**< "SAPK" */
+#define SST_ASSET_VERSION       1u
+#define SST_ASSET_BUCKET_KEYS   4u              /**< Average assets per bucket chosen by the packer. */
+#define SST_ASSET_ID_NONE       0xFFFFFFFFul    /**< ID of an unused slot, never assigned. */
+
+/**@brief Image header. */
+typedef struct
+{
+    uint32_t magic;
+    uint16_t version;
+    uint16_t reserved;
+    uint32_t count;                     /**< Assets in the pack. */
+    uint32_t buckets;                   /**< Entries of the displacement table. */
+    uint32_t slots;                     /**< Entries of the entry table, at least count. */
+    uint32_t data_offset;               /**< First asset, page aligned. */
+    uint32_t dir_crc;                   /**< CRC-32 of the displacement and entry tables. */
+    uint32_t header_crc;                /**< CRC-32 of the fields above. */
+} sst_asset_header_t;
+
+/**@brief Directory entry. */
+typedef struct
+{
+    uint32_t id;                        /**< SST_ASSET_ID_NONE for an unused slot. */
+    uint32_t offset;                    /**< From the image start, page aligned. */
+    uint32_t length;
+    uint32_t crc;                       /**< CRC-32 of the asset data. */
+} sst_asset_entry_t;
+
+/**@brief An opened pack. */
+typedef struct
+{
+    unsigned long      base;            /**< Flash address of the image. */
+    sst_asset_header_t header;
+} sst_asset_pack_t;
+
+/**@brief A resolved asset. */
+typedef struct
+{
+    unsigned long addr;                 /**< Flash address, page aligned. */
+    unsigned long length;
+    uint32_t      crc;
+} sst_asset_t;
+
+/**@brief ID of an asset name (FNV-1a). */
+uint32_t SST_Asset_Id(const char * p_name);
+
+/**@brief Bucket of an ID. */
+uint32_t SST_Asset_Bucket(uint32_t id, uint32_t buckets);
+
+/**@brief Slot of an ID for a bucket displacement. */
+uint32_t SST_Asset_Slot(uint32_t id, uint16_t displacement, uint32_t slots);
+
+/**@brief Check the pack header and directory at base.
+ *
+ * Reads the whole directory once to check its CRC.
+ *
+ * @retval NRF_SUCCESS              Pack opened.
+ * @retval NRF_ERROR_INVALID_PARAM  base not page aligned or outside the device.
+ * @retval NRF_ERROR_NOT_FOUND      No pack header at base.
+ * @retval NRF_ERROR_INVALID_DATA   Header or directory corrupted, or directory outside the device.
+ */
+uint32_t SST_Asset_Open(sst_asset_pack_t * p_pack, unsigned long base);
+
+/**@brief Resolve an ID with two small reads.
+ *
+ * @retval NRF_SUCCESS             p_asset filled in.
+ * @retval NRF_ERROR_NOT_FOUND     No such asset.
+ * @retval NRF_ERROR_INVALID_DATA  Entry points outside the device.
+ */
+uint32_t SST_Asset_Find_Id(sst_asset_pack_t const * p_pack, uint32_t id, sst_asset_t * p_asset);
+
+/**@brief Resolve a name, see SST_Asset_Find_Id. */
+uint32_t SST_Asset_Find(sst_asset_pack_t const * p_pack, const char * p_name, sst_asset_t * p_asset);
+
+/**@brief Read part of an asset. Reads past the end are clipped.
+ *
+ * @return Bytes read.
+ */
+unsigned long SST_Asset_Read(sst_asset_t const * p_asset, unsigned long offset, uint8_t * p_data, unsigned long no_bytes);
+
+/**@brief Check an asset against its CRC-32.
+ *
+ * @retval NRF_SUCCESS             Data intact.
+ * @retval NRF_ERROR_INVALID_DATA  CRC mismatch.
+ */
+uint32_t SST_Asset_Verify(sst_asset_t const * p_asset);
+
+#endif /* SST25VF064C_ASSET_H__ */
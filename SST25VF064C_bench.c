@@ -0,0 +1,107 @@
+/**@file
+ * @brief On-target SPI throughput benchmark, see SST25VF064C_bench.h.
+ */
+
+#include <string.h>
+#include "SST25VF064C_bench.h"
+#include "SST25VF064C_put.h"
+
+static uint8_t m_buf[SST_BENCH_BYTES];
+
+static unsigned long rate(unsigned long bytes, uint32_t ticks, uint32_t tick_hz)
+{
+    return (ticks == 0) ? 0 : (unsigned long)(((uint64_t)bytes * tick_hz) / ticks);
+}
+
+uint32_t SST_Bench_Run(unsigned long scratch, sst_bench_time_t time_fn, uint32_t tick_hz, sst_bench_result_t * p_result)
+{
+    uint32_t      program_ticks = 0;
+    uint32_t      t_start;
+    unsigned long offset;
+    unsigned long i;
+    uint8_t       loop;
+    uint32_t      err_code;
+
+    if (((scratch % SST25_SECTOR_SIZE) != 0) || !SST25_RANGE_VALID(scratch, SST25_SECTOR_SIZE))
+    {
+        return NRF_ERROR_INVALID_PARAM;
+    }
+    memset(p_result, 0, sizeof(*p_result));
+    p_result->sck_hz = SST25_SPI_Hz();
+
+    for (i = 0; i < sizeof(m_buf); i++)
+    {
+        m_buf[i] = (uint8_t)(i ^ 0x5A);
+    }
+    err_code = Sector_Erase_Operation(scratch);
+    if (err_code != NRF_SUCCESS)
+    {
+        return err_code;
+    }
+    (void)SST25_Last_Error();
+
+    // Program: only the command transfer is timed, tPP is not.
+    for (offset = 0; offset < SST25_SECTOR_SIZE; offset += SST25_PAGE_SIZE)
+    {
+        WREN();
+        t_start = time_fn();
+        Page_Program_Data(scratch + offset, &m_buf[offset % sizeof(m_buf)], SST25_PAGE_SIZE);
+        program_ticks += time_fn() - t_start;
+        err_code = SST25_Last_Error();
+        if (err_code == NRF_SUCCESS)
+        {
+            err_code = Wait_Busy_Timeout(SST25_TIMEOUT_US(SST25_T_PP_MAX_US));
+        }
+        if (err_code != NRF_SUCCESS)
+        {
+            return err_code;
+        }
+    }
+    p_result->program_bps = rate(SST25_SECTOR_SIZE, program_ticks, tick_hz);
+
+    // Read the sector back in buffer sized pieces.
+    t_start = time_fn();
+    for (loop = 0; loop < SST_BENCH_LOOPS; loop++)
+    {
+        for (offset = 0; offset < SST25_SECTOR_SIZE; offset += sizeof(m_buf))
+        {
+            HighSpeed_Read_Data(scratch + offset, m_buf, sizeof(m_buf));
+        }
+    }
+    p_result->read_bps = rate((unsigned long)SST_BENCH_LOOPS * SST25_SECTOR_SIZE, time_fn() - t_start, tick_hz);
+
+    // Check the whole sector in an untimed pass, every piece holds the same pattern.
+    for (offset = 0; offset < SST25_SECTOR_SIZE; offset += sizeof(m_buf))
+    {
+        HighSpeed_Read_Data(scratch + offset, m_buf, sizeof(m_buf));
+        for (i = 0; i < sizeof(m_buf); i++)
+        {
+            if (m_buf[i] != (uint8_t)(i ^ 0x5A))
+            {
+                return NRF_ERROR_INVALID_DATA;
+            }
+        }
+    }
+    return SST25_Last_Error();
+}
+
+/* Rate as percent of the SCK limit (one byte per 8 clocks). */
+static unsigned long percent(sst_bench_result_t const * p_result, unsigned long bps)
+{
+    return (p_result->sck_hz == 0) ? 0 : (unsigned long)(((uint64_t)bps * 800u) / p_result->sck_hz);
+}
+
+void SST_Bench_Print(sst_bench_result_t const * p_result, sst_bench_put_t put)
+{
+    sst_put_str(put, "SST25BENCH " SST_BENCH_ENGINE " sck=");
+    sst_put_dec(put, p_result->sck_hz);
+    sst_put_str(put, " read=");
+    sst_put_dec(put, p_result->read_bps);
+    put(' ');
+    sst_put_dec(put, percent(p_result, p_result->read_bps));
+    sst_put_str(put, "% program=");
+    sst_put_dec(put, p_result->program_bps);
+    put(' ');
+    sst_put_dec(put, percent(p_result, p_result->program_bps));
+    sst_put_str(put, "%\r\n");
+}
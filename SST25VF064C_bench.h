@@ -0,0 +1,68 @@
+/**@file
+ * @brief On-target SPI throughput benchmark for the SST25VF064C driver.
+ *
+ * Measures the bytes per second the driver moves through its transfer
+ * engine: large reads with HighSpeed_Read_Data and the bus phase of
+ * Page_Program_Data (tPP excluded), each also as a share of the SCK limit.
+ * Build the firmware once as is (SDK spi_master) and once with
+ * SST25_SPI_DIRECT defined (register engine) and compare the two reports.
+ *
+ * Report written by SST_Bench_Print:
+ *   SST25BENCH <engine> sck=<Hz> read=<B/s> <percent of SCK>% program=<B/s> <percent of SCK>%
+ */
+
+#ifndef SST25VF064C_BENCH_H__
+#define SST25VF064C_BENCH_H__
+
+#include <stdint.h>
+#include "SST25VF064C.h"
+
+#ifndef SST_BENCH_BYTES
+#define SST_BENCH_BYTES     1024u   /**< RAM buffer, a multiple of the page size. */
+#endif
+#ifndef SST_BENCH_LOOPS
+#define SST_BENCH_LOOPS     4u      /**< Passes over the scratch sector for the read figure. */
+#endif
+
+#if defined(SST25_TRANSPORT_SPIDEV)
+#define SST_BENCH_ENGINE    "spidev"
+#elif defined(SST25_TRANSPORT_MMAP)
+#define SST_BENCH_ENGINE    "mmap"
+#elif defined(SST25_SPI_DIRECT)
+#define SST_BENCH_ENGINE    "direct"
+#else
+#define SST_BENCH_ENGINE    "spi_master"
+#endif
+
+/**@brief Timestamp source, free running, wrapping at 2^32. */
+typedef uint32_t (*sst_bench_time_t)(void);
+
+/**@brief Byte output for SST_Bench_Print. */
+typedef void (*sst_bench_put_t)(uint8_t byte);
+
+/**@brief Benchmark results. */
+typedef struct
+{
+    unsigned long sck_hz;           /**< SST25_SPI_Hz(). */
+    unsigned long read_bps;         /**< HighSpeed_Read_Data, bytes per second. */
+    unsigned long program_bps;      /**< Page_Program_Data bus phase, bytes per second. */
+} sst_bench_result_t;
+
+/**@brief Erase, program and read back one scratch sector and time it.
+ *
+ * @param[in]  scratch   Sector to use, 4 KByte aligned. Its content is lost.
+ * @param[in]  time_fn   Timestamp source, e.g. a TIMER capture.
+ * @param[in]  tick_hz   Rate of time_fn.
+ * @param[out] p_result  Throughput figures.
+ *
+ * @retval NRF_SUCCESS              Benchmark done.
+ * @retval NRF_ERROR_INVALID_PARAM  scratch not a sector of the device.
+ * @retval NRF_ERROR_INVALID_DATA   Data read back differs from the data programmed.
+ * @return Any other error of the failed erase, program, busy wait or read.
+ */
+uint32_t SST_Bench_Run(unsigned long scratch, sst_bench_time_t time_fn, uint32_t tick_hz, sst_bench_result_t * p_result);
+
+/**@brief Write the report line through a byte output, e.g. simple_uart_put. */
+void SST_Bench_Print(sst_bench_result_t const * p_result, sst_bench_put_t put);
+
+#endif /* SST25VF064C_BENCH_H__ */
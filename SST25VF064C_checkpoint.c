@@ -0,0 +1,535 @@
+/**@file
+ * @brief Incremental checkpoints of RAM state, see SST25VF064C_checkpoint.h.
+ */
+
+#include <stddef.h>
+#include <string.h>
+#include "SST25VF064C_checkpoint.h"
+#include "SST25VF064C_crc32.h"
+
+#define IMAGE_MAGIC     0x474D4943ul    /* "CIMG" */
+#define MANIFEST_MAGIC  0x464E4D43ul    /* "CMNF" */
+
+/* Image header, programmed last into page 0 of an image slot. */
+typedef struct
+{
+    uint32_t magic;
+    uint32_t generation;                /* incremented per image, wraps */
+    uint32_t pages;                     /* state pages, starting at page 1 */
+    uint32_t layout;                    /* CRC-32 of the buffer lengths */
+    uint32_t data_crc;
+    uint32_t header_crc;                /* CRC-32 of the fields above */
+} image_hdr_t;
+
+/* Manifest page, programmed after the delta pages that follow it. */
+typedef struct
+{
+    uint32_t magic;
+    uint32_t generation;                /* image the deltas apply to */
+    uint32_t sequence;                  /* 0, 1, .. since the image */
+    uint16_t count;                     /* delta pages */
+    uint16_t reserved;
+    uint32_t data_crc;                  /* CRC-32 of the delta pages */
+    uint32_t crc;                       /* CRC-32 of the fields above and page[0..count) */
+    uint16_t page[SST_CHECKPOINT_DELTAS];   /* state page of each delta, in log order */
+} manifest_t;
+
+sst_checkpoint_stats_t sst_checkpoint_stats;
+
+static uint8_t *        m_region_data[SST_CHECKPOINT_REGIONS];
+static uint16_t         m_region_len[SST_CHECKPOINT_REGIONS];
+static uint16_t         m_region_page[SST_CHECKPOINT_REGIONS + 1];     /* first state page of each buffer */
+static uint8_t          m_regions;
+static uint32_t         m_dirty[(SST_CHECKPOINT_PAGES + 31u) / 32u];
+
+static unsigned long    m_base;
+static unsigned long    m_image_span;   /* bytes per image slot, 0 before SST_Checkpoint_Init */
+static unsigned long    m_log_base;
+static uint16_t         m_log_pages;
+static image_hdr_t      m_hdr[2];
+static bool             m_hdr_valid[2];
+static bool             m_have;         /* m_current holds an image */
+static bool             m_need_image;   /* the log does not belong to m_current, write an image next */
+static uint8_t          m_current;
+static uint32_t         m_generation;   /* highest generation seen */
+static uint16_t         m_pos;          /* next free log page */
+static uint32_t         m_sequence;     /* next manifest sequence */
+
+static union
+{
+    manifest_t manifest;
+    uint8_t    bytes[SST25_PAGE_SIZE];
+} m_buf;
+
+static uint16_t state_pages(void)
+{
+    return m_region_page[m_regions];
+}
+
+/* Buffer address and length of a state page. */
+static uint8_t * page_data(uint16_t page, uint16_t * p_len)
+{
+    uint8_t  region = 0;
+    uint16_t offset;
+
+    while (page >= m_region_page[region + 1])
+    {
+        region++;
+    }
+    offset = (uint16_t)((page - m_region_page[region]) * SST25_PAGE_SIZE);
+    *p_len = ((uint16_t)(m_region_len[region] - offset) > SST25_PAGE_SIZE) ? SST25_PAGE_SIZE
+                                                                            : (uint16_t)(m_region_len[region] - offset);
+    return m_region_data[region] + offset;
+}
+
+static bool page_dirty(uint16_t page)
+{
+    return (m_dirty[page / 32u] & (1ul << (page % 32u))) != 0;
+}
+
+static void dirty_set(uint16_t first, uint16_t last)
+{
+    for (; first <= last; first++)
+    {
+        m_dirty[first / 32u] |= 1ul << (first % 32u);
+    }
+}
+
+static uint16_t dirty_count(void)
+{
+    uint16_t count = 0;
+    uint16_t page;
+
+    for (page = 0; page < state_pages(); page++)
+    {
+        count += page_dirty(page);
+    }
+    return count;
+}
+
+static unsigned long image_addr(uint8_t slot)
+{
+    return m_base + slot * m_image_span;
+}
+
+static unsigned long log_addr(uint16_t page)
+{
+    return m_log_base + (unsigned long)page * SST25_PAGE_SIZE;
+}
+
+static uint32_t layout_crc(void)
+{
+    uint32_t crc = SST_CRC32_Compute(&m_regions, 1, NULL);
+
+    return SST_CRC32_Compute((uint8_t const *)m_region_len, m_regions * sizeof(m_region_len[0]), &crc);
+}
+
+static uint32_t image_hdr_crc(image_hdr_t const * p_hdr)
+{
+    return SST_CRC32_Compute((uint8_t const *)p_hdr, offsetof(image_hdr_t, header_crc), NULL);
+}
+
+static uint32_t manifest_crc(manifest_t const * p_manifest)
+{
+    uint32_t crc = SST_CRC32_Compute((uint8_t const *)p_manifest, offsetof(manifest_t, crc), NULL);
+
+    return SST_CRC32_Compute((uint8_t const *)p_manifest->page, p_manifest->count * sizeof(p_manifest->page[0]), &crc);
+}
+
+/* Erases a log sector when the write position enters it. The device must not be busy. */
+static uint32_t log_enter(uint16_t page)
+{
+    if ((log_addr(page) % SST25_SECTOR_SIZE) == 0)
+    {
+        return Sector_Erase_Operation(log_addr(page));
+    }
+    return NRF_SUCCESS;
+}
+
+/* Programs one state page into flash and waits for it, hashing it during tPP. */
+static uint32_t page_write(unsigned long Dst, uint8_t const * p_data, uint16_t len, uint32_t * p_crc)
+{
+    uint32_t err_code;
+
+    (void)SST25_Last_Error();
+    WREN();
+    Page_Program_Data(Dst, p_data, len);
+    *p_crc   = SST_CRC32_Compute(p_data, len, p_crc);   /* while the page programs */
+    err_code = SST25_Last_Error();
+    if (err_code != NRF_SUCCESS)
+    {
+        return err_code;
+    }
+    return Wait_Busy_Timeout(SST25_TIMEOUT_US(SST25_T_PP_MAX_US));
+}
+
+/* Reads the manifest at log page pos into m_buf and checks it belongs to the chain. */
+static bool manifest_read(uint16_t pos, uint32_t generation, uint32_t sequence)
+{
+    manifest_t * p_manifest = &m_buf.manifest;
+    uint16_t     i;
+
+    if (pos >= m_log_pages)
+    {
+        return false;
+    }
+    HighSpeed_Read_Data(log_addr(pos), m_buf.bytes, SST25_PAGE_SIZE);
+    if ((p_manifest->magic != MANIFEST_MAGIC) || (p_manifest->generation != generation) ||
+        (p_manifest->sequence != sequence) || (p_manifest->count == 0) ||
+        (p_manifest->count > SST_CHECKPOINT_DELTAS) || (p_manifest->count >= m_log_pages - pos) ||
+        (p_manifest->crc != manifest_crc(p_manifest)))
+    {
+        return false;
+    }
+    for (i = 0; i < p_manifest->count; i++)
+    {
+        if (p_manifest->page[i] >= state_pages())
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+/* Follows the manifests of an image generation, applying them when p_err_code is given. */
+static void log_walk(uint32_t generation, uint32_t * p_err_code)
+{
+    m_pos      = 0;
+    m_sequence = 0;
+
+    while (manifest_read(m_pos, generation, m_sequence))
+    {
+        if (p_err_code != NULL)
+        {
+            uint32_t crc = 0;
+            uint16_t i;
+
+            for (i = 0; i < m_buf.manifest.count; i++)
+            {
+                uint16_t  len;
+                uint8_t * p_data = page_data(m_buf.manifest.page[i], &len);
+
+                crc = HighSpeed_Read_Data_CRC(log_addr(m_pos + 1u + i), p_data, len, &crc);
+            }
+            if (crc != m_buf.manifest.data_crc)
+            {
+                *p_err_code = NRF_ERROR_INVALID_DATA;
+                return;
+            }
+        }
+        m_pos += 1u + m_buf.manifest.count;
+        m_sequence++;
+    }
+
+    // The rest of the current sector has to be blank, an interrupted
+    // checkpoint may have left delta pages behind.
+    memset(m_buf.bytes, 0xFF, sizeof(m_buf.bytes));
+    if ((log_addr(m_pos) % SST25_SECTOR_SIZE) != 0)
+    {
+        uint16_t page;
+
+        for (page = m_pos; (page < m_log_pages) && ((log_addr(page) % SST25_SECTOR_SIZE) != 0); page++)
+        {
+            if (!Verify_Data(log_addr(page), m_buf.bytes, SST25_PAGE_SIZE))
+            {
+                while ((m_pos < m_log_pages) && ((log_addr(m_pos) % SST25_SECTOR_SIZE) != 0))
+                {
+                    m_pos++;
+                }
+                break;
+            }
+        }
+    }
+}
+
+/* Writes the whole state as a new image into the other slot and restarts the log. */
+static uint32_t image_write(void)
+{
+    image_hdr_t   hdr;
+    uint8_t       slot = m_have ? (uint8_t)(1u - m_current) : 0u;
+    unsigned long Dst  = image_addr(slot) + SST25_PAGE_SIZE;
+    unsigned long offset;
+    uint32_t      crc  = 0;
+    uint16_t      page;
+    uint32_t      err_code;
+
+    m_hdr_valid[slot] = false;
+    for (offset = 0; offset < m_image_span; offset += SST25_SECTOR_SIZE)
+    {
+        err_code = Sector_Erase_Operation(image_addr(slot) + offset);
+        if (err_code != NRF_SUCCESS)
+        {
+            return err_code;
+        }
+    }
+
+    for (page = 0; page < state_pages(); page++)
+    {
+        uint16_t  len;
+        uint8_t * p_data = page_data(page, &len);
+
+        err_code = page_write(Dst, p_data, len, &crc);
+        if (err_code != NRF_SUCCESS)
+        {
+            return err_code;
+        }
+        Dst += SST25_PAGE_SIZE;
+    }
+    sst_checkpoint_stats.pages_written += state_pages();
+
+    hdr.magic      = IMAGE_MAGIC;
+    hdr.generation = m_generation + 1u;
+    hdr.pages      = state_pages();
+    hdr.layout     = layout_crc();
+    hdr.data_crc   = crc;
+    hdr.header_crc = image_hdr_crc(&hdr);
+
+    err_code = Page_Program_Data_Operation(image_addr(slot), (const unsigned char *)&hdr, sizeof(hdr));
+    if (err_code != NRF_SUCCESS)
+    {
+        return err_code;
+    }
+    m_hdr[slot]       = hdr;
+    m_hdr_valid[slot] = true;
+    m_have            = true;
+    m_need_image      = false;
+    m_current         = slot;
+    m_generation      = hdr.generation;
+    m_pos             = 0;
+    m_sequence        = 0;
+    sst_checkpoint_stats.images++;
+    return NRF_SUCCESS;
+}
+
+/* Appends the dirty pages and their manifest to the log. */
+static uint32_t delta_write(uint16_t count)
+{
+    manifest_t * p_manifest = &m_buf.manifest;
+    uint16_t     pos        = m_pos;
+    uint32_t     crc        = 0;
+    uint16_t     n          = 0;
+    uint16_t     page;
+    uint32_t     err_code;
+
+    // A failed step leaves the log end unreliable, the next checkpoint is an image.
+    m_need_image = true;
+    err_code     = log_enter(pos);      /* the manifest page is programmed last */
+    for (page = 0; (page < state_pages()) && (err_code == NRF_SUCCESS); page++)
+    {
+        uint16_t  len;
+        uint8_t * p_data;
+
+        if (!page_dirty(page))
+        {
+            continue;
+        }
+        p_data   = page_data(page, &len);
+        err_code = log_enter(pos + 1u + n);
+        if (err_code == NRF_SUCCESS)
+        {
+            err_code = page_write(log_addr(pos + 1u + n), p_data, len, &crc);
+        }
+        p_manifest->page[n++] = page;
+    }
+    if (err_code != NRF_SUCCESS)
+    {
+        return err_code;
+    }
+    sst_checkpoint_stats.pages_written += count;
+
+    p_manifest->magic      = MANIFEST_MAGIC;
+    p_manifest->generation = m_hdr[m_current].generation;
+    p_manifest->sequence   = m_sequence;
+    p_manifest->count      = count;
+    p_manifest->reserved   = 0xFFFFu;
+    p_manifest->data_crc   = crc;
+    p_manifest->crc        = manifest_crc(p_manifest);
+
+    m_pos += 1u + count;
+    err_code = Page_Program_Data_Operation(log_addr(pos), m_buf.bytes,
+                                           (unsigned short)(offsetof(manifest_t, page) + count * sizeof(p_manifest->page[0])));
+    if (err_code != NRF_SUCCESS)
+    {
+        return err_code;
+    }
+    m_need_image = false;
+    m_sequence++;
+    sst_checkpoint_stats.checkpoints++;
+    return NRF_SUCCESS;
+}
+
+uint32_t SST_Checkpoint_Register(void * p_data, uint16_t len)
+{
+    uint16_t pages = (uint16_t)((len + SST25_PAGE_SIZE - 1u) / SST25_PAGE_SIZE);
+
+    if (m_image_span != 0)
+    {
+        return NRF_ERROR_INVALID_STATE;
+    }
+    if (len == 0)
+    {
+        return NRF_ERROR_INVALID_PARAM;
+    }
+    if ((m_regions == SST_CHECKPOINT_REGIONS) || (state_pages() + pages > SST_CHECKPOINT_PAGES))
+    {
+        return NRF_ERROR_NO_MEM;
+    }
+    m_region_data[m_regions]     = (uint8_t *)p_data;
+    m_region_len[m_regions]      = len;
+    m_region_page[m_regions + 1] = (uint16_t)(m_region_page[m_regions] + pages);
+    dirty_set(m_region_page[m_regions], (uint16_t)(m_region_page[m_regions + 1] - 1u));
+    m_regions++;
+    return NRF_SUCCESS;
+}
+
+uint32_t SST_Checkpoint_Init(unsigned long base, unsigned long size)
+{
+    unsigned long span;
+    uint32_t      layout;
+    uint8_t       slot;
+
+    if (m_regions == 0)
+    {
+        return NRF_ERROR_INVALID_STATE;
+    }
+    span = (((1ul + state_pages()) * SST25_PAGE_SIZE + SST25_SECTOR_SIZE - 1u) / SST25_SECTOR_SIZE) * SST25_SECTOR_SIZE;
+    if (((base % SST25_SECTOR_SIZE) != 0) || ((size % SST25_SECTOR_SIZE) != 0) ||
+        (size < 2u * span + SST25_SECTOR_SIZE) || !SST25_RANGE_VALID(base, size))
+    {
+        return NRF_ERROR_INVALID_PARAM;
+    }
+    m_base       = base;
+    m_image_span = span;
+    m_log_base   = base + 2u * span;
+    m_log_pages  = (uint16_t)(((base + size - m_log_base) / SST25_PAGE_SIZE > 0xFFFFu) ? 0xFFFFu
+                                                                                      : (base + size - m_log_base) / SST25_PAGE_SIZE);
+    m_have       = false;
+    m_need_image = false;
+    m_generation = 0;
+
+    layout = layout_crc();
+    for (slot = 0; slot < 2; slot++)
+    {
+        HighSpeed_Read_Data(image_addr(slot), (unsigned char *)&m_hdr[slot], sizeof(m_hdr[slot]));
+        m_hdr_valid[slot] = (m_hdr[slot].magic == IMAGE_MAGIC) &&
+                            (m_hdr[slot].header_crc == image_hdr_crc(&m_hdr[slot])) &&
+                            (m_hdr[slot].pages == state_pages()) && (m_hdr[slot].layout == layout);
+        if (m_hdr_valid[slot] && (!m_have || ((int32_t)(m_hdr[slot].generation - m_generation) > 0)))
+        {
+            m_have       = true;
+            m_current    = slot;
+            m_generation = m_hdr[slot].generation;
+        }
+    }
+    if (m_have)
+    {
+        log_walk(m_generation, NULL);
+    }
+    return NRF_SUCCESS;
+}
+
+void SST_Checkpoint_Mark(const void * p_data, uint16_t len)
+{
+    uintptr_t start = (uintptr_t)p_data;
+    uintptr_t end   = start + len;
+    uint8_t   region;
+
+    for (region = 0; (region < m_regions) && (len != 0); region++)
+    {
+        uintptr_t r_start = (uintptr_t)m_region_data[region];
+        uintptr_t r_end   = r_start + m_region_len[region];
+
+        if ((start < r_end) && (end > r_start))
+        {
+            uintptr_t first = (start > r_start) ? start : r_start;
+            uintptr_t last  = ((end < r_end) ? end : r_end) - 1u;
+
+            dirty_set((uint16_t)(m_region_page[region] + (first - r_start) / SST25_PAGE_SIZE),
+                      (uint16_t)(m_region_page[region] + (last - r_start) / SST25_PAGE_SIZE));
+        }
+    }
+}
+
+uint32_t SST_Checkpoint_Save(void)
+{
+    uint16_t count = dirty_count();
+    uint32_t err_code;
+
+    if (m_image_span == 0)
+    {
+        return NRF_ERROR_INVALID_STATE;
+    }
+    if (count == 0)
+    {
+        return NRF_SUCCESS;
+    }
+
+    if (!m_have || m_need_image || (count > SST_CHECKPOINT_DELTAS) || (count >= m_log_pages - m_pos))
+    {
+        err_code = image_write();
+    }
+    else
+    {
+        err_code = delta_write(count);
+    }
+    if (err_code == NRF_SUCCESS)
+    {
+        memset(m_dirty, 0, sizeof(m_dirty));
+    }
+    return err_code;
+}
+
+uint32_t SST_Checkpoint_Restore(void)
+{
+    uint32_t err_code = NRF_ERROR_NOT_FOUND;
+    uint8_t  order[2];
+    uint8_t  i;
+
+    if (m_image_span == 0)
+    {
+        return NRF_ERROR_INVALID_STATE;
+    }
+    if (!m_have)
+    {
+        return NRF_ERROR_NOT_FOUND;
+    }
+    order[0] = m_current;
+    order[1] = (uint8_t)(1u - m_current);
+
+    for (i = 0; i < 2; i++)
+    {
+        uint8_t       slot = order[i];
+        unsigned long Dst  = image_addr(slot) + SST25_PAGE_SIZE;
+        uint32_t      crc  = 0;
+        uint8_t       region;
+
+        if (!m_hdr_valid[slot])
+        {
+            continue;
+        }
+        for (region = 0; region < m_regions; region++)
+        {
+            crc = HighSpeed_Read_Data_CRC(Dst + (unsigned long)m_region_page[region] * SST25_PAGE_SIZE,
+                                          m_region_data[region], m_region_len[region], &crc);
+        }
+        if (crc != m_hdr[slot].data_crc)
+        {
+            m_hdr_valid[slot] = false;
+            err_code          = NRF_ERROR_INVALID_DATA;
+            continue;
+        }
+
+        err_code = NRF_SUCCESS;
+        log_walk(m_hdr[slot].generation, &err_code);
+        if ((err_code != NRF_SUCCESS) || (slot != m_current))
+        {
+            // The log end is unreliable, start over with a new image.
+            m_need_image = true;
+        }
+        m_current = slot;
+        memset(m_dirty, 0, sizeof(m_dirty));
+        return err_code;
+    }
+    m_need_image = true;
+    return err_code;
+}
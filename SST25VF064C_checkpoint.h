@@ -0,0 +1,99 @@
+/**@file
+ * @brief Incremental checkpoints of RAM state in the SST25VF064C.
+ *
+ * Registered buffers are split into 256 byte pages. The application marks
+ * the pages it modifies with SST_Checkpoint_Mark, and SST_Checkpoint_Save
+ * appends only the dirty pages to a log region, followed by a manifest page
+ * listing them with a CRC-32. The cost of a checkpoint therefore follows the
+ * amount of change, not the size of the state.
+ *
+ * The flash region holds two base image slots and the log:
+ *
+ *     | image A | image B | log: [manifest][delta]..[manifest][delta].. |
+ *
+ * An image is a full copy of the state with a header page programmed last.
+ * When the dirty pages do not fit one manifest or the log is full, a new
+ * image with the next generation number is written into the other slot and
+ * the log starts over; log sectors are erased when the write position
+ * enters them. A manifest is programmed after its delta pages and carries
+ * the image generation and a sequence number, so a checkpoint interrupted
+ * by a reset is ignored and older log contents never apply to a newer image.
+ *
+ * SST_Checkpoint_Restore reads the newest image and applies the manifests of
+ * its generation in order, both straight into the registered buffers.
+ *
+ * Register all buffers before SST_Checkpoint_Init, and do not modify them
+ * while SST_Checkpoint_Save runs.
+ */
+
+#ifndef SST25VF064C_CHECKPOINT_H__
+#define SST25VF064C_CHECKPOINT_H__
+
+#include <stdint.h>
+#include "SST25VF064C.h"
+
+#ifndef SST_CHECKPOINT_REGIONS
+#define SST_CHECKPOINT_REGIONS  8u      /**< Maximum number of registered buffers. */
+#endif
+
+#ifndef SST_CHECKPOINT_PAGES
+#define SST_CHECKPOINT_PAGES    128u    /**< Maximum state size in 256 byte pages. */
+#endif
+
+/**@brief Dirty pages a single manifest can list. Larger changes write a new image. */
+#define SST_CHECKPOINT_DELTAS   116u
+
+/**@brief Checkpoint counters. */
+typedef struct
+{
+    unsigned long checkpoints;          /**< Incremental checkpoints written. */
+    unsigned long images;               /**< Full images written. */
+    unsigned long pages_written;        /**< Delta and image pages programmed, headers excluded. */
+} sst_checkpoint_stats_t;
+
+extern sst_checkpoint_stats_t sst_checkpoint_stats;
+
+/**@brief Add a buffer to the state. All its pages start out dirty.
+ *
+ * @retval NRF_SUCCESS              Buffer added.
+ * @retval NRF_ERROR_NO_MEM         SST_CHECKPOINT_REGIONS or SST_CHECKPOINT_PAGES exceeded.
+ * @retval NRF_ERROR_INVALID_PARAM  Buffer of length 0.
+ * @retval NRF_ERROR_INVALID_STATE  Called after SST_Checkpoint_Init.
+ */
+uint32_t SST_Checkpoint_Register(void * p_data, uint16_t len);
+
+/**@brief Set up the flash region and locate the newest image and log end.
+ *
+ * @param[in] base  Region start, 4 KByte aligned.
+ * @param[in] size  Region size, a multiple of 4 KByte. Has to hold two
+ *                  images (header page plus state) and at least one log sector.
+ *
+ * @retval NRF_SUCCESS              Region set up.
+ * @retval NRF_ERROR_INVALID_STATE  No buffer registered.
+ * @retval NRF_ERROR_INVALID_PARAM  Region not aligned, too small or exceeds the device.
+ */
+uint32_t SST_Checkpoint_Init(unsigned long base, unsigned long size);
+
+/**@brief Mark a modified range of a registered buffer. Ranges outside all buffers are ignored. */
+void SST_Checkpoint_Mark(const void * p_data, uint16_t len);
+
+/**@brief Write the dirty pages as a checkpoint, or a full image when needed.
+ *
+ * @retval NRF_SUCCESS              Checkpoint written, or nothing was dirty.
+ * @retval NRF_ERROR_INVALID_STATE  SST_Checkpoint_Init not called.
+ * @retval NRF_ERROR_INVALID_DATA   Program-verify of the manifest or image header failed.
+ * @return Any other error of a failed erase, program or busy wait. The pages
+ *         stay dirty and the next checkpoint writes a full image.
+ */
+uint32_t SST_Checkpoint_Save(void);
+
+/**@brief Load the newest image and apply its checkpoints to the registered buffers.
+ *
+ * @retval NRF_SUCCESS              State restored.
+ * @retval NRF_ERROR_INVALID_STATE  SST_Checkpoint_Init not called.
+ * @retval NRF_ERROR_NOT_FOUND      No image with the registered layout, buffers untouched.
+ * @retval NRF_ERROR_INVALID_DATA   Image or delta pages corrupted, buffer contents undefined.
+ */
+uint32_t SST_Checkpoint_Restore(void);
+
+#endif /* SST25VF064C_CHECKPOINT_H__ */
@@ -0,0 +1,32 @@
+/**@file
+ * @brief CRC-32 (IEEE 802.3, as used by zlib) for flash integrity checks.
+ */
+
+#ifndef SST25VF064C_CRC32_H__
+#define SST25VF064C_CRC32_H__
+
+#include <stdint.h>
+
+/**@brief Function for calculating or continuing a CRC-32.
+ *
+ * @param[in] p_data  Data to process.
+ * @param[in] size    Number of bytes.
+ * @param[in] p_crc   Result of the previous call when the data is processed
+ *                    in parts, or NULL to start a new calculation.
+ *
+ * @return Updated CRC-32.
+ */
+uint32_t SST_CRC32_Compute(uint8_t const * p_data, uint32_t size, uint32_t const * p_crc);
+
+/**@brief Function for copying data and updating a CRC-32 in the same pass.
+ *
+ * @param[out] p_dst  Destination, any alignment.
+ * @param[in]  p_src  Data to copy and process.
+ * @param[in]  size   Number of bytes.
+ * @param[in]  p_crc  Previous result, or NULL to start a new calculation.
+ *
+ * @return Updated CRC-32.
+ */
+uint32_t SST_CRC32_Compute_Copy(uint8_t * p_dst, uint8_t const * p_src, uint32_t size, uint32_t const * p_crc);
+
+#endif /* SST25VF064C_CRC32_H__ */
@@ -0,0 +1,42 @@
+/**@file
+ * @brief Run-time profiles of the SST25/SST26 family, see SST25VF064C_device.h.
+ */
+
+#include <stddef.h>
+#include "SST25VF064C_device.h"
+
+static const sst25_profile_t m_profiles[] =
+{
+    //  JEDEC ID     name           capacity   capabilities                                                      03h  0Bh (MHz)
+    { 0xBF254Bul, "SST25VF064C", 0x800000ul, SST25_CAP_PAGE_PROGRAM | SST25_CAP_DUAL_IO | SST25_CAP_EHLD,       50,  80 },
+    { 0xBF254Aul, "SST25VF032B", 0x400000ul, SST25_CAP_AAI,                                                     25,  80 },
+    { 0xBF2541ul, "SST25VF016B", 0x200000ul, SST25_CAP_AAI,                                                     25,  80 },
+    { 0xBF258Eul, "SST25VF080B", 0x100000ul, SST25_CAP_AAI,                                                     50,  80 },
+    { 0xBF2643ul, "SST26VF064B", 0x800000ul, SST25_CAP_PAGE_PROGRAM | SST25_CAP_DUAL_IO | SST25_CAP_RESET_CMD,  40, 104 },
+    { 0xBF2642ul, "SST26VF032B", 0x400000ul, SST25_CAP_PAGE_PROGRAM | SST25_CAP_DUAL_IO | SST25_CAP_RESET_CMD,  40, 104 },
+    { 0xBF2641ul, "SST26VF016B", 0x200000ul, SST25_CAP_PAGE_PROGRAM | SST25_CAP_DUAL_IO | SST25_CAP_RESET_CMD,  40, 104 },
+};
+
+#if defined(SST25_DEVICE_SST26VF064B)
+const sst25_profile_t * sst25_profile = &m_profiles[4];
+#elif defined(SST25_DEVICE_SST26VF032B)
+const sst25_profile_t * sst25_profile = &m_profiles[5];
+#elif defined(SST25_DEVICE_SST26VF016B)
+const sst25_profile_t * sst25_profile = &m_profiles[6];
+#else
+const sst25_profile_t * sst25_profile = &m_profiles[0];
+#endif
+
+const sst25_profile_t * SST25_Profile_Find(uint32_t jedec_id)
+{
+    uint8_t i;
+
+    for (i = 0; i < (sizeof(m_profiles) / sizeof(m_profiles[0])); i++)
+    {
+        if (m_profiles[i].jedec_id == jedec_id)
+        {
+            return &m_profiles[i];
+        }
+    }
+    return NULL;
+}
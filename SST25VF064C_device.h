@@ -0,0 +1,136 @@
+/**@file
+ * @brief Compile-time description of the serial flash the driver is built for.
+ *
+ * Every size, opcode and timing the driver and the storage modules depend
+ * on comes from here, so bounds checks and address arithmetic fold into
+ * constants. Select the part with one SST25_DEVICE_<part> define in the
+ * project settings; without one the SST25VF064C is assumed.
+ *
+ * Supported build targets are the SST25/SST26 devices with a 256 byte
+ * Page-Program command. The SST25VF0xxB parts only have Byte-Program/AAI
+ * and are rejected as build target, although the run-time profiles below
+ * let a build for a larger part drive them; their HOLD# is a pin of its
+ * own, with neither EHLD nor a reset. On the SST26VF0xxB:
+ *   - Block-Erase (D8h) erases 8, 32 or 64 KByte depending on the address,
+ *     so SST25_BLOCK_64K_SIZE is 0 and the storage modules stick to 4 KByte
+ *     sectors, and there is no 32 KByte erase.
+ *   - The device powers up write protected; call ULBPR() after WREN().
+ *   - The 2 KByte security ID is not covered by ReadSID/ProgSID.
+ *   - HOLD# is always enabled, EHLD is not needed.
+ *
+ * Timings are datasheet values, typical for modelling and maximum for
+ * timeouts.
+ */
+
+#ifndef SST25VF064C_DEVICE_H__
+#define SST25VF064C_DEVICE_H__
+
+#include <stdint.h>
+
+#if defined(SST25_DEVICE_SST26VF016B) || defined(SST25_DEVICE_SST26VF032B) || defined(SST25_DEVICE_SST26VF064B)
+
+#if defined(SST25_DEVICE_SST26VF016B)
+#define SST25_DEVICE_NAME       "SST26VF016B"
+#define SST25_JEDEC_ID          0xBF2641ul
+#define SST25_CAPACITY          0x200000ul
+#elif defined(SST25_DEVICE_SST26VF032B)
+#define SST25_DEVICE_NAME       "SST26VF032B"
+#define SST25_JEDEC_ID          0xBF2642ul
+#define SST25_CAPACITY          0x400000ul
+#else
+#define SST25_DEVICE_NAME       "SST26VF064B"
+#define SST25_JEDEC_ID          0xBF2643ul
+#define SST25_CAPACITY          0x800000ul
+#endif
+#define SST25_BLOCK_32K_SIZE    0ul         /**< No 32 KByte erase. */
+#define SST25_BLOCK_64K_SIZE    0ul         /**< D8h block size depends on the address. */
+#define SST25_OP_CHIP_ERASE     0xC7u
+#define SST25_HAS_EHLD          0
+#define SST25_HAS_ULBPR         1
+#define SST25_SID_SIZE          0u          /**< ReadSID/ProgSID not available. */
+#define SST25_SID_USER_OFFSET   0u
+#define SST25_T_PP_TYP_US       1000ul
+#define SST25_T_PP_MAX_US       1500ul
+
+#elif defined(SST25_DEVICE_SST25VF016B) || defined(SST25_DEVICE_SST25VF032B) || defined(SST25_DEVICE_SST25VF080B)
+
+#error "SST25VF0xxB parts have no Page-Program command, the driver needs one"
+
+#else /* SST25VF064C */
+
+#ifndef SST25_DEVICE_SST25VF064C
+#define SST25_DEVICE_SST25VF064C
+#endif
+#define SST25_DEVICE_NAME       "SST25VF064C"
+#define SST25_JEDEC_ID          0xBF254Bul
+#define SST25_CAPACITY          0x800000ul
+#define SST25_BLOCK_32K_SIZE    0x8000ul
+#define SST25_BLOCK_64K_SIZE    0x10000ul
+#define SST25_OP_CHIP_ERASE     0x60u       /**< C7h works as well. */
+#define SST25_HAS_EHLD          1
+#define SST25_HAS_ULBPR         0
+#define SST25_SID_SIZE          32u         /**< Security ID bytes. */
+#define SST25_SID_USER_OFFSET   8u          /**< First user programmable SID byte. */
+#define SST25_T_PP_TYP_US       1500ul
+#define SST25_T_PP_MAX_US       2500ul
+
+#endif
+
+/* Common to the whole family. */
+#define SST25_PAGE_SIZE         256u        /**< Page program granularity of the device. */
+#define SST25_SECTOR_SIZE       4096u       /**< Smallest erase unit of the device. */
+#define SST25_PROG_CHUNK        128u        /**< Size of upper_128, bytes per Page_Program. */
+#define SST25_ADDR_MASK         (SST25_CAPACITY - 1ul)
+#define SST25_T_SE_TYP_US       18000ul     /**< Sector-Erase. */
+#define SST25_T_SE_MAX_US       25000ul
+#define SST25_T_BE_TYP_US       18000ul     /**< Block-Erase. */
+#define SST25_T_BE_MAX_US       25000ul
+#define SST25_T_CE_TYP_US       35000ul     /**< Chip-Erase. */
+#define SST25_T_CE_MAX_US       50000ul
+#define SST25_T_RECOVERY_US     1000ul      /**< Reset recovery from an interrupted erase. */
+
+/**@brief true if [addr, addr + len) lies inside the device. */
+#define SST25_RANGE_VALID(addr, len) \
+    (((unsigned long)(addr) <= SST25_CAPACITY) && ((unsigned long)(len) <= (SST25_CAPACITY - (unsigned long)(addr))))
+
+/* Run-time profiles, see SST25VF064C_device.c. SST25VF064C_init reads the
+ * JEDEC ID and selects the matching profile, so a board fitted with another
+ * family member is driven with that part's program and read commands. The
+ * compile-time values above remain the bounds the storage modules check
+ * against; on a smaller part use sst25_profile->capacity. */
+
+#define SST25_CAP_PAGE_PROGRAM  0x01u   /**< 256 byte Page-Program (02h). */
+#define SST25_CAP_AAI           0x02u   /**< Auto Address Increment word program (ADh). */
+#define SST25_CAP_DUAL_IO       0x04u   /**< Dual output/IO reads (not usable on the nRF51 SPI). */
+#define SST25_CAP_EHLD          0x08u   /**< RST#/HOLD# needs EHLD to act as HOLD#. */
+#define SST25_CAP_RESET_CMD     0x10u   /**< Software reset, Reset-Enable (66h) then Reset (99h). */
+
+/**@brief Capabilities of one family member. */
+typedef struct
+{
+    uint32_t     jedec_id;          /**< Manufacturer, memory type and capacity bytes. */
+    const char * p_name;
+    uint32_t     capacity;          /**< Bytes. */
+    uint8_t      caps;              /**< SST25_CAP_ flags. */
+    uint8_t      read_mhz;          /**< Maximum clock of Read (03h). */
+    uint8_t      fast_read_mhz;     /**< Maximum clock of High-Speed-Read (0Bh). */
+} sst25_profile_t;
+
+/**@brief Profile of the part found by SST25VF064C_init (the compile-time part before). */
+extern const sst25_profile_t * sst25_profile;
+
+/**@brief Look up a JEDEC ID in the built-in profile table.
+ *
+ * @return Matching profile, or NULL for an unknown part.
+ */
+const sst25_profile_t * SST25_Profile_Find(uint32_t jedec_id);
+
+#if ((SST25_CAPACITY & SST25_ADDR_MASK) != 0) || ((SST25_CAPACITY % SST25_SECTOR_SIZE) != 0)
+#error "SST25_CAPACITY has to be a power of two multiple of the sector size"
+#endif
+
+#if (SST25_PROG_CHUNK > SST25_PAGE_SIZE) || ((SST25_PAGE_SIZE % SST25_PROG_CHUNK) != 0)
+#error "SST25_PROG_CHUNK has to divide the page size"
+#endif
+
+#endif /* SST25VF064C_DEVICE_H__ */
@@ -0,0 +1,175 @@
+/**@file
+ * @brief Interrupt-safe logging into the SST25VF064C.
+ */
+
+#include <string.h>
+#include "SST25VF064C_log.h"
+
+#define LOG_MASK    (SST_LOG_PAGES - 1u)
+
+sst_log_stats_t sst_log_stats;
+
+static uint8_t          m_pages[SST_LOG_PAGES][SST25_PAGE_SIZE];
+static volatile uint8_t m_head;     /* pages completed by the producer */
+static volatile uint8_t m_tail;     /* pages programmed by the consumer */
+static uint16_t         m_fill;     /* bytes in page m_head, producer only */
+
+static unsigned long    m_base;
+static unsigned long    m_size;
+static unsigned long    m_write;    /* next flash page, consumer only */
+static bool             m_bad;      /* the erase of m_write's sector failed */
+
+/* Reads the page at addr into the ring, which is empty during SST_Log_Init. */
+static bool page_blank(unsigned long addr)
+{
+    uint16_t i;
+
+    HighSpeed_Read_Data(addr, m_pages[0], SST25_PAGE_SIZE);
+    for (i = 0; i < SST25_PAGE_SIZE; i++)
+    {
+        if (m_pages[0][i] != 0xFF)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+void SST_Log_Init(unsigned long base, unsigned long size)
+{
+    unsigned long sector;
+
+    m_base  = base;
+    m_size  = size;
+    m_write = base;
+    m_bad   = false;
+
+    // Resume at the first blank page behind a written one. Sectors are
+    // filled in order, so only one whose last page is blank can hold it.
+    for (sector = base; sector < base + size; sector += SST25_SECTOR_SIZE)
+    {
+        unsigned long last = sector + SST25_SECTOR_SIZE - SST25_PAGE_SIZE;
+        unsigned long page = sector;
+
+        if (!page_blank(last))
+        {
+            continue;
+        }
+        while ((page < last) && !page_blank(page))
+        {
+            page += SST25_PAGE_SIZE;
+        }
+        if ((page != sector) || !page_blank(((sector == base) ? (base + size) : sector) - SST25_PAGE_SIZE))
+        {
+            m_write = page;
+            break;
+        }
+    }
+
+    m_head  = 0;
+    m_tail  = 0;
+    m_fill  = 0;
+    memset(&sst_log_stats, 0, sizeof(sst_log_stats));
+}
+
+bool SST_Log_Append(const void * p_data, uint16_t len)
+{
+    const uint8_t * p_src  = (const uint8_t *)p_data;
+    uint8_t         head   = m_head;
+    uint8_t         used   = (uint8_t)(head - m_tail);
+    unsigned long   space  = (unsigned long)(SST_LOG_PAGES - used) * SST25_PAGE_SIZE - m_fill;
+
+    if ((used >= SST_LOG_PAGES) || (len > space))
+    {
+        sst_log_stats.overflow_records++;
+        sst_log_stats.overflow_bytes += len;
+        return false;
+    }
+
+    while (len)
+    {
+        uint16_t n = (uint16_t)(SST25_PAGE_SIZE - m_fill);
+
+        if (n > len)
+        {
+            n = len;
+        }
+        memcpy(&m_pages[head & LOG_MASK][m_fill], p_src, n);
+        m_fill += n;
+        p_src  += n;
+        len    -= n;
+
+        if (m_fill == SST25_PAGE_SIZE)
+        {
+            m_fill = 0;
+            head++;
+            m_head = head;      /* publish after the page content is written */
+        }
+    }
+
+    used = (uint8_t)(head - m_tail);
+    if (used > sst_log_stats.max_pending)
+    {
+        sst_log_stats.max_pending = used;
+    }
+    return true;
+}
+
+void SST_Log_Flush(void)
+{
+    while (m_tail != m_head)
+    {
+        uint32_t err_code = NRF_SUCCESS;
+
+        if ((m_write % SST25_SECTOR_SIZE) == 0)
+        {
+            m_bad = (Sector_Erase_Operation(m_write) != NRF_SUCCESS);
+        }
+
+        // Pages of a sector that failed to erase are dropped, not programmed over old data.
+        if (!m_bad)
+        {
+            (void)SST25_Last_Error();
+            WREN();
+            Page_Program_Data(m_write, m_pages[m_tail & LOG_MASK], SST25_PAGE_SIZE);
+            err_code = SST25_Last_Error();
+        }
+        m_tail++;           /* the page has been sent, the producer may reuse it */
+        if (!m_bad && (err_code == NRF_SUCCESS))
+        {
+            err_code = Wait_Busy_Timeout(SST25_TIMEOUT_US(SST25_T_PP_MAX_US));
+        }
+
+        if (!m_bad && (err_code == NRF_SUCCESS))
+        {
+            sst_log_stats.pages_written++;
+        }
+        else
+        {
+            sst_log_stats.errors++;
+        }
+        m_write += SST25_PAGE_SIZE;
+        if (m_write >= (m_base + m_size))
+        {
+            m_write = m_base;
+        }
+    }
+}
+
+void SST_Log_Sync(void)
+{
+    CRITICAL_REGION_ENTER();
+    if (m_fill)
+    {
+        memset(&m_pages[m_head & LOG_MASK][m_fill], 0xFF, SST25_PAGE_SIZE - m_fill);
+        m_fill = 0;
+        m_head++;
+    }
+    CRITICAL_REGION_EXIT();
+    SST_Log_Flush();
+}
+
+unsigned long SST_Log_Position(void)
+{
+    return m_write;
+}
@@ -0,0 +1,69 @@
+/**@file
+ * @brief Interrupt-safe logging into the SST25VF064C.
+ *
+ * A single producer (one interrupt priority, or main context) appends
+ * records to a ring of RAM pages without blocking. SST_Log_Flush, called
+ * from main context, programs every completed page with one page program
+ * and erases the next sector of the log region when the write position
+ * enters it. Records that do not fit in the free RAM pages are dropped and
+ * counted, so bursts up to the ring size are absorbed while the device is
+ * busy with tPP or tSE.
+ *
+ * Producers running at more than one interrupt priority have to wrap
+ * SST_Log_Append in CRITICAL_REGION_ENTER/EXIT.
+ */
+
+#ifndef SST25VF064C_LOG_H__
+#define SST25VF064C_LOG_H__
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "SST25VF064C.h"
+
+#ifndef SST_LOG_PAGES
+#define SST_LOG_PAGES   4u      /**< RAM pages in the ring, power of two. */
+#endif
+
+/**@brief Log counters. */
+typedef struct
+{
+    unsigned long pages_written;        /**< Pages programmed into flash. */
+    unsigned long errors;               /**< Pages lost to a failed erase, program or busy wait. */
+    unsigned long overflow_records;     /**< Records dropped because the ring was full. */
+    unsigned long overflow_bytes;       /**< Bytes of the dropped records. */
+    uint8_t       max_pending;          /**< Highest number of pages waiting for flush. */
+} sst_log_stats_t;
+
+extern sst_log_stats_t sst_log_stats;
+
+/**@brief Set up the log region and empty the ring.
+ *
+ * The log continues behind the pages written before a reset: at the first
+ * blank page that follows a written one, or at base if the region is blank
+ * or full.
+ *
+ * @param[in] base  First address of the log region, 4 KByte aligned.
+ * @param[in] size  Region size, a multiple of 4 KByte. The log wraps around.
+ */
+void SST_Log_Init(unsigned long base, unsigned long size);
+
+/**@brief Append a record. Safe to call from an interrupt, never blocks.
+ *
+ * @return true if stored, false if dropped because the ring is full.
+ */
+bool SST_Log_Append(const void * p_data, uint16_t len);
+
+/**@brief Program all completed pages. Call from main context.
+ *
+ * A page whose program fails, or that falls into a sector whose erase
+ * failed, is dropped and counted in sst_log_stats.errors.
+ */
+void SST_Log_Flush(void);
+
+/**@brief Close the partially filled page (padded with 0xFF) and flush it. */
+void SST_Log_Sync(void);
+
+/**@brief Flash address the next page will be programmed to. */
+unsigned long SST_Log_Position(void);
+
+#endif /* SST25VF064C_LOG_H__ */
@@ -0,0 +1,471 @@
+/**@file
+ * @brief Small-window LZ block compression for the SST25VF064C.
+ *
+ * See SST25VF064C_lz.h for the sector format.
+ */
+
+#include <string.h>
+#include "SST25VF064C.h"
+#include "SST25VF064C_lz.h"
+
+#define LZ_PAYLOAD      (SST_LZ_SECTOR_SIZE - SST_LZ_HEADER_SIZE)
+
+static uint8_t lz_hash(uint8_t b0, uint8_t b1, uint8_t b2)
+{
+    return (uint8_t)((b0 * 131u + b1 * 17u + b2) & (SST_LZ_HASH_SIZE - 1u));
+}
+
+static void lz_header_build(uint8_t * p_hdr, uint16_t comp_len, uint16_t raw_len, uint8_t flags)
+{
+    uint8_t i;
+    uint8_t sum = 0;
+
+    p_hdr[0] = (uint8_t)(SST_LZ_MAGIC & 0xFF);
+    p_hdr[1] = (uint8_t)(SST_LZ_MAGIC >> 8);
+    p_hdr[2] = (uint8_t)(comp_len & 0xFF);
+    p_hdr[3] = (uint8_t)(comp_len >> 8);
+    p_hdr[4] = (uint8_t)(raw_len & 0xFF);
+    p_hdr[5] = (uint8_t)(raw_len >> 8);
+    p_hdr[6] = flags;
+    for (i = 0; i < 7; i++)
+    {
+        sum += p_hdr[i];
+    }
+    p_hdr[7] = (uint8_t)(sum ^ 0xFF);
+}
+
+/* Keeps the first failed erase or program; the blob is abandoned after it. */
+static void lz_status(sst_lz_writer_t * p_writer, uint32_t err_code)
+{
+    if (p_writer->error == NRF_SUCCESS)
+    {
+        p_writer->error = err_code;
+    }
+}
+
+/* Programs the staged chunk; bytes past chunk_len stay erased. */
+static void lz_chunk_program(sst_lz_writer_t * p_writer, unsigned long Dst)
+{
+    if (p_writer->error == NRF_SUCCESS)
+    {
+        memcpy(upper_128, p_writer->chunk, p_writer->chunk_len);
+        memset(&upper_128[p_writer->chunk_len], 0xFF, SST_LZ_PROG_CHUNK - p_writer->chunk_len);
+        lz_status(p_writer, Page_Program_Operation(Dst));
+    }
+    p_writer->chunk_len = 0;
+}
+
+static void lz_put(sst_lz_writer_t * p_writer, uint8_t byte)
+{
+    p_writer->chunk[p_writer->chunk_len++] = byte;
+    p_writer->comp_len++;
+    if (p_writer->chunk_len == SST_LZ_PROG_CHUNK)
+    {
+        lz_chunk_program(p_writer, p_writer->sector + SST_LZ_HEADER_SIZE
+                                   + p_writer->comp_len - SST_LZ_PROG_CHUNK);
+    }
+}
+
+static void lz_group_flush(sst_lz_writer_t * p_writer)
+{
+    uint8_t i;
+
+    for (i = 0; i < p_writer->group_len; i++)
+    {
+        lz_put(p_writer, p_writer->group[i]);
+    }
+    p_writer->group_len   = 0;
+    p_writer->group_items = 0;
+}
+
+/* Switches the sector to raw storage after SST_LZ_PROBE bytes without a
+ * single match, or at its close if the tokens are not shorter than the
+ * bytes. Only while nothing has been programmed: the raw bytes are still in
+ * the history. */
+static void lz_probe(sst_lz_writer_t * p_writer)
+{
+    uint16_t tokens = (uint16_t)(p_writer->comp_len + p_writer->group_len);
+    uint8_t  start  = (uint8_t)(p_writer->pos - p_writer->raw_len);
+    bool     keep;
+    uint16_t i;
+
+    p_writer->probed = true;
+    if (p_writer->raw_len >= SST_LZ_PROBE)
+    {
+        keep = tokens < (p_writer->raw_len + (p_writer->raw_len + 7u) / 8u);   /* not literals only */
+    }
+    else
+    {
+        keep = tokens < p_writer->raw_len;
+    }
+    if (keep || ((SST_LZ_HEADER_SIZE + p_writer->comp_len) >= SST_LZ_PROG_CHUNK))
+    {
+        return;
+    }
+    p_writer->stored      = true;
+    p_writer->comp_len    = 0;
+    p_writer->group_len   = 0;
+    p_writer->group_items = 0;
+    p_writer->chunk_len   = SST_LZ_HEADER_SIZE;
+    for (i = 0; i < p_writer->raw_len; i++)
+    {
+        lz_put(p_writer, p_writer->ring[(uint8_t)(start + i)]);
+    }
+}
+
+static void lz_sector_open(sst_lz_writer_t * p_writer)
+{
+    if ((p_writer->sector + SST_LZ_SECTOR_SIZE) > p_writer->end)
+    {
+        p_writer->overflow = true;
+        return;
+    }
+    lz_status(p_writer, Sector_Erase_Operation(p_writer->sector));
+    p_writer->sectors++;
+    p_writer->comp_len    = 0;
+    p_writer->raw_len     = 0;
+    p_writer->hist        = 0;
+    p_writer->group_len   = 0;
+    p_writer->group_items = 0;
+    p_writer->probed      = false;
+    p_writer->stored      = false;
+
+    /* The header is programmed when the sector is closed. */
+    memset(p_writer->chunk, 0xFF, SST_LZ_HEADER_SIZE);
+    p_writer->chunk_len = SST_LZ_HEADER_SIZE;
+}
+
+static void lz_sector_close(sst_lz_writer_t * p_writer, uint8_t flags)
+{
+    uint8_t       hdr[SST_LZ_HEADER_SIZE];
+    unsigned long used;
+
+    if (!p_writer->probed)
+    {
+        lz_probe(p_writer);
+    }
+    lz_group_flush(p_writer);
+    if (p_writer->stored)
+    {
+        flags |= SST_LZ_FLAG_RAW;
+    }
+    lz_header_build(hdr, p_writer->comp_len, p_writer->raw_len, flags);
+    used = SST_LZ_HEADER_SIZE + p_writer->comp_len;
+
+    if (used <= SST_LZ_PROG_CHUNK)
+    {
+        /* First chunk still staged: header goes out with the data. */
+        memcpy(p_writer->chunk, hdr, SST_LZ_HEADER_SIZE);
+        lz_chunk_program(p_writer, p_writer->sector);
+    }
+    else
+    {
+        if (p_writer->chunk_len)
+        {
+            lz_chunk_program(p_writer, p_writer->sector + used - p_writer->chunk_len);
+        }
+        if (p_writer->error == NRF_SUCCESS)
+        {
+            /* Erased bytes program as no-ops, so only the header changes. */
+            memset(upper_128, 0xFF, SST_LZ_PROG_CHUNK);
+            memcpy(upper_128, hdr, SST_LZ_HEADER_SIZE);
+            lz_status(p_writer, Page_Program_Operation(p_writer->sector));
+        }
+    }
+    p_writer->raw_total  += p_writer->raw_len;
+    p_writer->comp_total += used;
+}
+
+/* Copies one byte into a stored sector. */
+static void lz_store_byte(sst_lz_writer_t * p_writer)
+{
+    if (p_writer->comp_len == LZ_PAYLOAD)
+    {
+        lz_sector_close(p_writer, 0);
+        p_writer->sector += SST_LZ_SECTOR_SIZE;
+        lz_sector_open(p_writer);
+        return;
+    }
+    lz_put(p_writer, p_writer->ring[p_writer->pos]);
+    p_writer->pos++;
+    p_writer->look--;
+    p_writer->raw_len++;
+}
+
+static void lz_encode_item(sst_lz_writer_t * p_writer)
+{
+    uint8_t p    = p_writer->pos;
+    uint8_t len  = 1;
+    uint8_t dist = 0;
+    uint8_t size;
+    uint8_t need;
+    uint8_t i;
+
+    if (p_writer->stored)
+    {
+        lz_store_byte(p_writer);
+        return;
+    }
+    if (p_writer->look >= SST_LZ_MIN_MATCH)
+    {
+        uint8_t cand = p_writer->head[lz_hash(p_writer->ring[p],
+                                              p_writer->ring[(uint8_t)(p + 1)],
+                                              p_writer->ring[(uint8_t)(p + 2)])];
+        uint8_t d    = (uint8_t)(p - cand);
+
+        if ((d != 0) && (d <= p_writer->hist) && (d <= SST_LZ_MAX_DIST))
+        {
+            uint8_t n = 0;
+            while ((n < p_writer->look)
+                   && (p_writer->ring[(uint8_t)(cand + n)] == p_writer->ring[(uint8_t)(p + n)]))
+            {
+                n++;
+            }
+            if (n >= SST_LZ_MIN_MATCH)
+            {
+                len  = n;
+                dist = d;
+            }
+        }
+    }
+
+    size = (dist != 0) ? 2 : 1;
+    need = (uint8_t)(size + ((p_writer->group_items == 0) ? 1 : 0));
+    if (((unsigned)(p_writer->comp_len + p_writer->group_len + need) > LZ_PAYLOAD)
+        || ((p_writer->raw_len + len) > SST_LZ_RAW_MAX))
+    {
+        /* Sector full: the item is encoded again against the new, empty window. */
+        lz_sector_close(p_writer, 0);
+        p_writer->sector += SST_LZ_SECTOR_SIZE;
+        lz_sector_open(p_writer);
+        return;
+    }
+
+    if (p_writer->group_items == 0)
+    {
+        p_writer->group[0]  = 0;
+        p_writer->group_len = 1;
+    }
+    if (dist != 0)
+    {
+        p_writer->group[0] |= (uint8_t)(1u << p_writer->group_items);
+        p_writer->group[p_writer->group_len++] = dist;
+        p_writer->group[p_writer->group_len++] = (uint8_t)(len - SST_LZ_MIN_MATCH);
+    }
+    else
+    {
+        p_writer->group[p_writer->group_len++] = p_writer->ring[p];
+    }
+    if (++p_writer->group_items == 8)
+    {
+        lz_group_flush(p_writer);
+    }
+
+    for (i = 0; i < len; i++)
+    {
+        if (p_writer->look >= SST_LZ_MIN_MATCH)
+        {
+            p_writer->head[lz_hash(p_writer->ring[p_writer->pos],
+                                   p_writer->ring[(uint8_t)(p_writer->pos + 1)],
+                                   p_writer->ring[(uint8_t)(p_writer->pos + 2)])] = p_writer->pos;
+        }
+        p_writer->pos++;
+        p_writer->look--;
+        if (p_writer->hist < 0xFF)
+        {
+            p_writer->hist++;
+        }
+    }
+    p_writer->raw_len += len;
+    if (!p_writer->probed && (p_writer->raw_len >= SST_LZ_PROBE))
+    {
+        lz_probe(p_writer);
+    }
+}
+
+uint32_t SST_LZ_Write_Begin(sst_lz_writer_t * p_writer, unsigned long Dst, unsigned long max_bytes)
+{
+    memset(p_writer, 0, sizeof(*p_writer));
+    p_writer->sector = Dst;
+    p_writer->end    = Dst + max_bytes;
+    lz_sector_open(p_writer);
+    return p_writer->error;
+}
+
+uint32_t SST_LZ_Write(sst_lz_writer_t * p_writer, const uint8_t * p_data, unsigned long no_bytes)
+{
+    unsigned long i;
+
+    for (i = 0; i < no_bytes; i++)
+    {
+        while (p_writer->look == SST_LZ_MAX_MATCH)
+        {
+            if (p_writer->overflow || (p_writer->error != NRF_SUCCESS))
+            {
+                return p_writer->error;
+            }
+            lz_encode_item(p_writer);
+        }
+        p_writer->ring[(uint8_t)(p_writer->pos + p_writer->look)] = p_data[i];
+        p_writer->look++;
+    }
+    return p_writer->error;
+}
+
+unsigned long SST_LZ_Write_End(sst_lz_writer_t * p_writer)
+{
+    while (p_writer->look && !p_writer->overflow && (p_writer->error == NRF_SUCCESS))
+    {
+        lz_encode_item(p_writer);
+    }
+    if (p_writer->overflow || (p_writer->error != NRF_SUCCESS))
+    {
+        return 0;
+    }
+    lz_sector_close(p_writer, SST_LZ_FLAG_LAST);
+    return (p_writer->error == NRF_SUCCESS) ? p_writer->sectors : 0;
+}
+
+long SST_LZ_Read_Open(sst_lz_reader_t * p_reader, unsigned long Dst)
+{
+    uint8_t  hdr[SST_LZ_HEADER_SIZE];
+    uint8_t  sum = 0;
+    uint8_t  i;
+    uint16_t comp_len;
+
+    HighSpeed_Read_Cont(Dst, SST_LZ_HEADER_SIZE);
+    memcpy(hdr, upper_128, SST_LZ_HEADER_SIZE);
+    for (i = 0; i < 7; i++)
+    {
+        sum += hdr[i];
+    }
+    sum ^= 0xFF;
+    comp_len = (uint16_t)(hdr[2] | (hdr[3] << 8));
+    if ((hdr[0] != (SST_LZ_MAGIC & 0xFF)) || (hdr[1] != (SST_LZ_MAGIC >> 8))
+        || (hdr[7] != sum) || (comp_len > LZ_PAYLOAD)
+        || ((hdr[6] & SST_LZ_FLAG_RAW) && (comp_len != (uint16_t)(hdr[4] | (hdr[5] << 8)))))
+    {
+        p_reader->raw_left = 0;
+        p_reader->flags    = SST_LZ_FLAG_LAST;
+        return -1;
+    }
+
+    p_reader->sector     = Dst;
+    p_reader->in_addr    = Dst + SST_LZ_HEADER_SIZE;
+    p_reader->comp_left  = comp_len;
+    p_reader->raw_left   = (uint16_t)(hdr[4] | (hdr[5] << 8));
+    p_reader->flags      = hdr[6];
+    p_reader->ctrl_bits  = 0;
+    p_reader->match_left = 0;
+    p_reader->in_pos     = 0;
+    p_reader->in_len     = 0;
+    return p_reader->raw_left;
+}
+
+/* Returns the next compressed byte, or -1 when the sector data is exhausted. */
+static int lz_next_in(sst_lz_reader_t * p_reader)
+{
+    if (p_reader->in_pos == p_reader->in_len)
+    {
+        uint8_t n = (p_reader->comp_left > SST_LZ_PROG_CHUNK) ? SST_LZ_PROG_CHUNK
+                                                              : (uint8_t)p_reader->comp_left;
+        if (n == 0)
+        {
+            return -1;
+        }
+        HighSpeed_Read_Cont(p_reader->in_addr, n);
+        memcpy(p_reader->in, upper_128, n);
+        p_reader->in_addr   += n;
+        p_reader->comp_left -= n;
+        p_reader->in_len     = n;
+        p_reader->in_pos     = 0;
+    }
+    return p_reader->in[p_reader->in_pos++];
+}
+
+unsigned long SST_LZ_Read(sst_lz_reader_t * p_reader, uint8_t * p_data, unsigned long no_bytes)
+{
+    unsigned long produced = 0;
+
+    while (produced < no_bytes)
+    {
+        uint8_t byte;
+
+        if (p_reader->raw_left == 0)
+        {
+            if ((p_reader->flags & SST_LZ_FLAG_LAST)
+                || (SST_LZ_Read_Open(p_reader, p_reader->sector + SST_LZ_SECTOR_SIZE) < 0))
+            {
+                break;
+            }
+            continue;
+        }
+
+        if (p_reader->flags & SST_LZ_FLAG_RAW)
+        {
+            unsigned long n = no_bytes - produced;
+
+            if (n > p_reader->raw_left)
+            {
+                n = p_reader->raw_left;
+            }
+            HighSpeed_Read_Data(p_reader->in_addr, &p_data[produced], n);
+            p_reader->in_addr   += n;
+            p_reader->comp_left -= (uint16_t)n;
+            p_reader->raw_left  -= (uint16_t)n;
+            produced            += n;
+            continue;
+        }
+
+        if (p_reader->match_left)
+        {
+            byte = p_reader->ring[(uint8_t)(p_reader->pos - p_reader->match_dist)];
+            p_reader->match_left--;
+        }
+        else
+        {
+            int in;
+
+            if (p_reader->ctrl_bits == 0)
+            {
+                in = lz_next_in(p_reader);
+                if (in < 0)
+                {
+                    p_reader->raw_left = 0;     /* truncated sector */
+                    continue;
+                }
+                p_reader->ctrl      = (uint8_t)in;
+                p_reader->ctrl_bits = 8;
+            }
+            p_reader->ctrl_bits--;
+            if (p_reader->ctrl & 0x01)
+            {
+                int dist = lz_next_in(p_reader);
+                int len  = lz_next_in(p_reader);
+
+                p_reader->ctrl >>= 1;
+                if ((dist <= 0) || (len < 0))
+                {
+                    p_reader->raw_left = 0;
+                    continue;
+                }
+                p_reader->match_dist = (uint8_t)dist;
+                p_reader->match_left = (uint8_t)(len + SST_LZ_MIN_MATCH);
+                continue;
+            }
+            p_reader->ctrl >>= 1;
+            in = lz_next_in(p_reader);
+            if (in < 0)
+            {
+                p_reader->raw_left = 0;
+                continue;
+            }
+            byte = (uint8_t)in;
+        }
+
+        p_reader->ring[p_reader->pos++] = byte;
+        p_data[produced++] = byte;
+        p_reader->raw_left--;
+    }
+    return produced;
+}
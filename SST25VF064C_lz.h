@@ -0,0 +1,132 @@
+/**@file
+ * @brief Small-window LZ block compression for the SST25VF064C.
+ *
+ * Blobs are compressed into 4 KByte sectors. Every sector starts with an
+ * 8 byte header (magic, compressed length, raw length, flags, checksum) and
+ * its token stream only references data of the same sector, so any sector
+ * can be decompressed on its own. Sectors are erased as they are opened, so
+ * erase and program time scale with the compressed size, not the raw size.
+ *
+ * Token stream: one control byte followed by up to 8 items. A control bit of
+ * 0 is a literal byte, a 1 is a match of two bytes (distance, length - 3).
+ *
+ * A sector is stored raw instead (SST_LZ_FLAG_RAW) when its first
+ * SST_LZ_PROBE bytes contain no match, or when a shorter sector is not made
+ * smaller by the tokens: the payload is then the raw bytes and the reader
+ * copies it straight through. The choice is made before anything of the
+ * sector has been programmed, as tokens cannot be taken back without a
+ * second erase, so incompressible data costs its own size plus the header.
+ * A sector whose data turns incompressible after the probe stays compressed.
+ *
+ * The writer needs about 530 bytes of RAM and the reader about 400 bytes.
+ * While a writer or reader is active the driver's upper_128 buffer is used
+ * as transfer buffer.
+ */
+
+#ifndef SST25VF064C_LZ_H__
+#define SST25VF064C_LZ_H__
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "SST25VF064C_device.h"
+
+#define SST_LZ_SECTOR_SIZE      SST25_SECTOR_SIZE   /**< Erase unit, every sector is self-contained. */
+#define SST_LZ_HEADER_SIZE      8u      /**< Size of the sector header. */
+#define SST_LZ_PROG_CHUNK       SST25_PROG_CHUNK    /**< Bytes per Page_Program_Operation call. */
+#define SST_LZ_WINDOW           256u    /**< History/lookahead ring size, must be 256. */
+#define SST_LZ_MIN_MATCH        3u      /**< Shortest match worth encoding. */
+#define SST_LZ_MAX_MATCH        34u     /**< Longest match (bounded by the lookahead). */
+#define SST_LZ_MAX_DIST         (SST_LZ_WINDOW - SST_LZ_MAX_MATCH - 1u)
+#define SST_LZ_HASH_SIZE        128u    /**< Hash head table entries, power of two. */
+#define SST_LZ_RAW_MAX          32768u  /**< Raw bytes per sector cap (fits the header). */
+
+#define SST_LZ_MAGIC            0x5A4Cu /**< "LZ" */
+#define SST_LZ_FLAG_LAST        0x01u   /**< Sector is the last one of a blob. */
+#define SST_LZ_FLAG_RAW         0x02u   /**< Payload is stored uncompressed, comp_len == raw_len. */
+#define SST_LZ_PROBE            96u     /**< Raw bytes looked at before storing a sector raw;
+                                             their tokens still fit the first SST_LZ_PROG_CHUNK. */
+
+/**@brief Compressing writer state. */
+typedef struct
+{
+    unsigned long sector;                       /**< Address of the sector being filled. */
+    unsigned long end;                          /**< First address past the writable region. */
+    uint16_t      comp_len;                     /**< Token bytes emitted into the current sector. */
+    uint16_t      raw_len;                      /**< Raw bytes encoded into the current sector. */
+    uint8_t       ring[SST_LZ_WINDOW];          /**< History followed by lookahead. */
+    uint8_t       head[SST_LZ_HASH_SIZE];       /**< Last ring position per 3-byte hash. */
+    uint8_t       pos;                          /**< Ring position of the next byte to encode. */
+    uint8_t       look;                         /**< Bytes buffered ahead of pos. */
+    uint8_t       hist;                         /**< Usable history (reset per sector). */
+    uint8_t       group[17];                    /**< Control byte plus up to 8 items. */
+    uint8_t       group_len;
+    uint8_t       group_items;
+    uint8_t       chunk[SST_LZ_PROG_CHUNK];     /**< Compressed bytes waiting to be programmed. */
+    uint8_t       chunk_len;
+    bool          overflow;                     /**< Region exhausted, data was dropped. */
+    uint32_t      error;                        /**< First failed erase or program, data was dropped. */
+    bool          probed;                       /**< Raw or compressed decided for the current sector. */
+    bool          stored;                       /**< Current sector is stored raw. */
+    unsigned long sectors;                      /**< Sectors used so far. */
+    unsigned long raw_total;
+    unsigned long comp_total;
+} sst_lz_writer_t;
+
+/**@brief Decompressing reader state. */
+typedef struct
+{
+    unsigned long sector;                       /**< Address of the sector being decoded. */
+    unsigned long in_addr;                      /**< Next compressed byte to fetch. */
+    uint16_t      comp_left;                    /**< Compressed bytes not yet consumed. */
+    uint16_t      raw_left;                     /**< Raw bytes not yet produced. */
+    uint8_t       flags;                        /**< Header flags of the current sector. */
+    uint8_t       ring[SST_LZ_WINDOW];          /**< Output history for match copies. */
+    uint8_t       pos;
+    uint8_t       ctrl;                         /**< Current control byte. */
+    uint8_t       ctrl_bits;                    /**< Items left in the current group. */
+    uint8_t       match_dist;                   /**< Pending match copy. */
+    uint8_t       match_left;
+    uint8_t       in[SST_LZ_PROG_CHUNK];        /**< Compressed input staging. */
+    uint8_t       in_pos;
+    uint8_t       in_len;
+} sst_lz_reader_t;
+
+/**@brief Start a compressed blob at a sector aligned address.
+ *
+ * @param[out] p_writer  Writer state.
+ * @param[in]  Dst       First sector of the blob (4 KByte aligned).
+ * @param[in]  max_bytes Size of the region the blob may occupy.
+ *
+ * @return NRF_SUCCESS, or the status of the failed erase of the first sector.
+ */
+uint32_t SST_LZ_Write_Begin(sst_lz_writer_t * p_writer, unsigned long Dst, unsigned long max_bytes);
+
+/**@brief Compress and store the next part of the blob.
+ *
+ * @return NRF_SUCCESS, or the first failed erase or program status. Nothing
+ *         more is written to flash once an operation has failed.
+ */
+uint32_t SST_LZ_Write(sst_lz_writer_t * p_writer, const uint8_t * p_data, unsigned long no_bytes);
+
+/**@brief Flush the blob and mark its last sector.
+ *
+ * @return Number of sectors used, or 0 if the region overflowed or an erase
+ *         or program failed (see error).
+ */
+unsigned long SST_LZ_Write_End(sst_lz_writer_t * p_writer);
+
+/**@brief Open the compressed sector at Dst for reading.
+ *
+ * Decoding continues into following sectors until the last sector of the blob.
+ *
+ * @return Raw length stored in this sector, or -1 if the header is invalid.
+ */
+long SST_LZ_Read_Open(sst_lz_reader_t * p_reader, unsigned long Dst);
+
+/**@brief Decompress up to no_bytes into p_data.
+ *
+ * @return Number of bytes produced, 0 at the end of the blob.
+ */
+unsigned long SST_LZ_Read(sst_lz_reader_t * p_reader, uint8_t * p_data, unsigned long no_bytes);
+
+#endif /* SST25VF064C_LZ_H__ */
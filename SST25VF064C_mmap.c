@@ -0,0 +1,403 @@
+/**@file
+ * @brief Image file transport (SST25_TRANSPORT_MMAP), see SST25VF064C_transport.h.
+ *
+ * The commands are decoded as the bytes arrive: the command byte and its
+ * address bytes are collected, the data phase of reads and programs then
+ * works on the mapping in one memcpy or AND loop. Erases, write enable and
+ * the status register write take effect when the chip select is released,
+ * as on the device.
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <fcntl.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "SST25VF064C_transport.h"
+
+#define SR_WEL          0x02u
+#define SR_WRITABLE     0xBCu   /* BP0..BP3, BPL */
+#define HEADER_MAX      5u
+
+static int      m_fd = -1;
+static uint8_t *m_image;        /* SST25_CAPACITY bytes */
+static uint8_t  m_status;       /* BUSY never set */
+static bool     m_ewsr;         /* EWSR or WREN ahead of WRSR */
+static bool     m_reset_enable; /* 66h ahead of 99h */
+static bool     m_ehld;         /* RST#/HOLD# is HOLD# */
+static uint8_t  m_sid[32];
+static bool     m_sid_locked;
+
+static bool     m_selected;
+static uint8_t  m_cmd[HEADER_MAX];
+static uint8_t  m_cmd_len;      /* command and address bytes, 0 before the command byte */
+static unsigned long m_data;    /* data phase bytes so far */
+
+static uint8_t header_len(uint8_t op)
+{
+    switch (op)
+    {
+        case 0x02:              /* Page-Program */
+        case 0x03:              /* Read */
+        case 0x20:              /* Sector-Erase */
+        case 0x52:              /* Block-Erase 32K */
+        case 0xD8:              /* Block-Erase */
+        case 0x90:              /* Read-ID */
+        case 0xAB:
+            return 4;
+        case 0x0B:              /* High-Speed-Read, one dummy byte */
+            return 5;
+        case 0x88:              /* Read SID, address and dummy byte */
+            return 3;
+        case 0x01:              /* WRSR */
+        case 0xA5:              /* Program SID */
+            return 2;
+        default:
+            return 1;
+    }
+}
+
+static unsigned long cmd_addr(void)
+{
+    return (((unsigned long)m_cmd[1] << 16) | ((unsigned long)m_cmd[2] << 8) | m_cmd[3]) & SST25_ADDR_MASK;
+}
+
+static void reset(void)
+{
+    m_status       &= (uint8_t)~SR_WEL;
+    m_ewsr          = false;
+    m_reset_enable  = false;
+    m_selected      = false;
+    m_cmd_len       = 0;
+}
+
+/* Size of the D8h block at addr; SST26 parts have 8 and 32 KByte blocks at both ends. */
+static unsigned long block_size(unsigned long addr)
+{
+#if SST25_BLOCK_64K_SIZE
+    (void)addr;
+    return SST25_BLOCK_64K_SIZE;
+#else
+    if ((addr < 0x8000ul) || (addr >= SST25_CAPACITY - 0x8000ul))
+    {
+        return 0x2000ul;
+    }
+    if ((addr < 0x10000ul) || (addr >= SST25_CAPACITY - 0x10000ul))
+    {
+        return 0x8000ul;
+    }
+    return 0x10000ul;
+#endif
+}
+
+static void erase(unsigned long addr, unsigned long size)
+{
+    if ((size != 0) && (m_status & SR_WEL))
+    {
+        memset(&m_image[addr & ~(size - 1)], 0xFF, size);
+    }
+}
+
+/* Data phase of n bytes; p_tx or p_rx NULL past the caller's lengths. */
+static void data_phase(uint8_t const * p_tx, uint8_t * p_rx, unsigned long n)
+{
+    unsigned long addr = cmd_addr();
+    unsigned long i;
+
+    switch (m_cmd[0])
+    {
+        case 0x03:
+        case 0x0B:
+            if (p_rx != NULL)
+            {
+                unsigned long pos   = (addr + m_data) & SST25_ADDR_MASK;
+                unsigned long first = ((SST25_CAPACITY - pos) < n) ? (SST25_CAPACITY - pos) : n;
+
+                memcpy(p_rx, &m_image[pos], first);
+                memcpy(p_rx + first, m_image, n - first);
+            }
+            return;
+
+        case 0x02:
+            if ((p_tx != NULL) && (m_status & SR_WEL))
+            {
+                unsigned long page = addr & ~(unsigned long)(SST25_PAGE_SIZE - 1);
+
+                for (i = 0; i < n; i++)
+                {
+                    m_image[page + ((addr + m_data + i) & (SST25_PAGE_SIZE - 1))] &= p_tx[i];
+                }
+            }
+            break;
+
+        case 0xA5:
+            if ((p_tx != NULL) && (m_status & SR_WEL) && !m_sid_locked)
+            {
+                for (i = 0; i < n; i++)
+                {
+                    unsigned long pos = m_cmd[1] + m_data + i;
+
+                    if ((pos >= SST25_SID_USER_OFFSET) && (pos < SST25_SID_SIZE))
+                    {
+                        m_sid[pos] &= p_tx[i];
+                    }
+                }
+            }
+            break;
+
+        default:
+            break;
+    }
+
+    if (p_rx == NULL)
+    {
+        return;
+    }
+    for (i = 0; i < n; i++)
+    {
+        unsigned long k = m_data + i;
+
+        switch (m_cmd[0])
+        {
+            case 0x05:
+                p_rx[i] = m_status;
+                break;
+            case 0x9F:
+                p_rx[i] = (uint8_t)(SST25_JEDEC_ID >> (16 - 8 * (k % 3)));
+                break;
+            case 0x90:
+            case 0xAB:
+                p_rx[i] = ((m_cmd[3] + k) & 1) ? (uint8_t)SST25_JEDEC_ID : (uint8_t)(SST25_JEDEC_ID >> 16);
+                break;
+            case 0x88:
+                p_rx[i] = m_sid[(m_cmd[1] + k) % sizeof(m_sid)];
+                break;
+            default:
+                p_rx[i] = 0xFF;
+                break;
+        }
+    }
+}
+
+/* Commands that act when CE# goes high. */
+static void command_end(void)
+{
+    bool done = true;           /* a write command: WEL is cleared */
+
+    if ((m_cmd_len == 0) || (m_cmd_len != header_len(m_cmd[0])))
+    {
+        return;
+    }
+    switch (m_cmd[0])
+    {
+        case 0x06:
+            m_status |= SR_WEL;
+            m_ewsr    = true;
+            done      = false;
+            break;
+        case 0x04:
+            break;
+        case 0x50:
+            m_ewsr = true;
+            done   = false;
+            break;
+        case 0x01:
+            if (m_ewsr)
+            {
+                m_status = (uint8_t)((m_status & ~SR_WRITABLE) | (m_cmd[1] & SR_WRITABLE));
+            }
+            m_ewsr = false;
+            break;
+        case 0x02:
+        case 0xA5:
+            break;
+        case 0x20:
+            erase(cmd_addr(), SST25_SECTOR_SIZE);
+            break;
+        case 0x52:
+            erase(cmd_addr(), SST25_BLOCK_32K_SIZE);
+            break;
+        case 0xD8:
+            erase(cmd_addr(), block_size(cmd_addr()));
+            break;
+        case 0x60:
+        case 0xC7:
+            erase(0, SST25_CAPACITY);
+            break;
+        case 0x85:
+            m_sid_locked |= ((m_status & SR_WEL) != 0);
+            break;
+        case 0xAA:
+            m_ehld = true;
+            done   = false;
+            break;
+        case 0x66:
+            m_reset_enable = true;
+            return;
+        case 0x99:
+            if (m_reset_enable)
+            {
+                reset();
+            }
+            done = false;
+            break;
+        default:
+            done = false;
+            break;
+    }
+    m_reset_enable = false;
+    if (done)
+    {
+        m_status &= (uint8_t)~SR_WEL;
+    }
+}
+
+uint32_t SST25_Transport_Open(const char * p_path)
+{
+    struct stat st;
+    off_t       old_size;
+
+    SST25_Transport_Close();
+    m_fd = open(p_path, O_RDWR | O_CREAT, 0644);
+    if (m_fd < 0)
+    {
+        return NRF_ERROR_NOT_FOUND;
+    }
+    if (fstat(m_fd, &st) != 0)
+    {
+        SST25_Transport_Close();
+        return NRF_ERROR_INTERNAL;
+    }
+    old_size = (st.st_size < (off_t)SST25_CAPACITY) ? st.st_size : (off_t)SST25_CAPACITY;
+    if ((old_size < (off_t)SST25_CAPACITY) && (ftruncate(m_fd, SST25_CAPACITY) != 0))
+    {
+        SST25_Transport_Close();
+        return NRF_ERROR_INTERNAL;
+    }
+    m_image = mmap(NULL, SST25_CAPACITY, PROT_READ | PROT_WRITE, MAP_SHARED, m_fd, 0);
+    if (m_image == MAP_FAILED)
+    {
+        m_image = NULL;
+        SST25_Transport_Close();
+        return NRF_ERROR_INTERNAL;
+    }
+    memset(&m_image[old_size], 0xFF, SST25_CAPACITY - (unsigned long)old_size);
+
+    memset(m_sid, 0xFF, sizeof(m_sid));
+    m_sid_locked = false;
+    m_ehld       = false;
+    m_status     = 0;
+    reset();
+    return NRF_SUCCESS;
+}
+
+void SST25_Transport_Close(void)
+{
+    if (m_image != NULL)
+    {
+        (void)msync(m_image, SST25_CAPACITY, MS_SYNC);
+        (void)munmap(m_image, SST25_CAPACITY);
+        m_image = NULL;
+    }
+    if (m_fd >= 0)
+    {
+        (void)close(m_fd);
+        m_fd = -1;
+    }
+}
+
+void sst25_transport_clock(unsigned long hz)
+{
+    (void)hz;
+}
+
+uint32_t sst25_transport_xfer(uint8_t const * p_tx_data, uint16_t tx_len, uint8_t * p_rx_data, uint16_t rx_len)
+{
+    uint16_t len = (tx_len > rx_len) ? tx_len : rx_len;
+    uint16_t i   = 0;
+
+    if (m_image == NULL)
+    {
+        return NRF_ERROR_INTERNAL;
+    }
+    if (!m_selected)
+    {
+        uint32_t err_code;
+
+        (void)sst25_transport_select(true);
+        err_code = sst25_transport_xfer(p_tx_data, tx_len, p_rx_data, rx_len);
+        (void)sst25_transport_select(false);
+        return err_code;
+    }
+
+    // Command and address bytes; SO is not driven yet.
+    while ((i < len) && ((m_cmd_len == 0) || (m_cmd_len < header_len(m_cmd[0]))))
+    {
+        m_cmd[m_cmd_len++] = (i < tx_len) ? p_tx_data[i] : 0xFF;
+        if (i < rx_len)
+        {
+            p_rx_data[i] = 0xFF;
+        }
+        i++;
+    }
+
+    // Data phase: the part with bytes to send and to keep, then the rest of either.
+    while (i < len)
+    {
+        uint16_t        end  = len;
+        uint8_t const * p_tx = NULL;
+        uint8_t *       p_rx = NULL;
+
+        if ((i < tx_len) && (tx_len < end))
+        {
+            end = tx_len;
+        }
+        if ((i < rx_len) && (rx_len < end))
+        {
+            end = rx_len;
+        }
+        if (i < tx_len)
+        {
+            p_tx = &p_tx_data[i];
+        }
+        if (i < rx_len)
+        {
+            p_rx = &p_rx_data[i];
+        }
+        data_phase(p_tx, p_rx, end - i);
+        m_data += end - i;
+        i       = end;
+    }
+    return NRF_SUCCESS;
+}
+
+uint32_t sst25_transport_select(bool active)
+{
+    if (active)
+    {
+        m_selected = true;
+        m_cmd_len  = 0;
+        m_data     = 0;
+    }
+    else if (m_selected)
+    {
+        m_selected = false;
+        command_end();
+    }
+    return NRF_SUCCESS;
+}
+
+void sst25_transport_pin(uint8_t pin, bool high)
+{
+    if ((pin == SST25_TRANSPORT_PIN_RESET_HOLD) && !high && !m_ehld)
+    {
+        reset();
+    }
+}
+
+void sst25_transport_delay_us(unsigned long us)
+{
+    (void)us;
+}
@@ -0,0 +1,136 @@
+/**@file
+ * @brief Streaming firmware image staging in the SST25VF064C.
+ */
+
+#include <string.h>
+#include "SST25VF064C_ota.h"
+#include "SST25VF064C_crc32.h"
+
+
+/* Waits for the page program started last. */
+static uint32_t ota_wait(sst_ota_t * p_ota)
+{
+    if (!p_ota->busy)
+    {
+        return NRF_SUCCESS;
+    }
+    p_ota->busy = false;
+    return Wait_Busy_Timeout(SST25_TIMEOUT_US(SST25_T_PP_MAX_US));
+}
+
+/* Starts programming the buffered page and hashes it while tPP elapses. */
+static uint32_t ota_page_flush(sst_ota_t * p_ota)
+{
+    unsigned long Dst = p_ota->base + p_ota->offset - p_ota->page_len;
+    uint32_t      err_code;
+
+    err_code = ota_wait(p_ota);
+    if ((err_code == NRF_SUCCESS) && ((Dst % SST25_SECTOR_SIZE) == 0))
+    {
+        err_code = Sector_Erase_Operation(Dst);
+    }
+    if (err_code != NRF_SUCCESS)
+    {
+        return err_code;
+    }
+
+    (void)SST25_Last_Error();
+    WREN();
+    Page_Program_Data(Dst, p_ota->page, p_ota->page_len);
+    err_code = SST25_Last_Error();
+    if (err_code != NRF_SUCCESS)
+    {
+        return err_code;
+    }
+    p_ota->busy = true;
+
+    p_ota->crc      = SST_CRC32_Compute(p_ota->page, p_ota->page_len, &p_ota->crc);
+    p_ota->page_len = 0;
+    return NRF_SUCCESS;
+}
+
+uint32_t SST_OTA_Begin(sst_ota_t * p_ota, unsigned long base, unsigned long size, unsigned long image_len)
+{
+    memset(p_ota, 0, sizeof(*p_ota));
+    if (((base % SST25_SECTOR_SIZE) != 0) || !SST25_RANGE_VALID(base, size))
+    {
+        return NRF_ERROR_INVALID_PARAM;
+    }
+    if (image_len > size)
+    {
+        return NRF_ERROR_NO_MEM;
+    }
+    p_ota->base      = base;
+    p_ota->size      = size;
+    p_ota->image_len = image_len;
+    p_ota->active    = true;
+    return NRF_SUCCESS;
+}
+
+uint32_t SST_OTA_Write(sst_ota_t * p_ota, const uint8_t * p_data, unsigned long no_bytes)
+{
+    if (!p_ota->active)
+    {
+        return NRF_ERROR_INVALID_STATE;
+    }
+    if (p_ota->error != NRF_SUCCESS)
+    {
+        return p_ota->error;
+    }
+    if ((p_ota->offset + no_bytes) > p_ota->image_len)
+    {
+        return NRF_ERROR_DATA_SIZE;
+    }
+
+    while (no_bytes)
+    {
+        unsigned long n = SST25_PAGE_SIZE - p_ota->page_len;
+
+        if (n > no_bytes)
+        {
+            n = no_bytes;
+        }
+        memcpy(&p_ota->page[p_ota->page_len], p_data, n);
+        p_ota->page_len += (uint16_t)n;
+        p_ota->offset   += n;
+        p_data          += n;
+        no_bytes        -= n;
+
+        if (p_ota->page_len == SST25_PAGE_SIZE)
+        {
+            p_ota->error = ota_page_flush(p_ota);
+            if (p_ota->error != NRF_SUCCESS)
+            {
+                return p_ota->error;
+            }
+        }
+    }
+    return NRF_SUCCESS;
+}
+
+uint32_t SST_OTA_End(sst_ota_t * p_ota, uint32_t expected_crc)
+{
+    if (!p_ota->active)
+    {
+        return NRF_ERROR_INVALID_STATE;
+    }
+    if ((p_ota->error == NRF_SUCCESS) && p_ota->page_len)
+    {
+        p_ota->error = ota_page_flush(p_ota);
+    }
+    if (p_ota->error == NRF_SUCCESS)
+    {
+        p_ota->error = ota_wait(p_ota);
+    }
+    p_ota->active = false;
+
+    if (p_ota->error != NRF_SUCCESS)
+    {
+        return p_ota->error;
+    }
+    if (p_ota->offset != p_ota->image_len)
+    {
+        return NRF_ERROR_INVALID_LENGTH;
+    }
+    return (p_ota->crc == expected_crc) ? NRF_SUCCESS : NRF_ERROR_INVALID_DATA;
+}
@@ -0,0 +1,64 @@
+/**@file
+ * @brief Streaming firmware image staging in the SST25VF064C.
+ *
+ * Image chunks of any size (as they arrive over BLE) are collected into full
+ * 256 byte pages. Each page is handed to the device with Page_Program_Data()
+ * and hashed with CRC-32 while the device is busy programming it, so the
+ * image is verified as soon as the last page lands, without reading it back.
+ * Sectors of the staging region are erased when the first page of each one
+ * is reached. The first erase, program or busy wait that fails ends the
+ * staging: its status is returned by that and every later call.
+ */
+
+#ifndef SST25VF064C_OTA_H__
+#define SST25VF064C_OTA_H__
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "SST25VF064C.h"
+
+/**@brief Image staging state. */
+typedef struct
+{
+    unsigned long base;                     /**< Staging region start, 4 KByte aligned. */
+    unsigned long size;                     /**< Staging region size. */
+    unsigned long image_len;                /**< Announced image length. */
+    unsigned long offset;                   /**< Bytes accepted so far. */
+    uint32_t      crc;                      /**< CRC-32 of the programmed pages. */
+    bool          busy;                     /**< A page program has not been waited for yet. */
+    bool          active;
+    uint32_t      error;                    /**< First failed erase, program or busy wait. */
+    uint16_t      page_len;                 /**< Bytes buffered for the next page. */
+    uint8_t       page[SST25_PAGE_SIZE];
+} sst_ota_t;
+
+/**@brief Start staging an image.
+ *
+ * @retval NRF_SUCCESS              Staging started.
+ * @retval NRF_ERROR_INVALID_PARAM  Region not sector aligned or exceeds the device.
+ * @retval NRF_ERROR_NO_MEM         Image does not fit the region.
+ */
+uint32_t SST_OTA_Begin(sst_ota_t * p_ota, unsigned long base, unsigned long size, unsigned long image_len);
+
+/**@brief Accept the next image chunk.
+ *
+ * @retval NRF_SUCCESS              Chunk buffered or programmed.
+ * @retval NRF_ERROR_INVALID_STATE  No staging in progress.
+ * @retval NRF_ERROR_DATA_SIZE      Chunk exceeds the announced image length.
+ * @return Status of a failed erase, program or busy wait otherwise.
+ */
+uint32_t SST_OTA_Write(sst_ota_t * p_ota, const uint8_t * p_data, unsigned long no_bytes);
+
+/**@brief Program the last partial page and check the image.
+ *
+ * @param[in] expected_crc  CRC-32 of the whole image as announced by the peer.
+ *
+ * @retval NRF_SUCCESS               Image complete and CRC matches.
+ * @retval NRF_ERROR_INVALID_STATE   No staging in progress.
+ * @retval NRF_ERROR_INVALID_LENGTH  Fewer bytes received than announced.
+ * @retval NRF_ERROR_INVALID_DATA    CRC mismatch.
+ * @return Status of a failed erase, program or busy wait otherwise.
+ */
+uint32_t SST_OTA_End(sst_ota_t * p_ota, uint32_t expected_crc);
+
+#endif /* SST25VF064C_OTA_H__ */
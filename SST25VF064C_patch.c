@@ -0,0 +1,305 @@
+/**@file
+ * @brief Delta update applier, see SST25VF064C_patch.h.
+ */
+
+#include <stddef.h>
+#include <string.h>
+#include "SST25VF064C_patch.h"
+#include "SST25VF064C_crc32.h"
+
+#define STATE_IDLE      0u
+#define STATE_HEADER    1u
+#define STATE_RECORD    2u
+#define STATE_PAGE      3u
+#define STATE_DONE      4u
+#define STATE_FAILED    5u
+
+static sst_patch_t m_patch;         /* SST_Patch_Apply */
+static uint8_t     m_chunk[SST_PATCH_CHUNK];
+
+static uint32_t header_check(sst_patch_hdr_t const * p_hdr)
+{
+    if ((p_hdr->magic != SST_PATCH_MAGIC) ||
+        (p_hdr->header_crc != SST_CRC32_Compute((uint8_t const *)p_hdr, offsetof(sst_patch_hdr_t, header_crc), NULL)))
+    {
+        return NRF_ERROR_INVALID_DATA;
+    }
+    if (((p_hdr->base % SST25_SECTOR_SIZE) != 0) || ((p_hdr->size % SST25_SECTOR_SIZE) != 0) ||
+        !SST25_RANGE_VALID(p_hdr->base, p_hdr->size))
+    {
+        return NRF_ERROR_INVALID_ADDR;
+    }
+    return NRF_SUCCESS;
+}
+
+static void record_next(sst_patch_t * p_patch)
+{
+    p_patch->state = (p_patch->records == p_patch->hdr.records) ? STATE_DONE : STATE_RECORD;
+}
+
+static uint32_t erase_run(sst_patch_t * p_patch, unsigned long Dst, unsigned long end)
+{
+    uint32_t err_code;
+
+    while (Dst < end)
+    {
+        unsigned long n = SST25_SECTOR_SIZE;
+
+#if SST25_BLOCK_64K_SIZE
+        if (((Dst % SST25_BLOCK_64K_SIZE) == 0) && ((end - Dst) >= SST25_BLOCK_64K_SIZE))
+        {
+            n        = SST25_BLOCK_64K_SIZE;
+            err_code = Block_Erase_64K_Operation(Dst);
+        }
+        else
+#endif
+        {
+            err_code = Sector_Erase_Operation(Dst);
+        }
+        if (err_code != NRF_SUCCESS)
+        {
+            return err_code;
+        }
+        p_patch->erased += n / SST25_SECTOR_SIZE;
+        Dst             += n;
+    }
+    return NRF_SUCCESS;
+}
+
+/* Checks a complete record header; erase records are done right away. */
+static uint32_t record_start(sst_patch_t * p_patch)
+{
+    sst_patch_rec_t const * p_rec = &p_patch->rec;
+    unsigned long           unit  = (p_rec->type == SST_PATCH_ERASE) ? SST25_SECTOR_SIZE : SST25_PAGE_SIZE;
+    uint32_t                err_code;
+
+    p_patch->records++;
+    if (((p_rec->type != SST_PATCH_ERASE) && (p_rec->type != SST_PATCH_PROGRAM)) || (p_rec->count == 0))
+    {
+        return NRF_ERROR_INVALID_DATA;
+    }
+    if (((p_rec->offset % unit) != 0) || (p_rec->offset > p_patch->hdr.size) ||
+        ((unsigned long)p_rec->count * unit > p_patch->hdr.size - p_rec->offset))
+    {
+        return NRF_ERROR_INVALID_ADDR;
+    }
+    if (p_rec->type == SST_PATCH_PROGRAM)
+    {
+        p_patch->pages = 0;
+        p_patch->state = STATE_PAGE;
+        return NRF_SUCCESS;
+    }
+    err_code = erase_run(p_patch, p_patch->hdr.base + p_rec->offset,
+                         p_patch->hdr.base + p_rec->offset + (unsigned long)p_rec->count * SST25_SECTOR_SIZE);
+    record_next(p_patch);
+    return err_code;
+}
+
+/* Acts on a completed header, record header or page. */
+static uint32_t item_done(sst_patch_t * p_patch)
+{
+    uint32_t err_code;
+
+    switch (p_patch->state)
+    {
+        case STATE_HEADER:
+            err_code = header_check(&p_patch->hdr);
+            record_next(p_patch);
+            return err_code;
+
+        case STATE_RECORD:
+            return record_start(p_patch);
+
+        default:
+            err_code = Page_Program_Data_Operation(p_patch->hdr.base + p_patch->rec.offset +
+                                                   (unsigned long)p_patch->pages * SST25_PAGE_SIZE,
+                                                   p_patch->page, SST25_PAGE_SIZE);
+            p_patch->programmed++;
+            if (++p_patch->pages == p_patch->rec.count)
+            {
+                record_next(p_patch);
+            }
+            return err_code;
+    }
+}
+
+void SST_Patch_Begin(sst_patch_t * p_patch)
+{
+    memset(p_patch, 0, sizeof(*p_patch));
+    p_patch->state = STATE_HEADER;
+}
+
+uint32_t SST_Patch_Write(sst_patch_t * p_patch, const uint8_t * p_data, unsigned long no_bytes)
+{
+    while (no_bytes)
+    {
+        uint8_t *     p_dst;
+        unsigned long n;
+        uint16_t      size;
+        uint32_t      err_code;
+
+        switch (p_patch->state)
+        {
+            case STATE_HEADER:
+                p_dst = (uint8_t *)&p_patch->hdr;
+                size  = sizeof(p_patch->hdr);
+                break;
+
+            case STATE_RECORD:
+                p_dst = (uint8_t *)&p_patch->rec;
+                size  = sizeof(p_patch->rec);
+                break;
+
+            case STATE_PAGE:
+                p_dst = p_patch->page;
+                size  = SST25_PAGE_SIZE;
+                break;
+
+            case STATE_DONE:
+                return NRF_ERROR_DATA_SIZE;
+
+            default:
+                return NRF_ERROR_INVALID_STATE;
+        }
+
+        n = size - p_patch->fill;
+        if (n > no_bytes)
+        {
+            n = no_bytes;
+        }
+        if (p_patch->state == STATE_HEADER)
+        {
+            memcpy(&p_dst[p_patch->fill], p_data, n);
+        }
+        else
+        {
+            p_patch->crc = SST_CRC32_Compute_Copy(&p_dst[p_patch->fill], p_data, n, &p_patch->crc);
+        }
+        p_patch->fill += (uint16_t)n;
+        p_data        += n;
+        no_bytes      -= n;
+
+        if (p_patch->fill == size)
+        {
+            p_patch->fill = 0;
+            err_code      = item_done(p_patch);
+            if (err_code != NRF_SUCCESS)
+            {
+                p_patch->state = STATE_FAILED;
+                return err_code;
+            }
+        }
+    }
+    return NRF_SUCCESS;
+}
+
+uint32_t SST_Patch_End(sst_patch_t * p_patch)
+{
+    uint8_t state = p_patch->state;
+
+    p_patch->state = STATE_IDLE;
+    if ((state == STATE_IDLE) || (state == STATE_FAILED))
+    {
+        return NRF_ERROR_INVALID_STATE;
+    }
+    if (state != STATE_DONE)
+    {
+        return NRF_ERROR_INVALID_LENGTH;
+    }
+    return (p_patch->crc == p_patch->hdr.records_crc) ? NRF_SUCCESS : NRF_ERROR_INVALID_DATA;
+}
+
+uint32_t SST_Patch_Apply(unsigned long src, unsigned long len)
+{
+    sst_patch_hdr_t * p_hdr = &m_patch.hdr;
+    unsigned long     offset;
+    uint32_t          crc = 0;
+    uint32_t          err_code;
+
+    if ((len < sizeof(*p_hdr)) || !SST25_RANGE_VALID(src, len))
+    {
+        return NRF_ERROR_INVALID_PARAM;
+    }
+    HighSpeed_Read_Data(src, (unsigned char *)p_hdr, sizeof(*p_hdr));
+    err_code = header_check(p_hdr);
+    if (err_code != NRF_SUCCESS)
+    {
+        return err_code;
+    }
+    if ((src < p_hdr->base + p_hdr->size) && (src + len > p_hdr->base))
+    {
+        return NRF_ERROR_INVALID_PARAM;
+    }
+
+    // Pass 1: the whole patch has to be intact before the image is touched.
+    for (offset = sizeof(*p_hdr); offset < len; offset += SST_PATCH_CHUNK)
+    {
+        unsigned long n = ((len - offset) > SST_PATCH_CHUNK) ? SST_PATCH_CHUNK : (len - offset);
+
+        crc = HighSpeed_Read_Data_CRC(src + offset, m_chunk, n, &crc);
+    }
+    if (crc != p_hdr->records_crc)
+    {
+        return NRF_ERROR_INVALID_DATA;
+    }
+
+    // The image has to be the one the patch was made for, already the result,
+    // or left between the two by an earlier apply of this patch.
+    if (SST_Patch_Check(p_hdr->base, p_hdr->size, p_hdr->new_crc) == NRF_SUCCESS)
+    {
+        return NRF_SUCCESS;
+    }
+    if (p_hdr->applying == SST_PATCH_NEW)
+    {
+        uint8_t applying = 0;
+
+        if (SST_Patch_Check(p_hdr->base, p_hdr->size, p_hdr->old_crc) != NRF_SUCCESS)
+        {
+            return NRF_ERROR_INVALID_STATE;
+        }
+        err_code = Page_Program_Data_Operation(src + offsetof(sst_patch_hdr_t, applying), &applying, 1);
+        if (err_code != NRF_SUCCESS)
+        {
+            return err_code;
+        }
+    }
+
+    // Pass 2: apply.
+    SST_Patch_Begin(&m_patch);
+    for (offset = 0; offset < len; offset += SST_PATCH_CHUNK)
+    {
+        unsigned long n = ((len - offset) > SST_PATCH_CHUNK) ? SST_PATCH_CHUNK : (len - offset);
+
+        HighSpeed_Read_Data(src + offset, m_chunk, n);
+        err_code = SST_Patch_Write(&m_patch, m_chunk, n);
+        if (err_code != NRF_SUCCESS)
+        {
+            m_patch.state = STATE_IDLE;
+            return err_code;
+        }
+    }
+    err_code = SST_Patch_End(&m_patch);
+    if (err_code != NRF_SUCCESS)
+    {
+        return err_code;
+    }
+    return SST_Patch_Check(p_hdr->base, p_hdr->size, p_hdr->new_crc);
+}
+
+uint32_t SST_Patch_Check(unsigned long Dst, unsigned long size, uint32_t crc)
+{
+    uint32_t      actual = 0;
+    unsigned long offset;
+
+    if (!SST25_RANGE_VALID(Dst, size))
+    {
+        return NRF_ERROR_INVALID_ADDR;
+    }
+    for (offset = 0; offset < size; offset += SST_PATCH_CHUNK)
+    {
+        unsigned long n = ((size - offset) > SST_PATCH_CHUNK) ? SST_PATCH_CHUNK : (size - offset);
+
+        actual = HighSpeed_Read_Data_CRC(Dst + offset, m_chunk, n, &actual);
+    }
+    return (actual == crc) ? NRF_SUCCESS : NRF_ERROR_INVALID_DATA;
+}
@@ -0,0 +1,139 @@
+/**@file
+ * @brief Delta updates of flash content: patch format and on-target applier.
+ *
+ * A patch turns one image of a flash range into another and touches only
+ * what differs. It is produced on the host by tools/flash_patch.c, which
+ * compares the two images sector by sector:
+ *  - identical sectors are left alone,
+ *  - sectors whose changes only clear bits get their changed pages
+ *    programmed over the old content,
+ *  - other sectors are erased and their pages other than all 0xFF programmed.
+ *
+ * Layout, little endian:
+ *
+ *     sst_patch_hdr_t
+ *     sst_patch_rec_t ERASE   (count sectors from offset)
+ *     sst_patch_rec_t PROGRAM (count pages from offset) + count * 256 bytes
+ *     ...
+ *
+ * Records are in address order, the erase of a sector always ahead of its
+ * programs. On parts with uniform 64 KByte blocks, runs of 16 erased
+ * sectors on a 64 KByte boundary are erased with Block_Erase_64K_Operation.
+ *
+ * SST_Patch_Write applies a patch as it streams in (e.g. over BLE) with one
+ * page of RAM; the CRC-32 of the records is only known to match at the end.
+ * SST_Patch_Apply applies a patch staged in flash (e.g. with SST25VF064C_ota)
+ * and checks the records and the image's old_crc before it changes anything,
+ * and the new_crc when done. SST_Patch_Check compares a range with the
+ * old_crc or new_crc of the header.
+ */
+
+#ifndef SST25VF064C_PATCH_H__
+#define SST25VF064C_PATCH_H__
+
+#include <stdint.h>
+#include "SST25VF064C.h"
+
+#define SST_PATCH_MAGIC     0x48435053ul    /**< "SPCH" */
+#define SST_PATCH_ERASE     1u
+#define SST_PATCH_PROGRAM   2u
+#define SST_PATCH_NEW       0xFFu           /**< sst_patch_hdr_t.applying of a patch not yet applied. */
+
+#ifndef SST_PATCH_CHUNK
+#define SST_PATCH_CHUNK     64u             /**< Read size of SST_Patch_Apply and SST_Patch_Check. */
+#endif
+
+/**@brief Patch header. */
+typedef struct
+{
+    uint32_t magic;
+    uint32_t base;              /**< Flash address of the image, 4 KByte aligned. */
+    uint32_t size;              /**< Image size, a multiple of 4 KByte. */
+    uint32_t old_crc;           /**< CRC-32 of the image the patch applies to. */
+    uint32_t new_crc;           /**< CRC-32 of the image after the patch. */
+    uint32_t records;
+    uint32_t records_crc;       /**< CRC-32 of everything behind the header. */
+    uint32_t header_crc;        /**< CRC-32 of the fields above. */
+    uint8_t  applying;          /**< SST_PATCH_NEW, cleared by SST_Patch_Apply before the first record. */
+    uint8_t  reserved[3];
+} sst_patch_hdr_t;
+
+/**@brief Patch record. */
+typedef struct
+{
+    uint8_t  type;              /**< SST_PATCH_ERASE or SST_PATCH_PROGRAM. */
+    uint8_t  reserved;
+    uint16_t count;             /**< Sectors to erase or pages that follow, at least 1. */
+    uint32_t offset;            /**< From the image base, sector or page aligned. */
+} sst_patch_rec_t;
+
+/**@brief Applier state. */
+typedef struct
+{
+    sst_patch_hdr_t hdr;
+    sst_patch_rec_t rec;        /**< Record being applied. */
+    uint32_t        crc;        /**< CRC-32 of the records so far. */
+    uint32_t        records;    /**< Records started. */
+    uint16_t        fill;       /**< Bytes collected of the header, record or page. */
+    uint16_t        pages;      /**< Pages of the record programmed. */
+    uint8_t         state;
+    unsigned long   erased;     /**< Sectors erased. */
+    unsigned long   programmed; /**< Pages programmed. */
+    uint8_t         page[SST25_PAGE_SIZE];
+} sst_patch_t;
+
+/**@brief Start applying a streamed patch. */
+void SST_Patch_Begin(sst_patch_t * p_patch);
+
+/**@brief Apply the next part of the patch.
+ *
+ * @retval NRF_SUCCESS              Bytes taken, the records they complete applied.
+ * @retval NRF_ERROR_INVALID_STATE  SST_Patch_Begin not called, or an earlier error.
+ * @retval NRF_ERROR_INVALID_DATA   Header corrupted, or record of unknown type.
+ * @retval NRF_ERROR_INVALID_ADDR   Image or record outside the device or the image.
+ * @retval NRF_ERROR_DATA_SIZE      Bytes beyond the last record.
+ * @return Status of a failed erase or program otherwise.
+ */
+uint32_t SST_Patch_Write(sst_patch_t * p_patch, const uint8_t * p_data, unsigned long no_bytes);
+
+/**@brief Finish a streamed patch.
+ *
+ * @retval NRF_SUCCESS               All records applied and their CRC-32 matches.
+ * @retval NRF_ERROR_INVALID_LENGTH  Patch incomplete.
+ * @retval NRF_ERROR_INVALID_DATA    CRC mismatch, the image is undefined.
+ * @retval NRF_ERROR_INVALID_STATE   An earlier SST_Patch_Write failed.
+ */
+uint32_t SST_Patch_End(sst_patch_t * p_patch);
+
+/**@brief Apply a patch stored in flash.
+ *
+ * The header, the record CRC and the image's old_crc are checked before the
+ * image is touched, the new_crc after the last record. The applying byte of
+ * the staged header is programmed before the first record: an apply cut
+ * short by a reset leaves an image matching neither CRC, and is run again
+ * from the start when called again, as re-applying records gives the same
+ * content. An image that already matches new_crc is left as it is.
+ *
+ * @param[in] src  Address of the patch.
+ * @param[in] len  Patch length.
+ *
+ * @retval NRF_SUCCESS              Patch applied, the image matches new_crc.
+ * @retval NRF_ERROR_INVALID_DATA   Header or record CRC mismatch, nothing changed;
+ *                                  or the patched image does not match new_crc.
+ * @retval NRF_ERROR_INVALID_STATE  Image matches neither old_crc nor new_crc and no apply of
+ *                                  this patch was started, nothing changed.
+ * @retval NRF_ERROR_INVALID_ADDR   Image outside the device, nothing changed.
+ * @retval NRF_ERROR_INVALID_PARAM  Patch exceeds the device or overlaps the image it patches, nothing changed.
+ * @return Status of SST_Patch_Write or SST_Patch_End otherwise.
+ */
+uint32_t SST_Patch_Apply(unsigned long src, unsigned long len);
+
+/**@brief Compare the CRC-32 of a flash range, e.g. an image with hdr.old_crc before a patch.
+ *
+ * @retval NRF_SUCCESS             CRC matches.
+ * @retval NRF_ERROR_INVALID_DATA  CRC differs.
+ * @retval NRF_ERROR_INVALID_ADDR  Range exceeds the device.
+ */
+uint32_t SST_Patch_Check(unsigned long Dst, unsigned long size, uint32_t crc);
+
+#endif /* SST25VF064C_PATCH_H__ */
@@ -0,0 +1,54 @@
+/**@file
+ * @brief Number and string output through a byte sink.
+ *
+ * Shared by the report functions of the trace, benchmark and workload
+ * modules (SST_Trace_Dump, SST_Bench_Print, SST_Workload_Print), which write
+ * text one byte at a time to a UART or RTT callback without printf.
+ */
+
+#ifndef SST25VF064C_PUT_H__
+#define SST25VF064C_PUT_H__
+
+#include <stdint.h>
+
+/**@brief Byte output, e.g. a UART or RTT write. */
+typedef void (*sst_put_t)(uint8_t byte);
+
+/**@brief Write value as hexadecimal, lower case, exactly digits digits. */
+static __inline void sst_put_hex(sst_put_t put, uint32_t value, uint8_t digits)
+{
+    while (digits--)
+    {
+        uint8_t nibble = (uint8_t)((value >> (4u * digits)) & 0x0Fu);
+        put((uint8_t)((nibble < 10) ? ('0' + nibble) : ('a' + nibble - 10)));
+    }
+}
+
+/**@brief Write value as decimal. */
+static __inline void sst_put_dec(sst_put_t put, unsigned long value)
+{
+    char    digits[sizeof(value) * 3u];     /* 3 per byte: 20 digits of a 64 bit unsigned long fit */
+    uint8_t n = 0;
+
+    do
+    {
+        digits[n++] = (char)('0' + (value % 10u));
+        value /= 10u;
+    } while (value != 0);
+
+    while (n)
+    {
+        put((uint8_t)digits[--n]);
+    }
+}
+
+/**@brief Write a zero terminated string. */
+static __inline void sst_put_str(sst_put_t put, const char * p_str)
+{
+    while (*p_str)
+    {
+        put((uint8_t)*p_str++);
+    }
+}
+
+#endif /* SST25VF064C_PUT_H__ */
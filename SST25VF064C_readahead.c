@@ -0,0 +1,170 @@
+/**@file
+ * @brief Sequential read detection with asynchronous read-ahead, see SST25VF064C_readahead.h.
+ */
+
+#include <string.h>
+#include "SST25VF064C_readahead.h"
+
+#if SST_RA_SIZE > SST25_ASYNC_MAX
+#error "SST_RA_SIZE exceeds the longest async read"
+#endif
+
+#define RA_EMPTY        0u
+#define RA_LOADING      1u
+#define RA_READY        2u
+
+#ifdef SST25VF064C_HOST
+#define ra_delay_us(us)                 /* no transfer interrupt, nothing is ever in flight */
+#else
+#define ra_delay_us(us) nrf_delay_us(us)
+#endif
+
+sst_ra_stats_t sst_ra_stats;
+
+static uint8_t          m_buf[2][SST25_ASYNC_HEADER + SST_RA_SIZE];
+static unsigned long    m_addr[2];
+static volatile uint8_t m_state[2];
+static uint8_t          m_loading;      /* buffer of the read-ahead in flight */
+static unsigned long    m_next;         /* end of the last read */
+static uint8_t          m_streak;       /* sequential reads in a row */
+
+/* Runs in the SPI master event handler. A read-ahead given up on by
+ * ra_wait stays empty. */
+static void ra_complete(void)
+{
+    if (m_state[m_loading] == RA_LOADING)
+    {
+        m_state[m_loading] = RA_READY;
+    }
+}
+
+/* Waits for buffer b to load, or with b -1 for any async read to end, at
+ * most as long as the driver waits for a transfer of the same size. */
+static bool ra_wait(int8_t b)
+{
+    unsigned long limit_us = (((SST25_ASYNC_HEADER + SST_RA_SIZE) * 16ul) / (SST25_SPI_Hz() / 1000000ul))
+                             + SST25_XFER_SLACK_US;
+
+    while ((b >= 0) ? (m_state[b] == RA_LOADING) : Read_Async_Busy())
+    {
+        if (limit_us == 0)
+        {
+            sst_ra_stats.timeouts++;
+            return false;
+        }
+        ra_delay_us(1);
+        limit_us--;
+    }
+    return true;
+}
+
+/* Buffer holding or loading Dst, or -1. */
+static int8_t ra_find(unsigned long Dst)
+{
+    int8_t b;
+
+    for (b = 0; b < 2; b++)
+    {
+        if ((m_state[b] != RA_EMPTY) && (Dst >= m_addr[b]) && (Dst - m_addr[b] < SST_RA_SIZE))
+        {
+            return b;
+        }
+    }
+    return -1;
+}
+
+/* Starts reading the bytes after the buffered part of the stream into a
+ * buffer the stream does not use. */
+static void ra_prefetch(void)
+{
+    unsigned long target = m_next;
+    uint8_t       used   = 0;
+    int8_t        b;
+
+    if (Read_Async_Busy())
+    {
+        return;
+    }
+    while (((b = ra_find(target)) >= 0) && !(used & (1u << b)))
+    {
+        used  |= (uint8_t)(1u << b);
+        target = m_addr[b] + SST_RA_SIZE;
+    }
+    for (b = 0; b < 2; b++)
+    {
+        if (!(used & (1u << b)) && (m_state[b] != RA_LOADING))
+        {
+            break;
+        }
+    }
+    if ((b == 2) || !SST25_RANGE_VALID(target, SST_RA_SIZE))
+    {
+        return;
+    }
+
+    m_addr[b]  = target;
+    m_state[b] = RA_LOADING;
+    m_loading  = (uint8_t)b;
+    if (HighSpeed_Read_Async(target, m_buf[b], SST_RA_SIZE, ra_complete) != NRF_SUCCESS)
+    {
+        m_state[b] = RA_EMPTY;
+        return;
+    }
+    sst_ra_stats.prefetches++;
+}
+
+void SST_RA_Init(void)
+{
+    SST_RA_Invalidate();
+    memset(&sst_ra_stats, 0, sizeof(sst_ra_stats));
+}
+
+void SST_RA_Read(unsigned long Dst, uint8_t * p_data, unsigned long no_bytes)
+{
+    bool   sequential = (Dst == m_next);
+    int8_t b;
+
+    while ((no_bytes != 0) && ((b = ra_find(Dst)) >= 0))
+    {
+        unsigned long offset = Dst - m_addr[b];
+        unsigned long n      = SST_RA_SIZE - offset;
+
+        if (m_state[b] == RA_LOADING)
+        {
+            sst_ra_stats.waits++;
+            if (!ra_wait(b))
+            {
+                m_state[b] = RA_EMPTY;      /* the rest is read below */
+                break;
+            }
+        }
+        n = (n > no_bytes) ? no_bytes : n;
+        memcpy(p_data, &m_buf[b][SST25_ASYNC_HEADER + offset], n);
+        sst_ra_stats.hit_bytes += n;
+        Dst      += n;
+        p_data   += n;
+        no_bytes -= n;
+    }
+    if (no_bytes != 0)
+    {
+        HighSpeed_Read_Data(Dst, p_data, no_bytes);
+        sst_ra_stats.miss_bytes += no_bytes;
+        Dst += no_bytes;
+    }
+
+    m_next   = Dst;
+    m_streak = sequential ? ((m_streak < 0xFFu) ? m_streak + 1u : m_streak) : 1u;
+    if (m_streak >= SST_RA_TRIGGER)
+    {
+        ra_prefetch();
+    }
+}
+
+void SST_RA_Invalidate(void)
+{
+    (void)ra_wait(-1);      /* let the read-ahead in flight finish */
+    m_state[0] = RA_EMPTY;
+    m_state[1] = RA_EMPTY;
+    m_streak   = 0;
+    m_next     = 0xFFFFFFFFul;
+}
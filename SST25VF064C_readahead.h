@@ -0,0 +1,64 @@
+/**@file
+ * @brief Sequential read detection with asynchronous read-ahead.
+ *
+ * SST_RA_Read serves reads from two RAM buffers of SST_RA_SIZE bytes where
+ * it can and from the device otherwise. After SST_RA_TRIGGER reads in a
+ * row that each start where the previous one ended, it starts a
+ * HighSpeed_Read_Async of the bytes following the last read into a free
+ * buffer and returns, so the transfer runs from the SPI event handler while
+ * the application processes the data. A following sequential read is then
+ * copied from RAM, waiting only if the transfer has not finished yet. One
+ * read-ahead is in flight at a time; the second buffer is filled on the
+ * next call, so a stream alternates between the two.
+ *
+ * With SST25_SPI_DIRECT or a host transport there is no transfer interrupt
+ * and the read-ahead runs before SST_RA_Read returns; it then only saves
+ * command overhead.
+ *
+ * A read-ahead that does not complete within the driver's transfer limit
+ * (SST25_XFER_SLACK_US on top of the transfer time) is dropped and the
+ * bytes are read synchronously instead.
+ *
+ * The buffers are not updated by program or erase commands: call
+ * SST_RA_Invalidate after changing a region that is read through here.
+ */
+
+#ifndef SST25VF064C_READAHEAD_H__
+#define SST25VF064C_READAHEAD_H__
+
+#include <stdint.h>
+#include "SST25VF064C.h"
+
+#ifndef SST_RA_SIZE
+#if SST25_ASYNC_MAX < 256u
+#define SST_RA_SIZE     SST25_ASYNC_MAX
+#else
+#define SST_RA_SIZE     256u    /**< Bytes per read-ahead buffer, at most SST25_ASYNC_MAX. */
+#endif
+#endif
+#ifndef SST_RA_TRIGGER
+#define SST_RA_TRIGGER  2u      /**< Sequential reads in a row before reading ahead. */
+#endif
+
+/**@brief Read-ahead counters. */
+typedef struct
+{
+    unsigned long hit_bytes;        /**< Bytes copied from the buffers. */
+    unsigned long miss_bytes;       /**< Bytes read from the device in the caller's context. */
+    unsigned long prefetches;       /**< Read-aheads started. */
+    unsigned long waits;            /**< Reads that had to wait for a read-ahead to finish. */
+    unsigned long timeouts;         /**< Read-aheads that did not finish in time and were dropped. */
+} sst_ra_stats_t;
+
+extern sst_ra_stats_t sst_ra_stats;
+
+/**@brief Drop the buffers and the access history, clear the counters. */
+void SST_RA_Init(void);
+
+/**@brief Read any number of bytes, from the buffers where possible. Main context only. */
+void SST_RA_Read(unsigned long Dst, uint8_t * p_data, unsigned long no_bytes);
+
+/**@brief Wait for a read-ahead in flight and drop the buffers. */
+void SST_RA_Invalidate(void);
+
+#endif /* SST25VF064C_READAHEAD_H__ */
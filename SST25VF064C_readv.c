@@ -0,0 +1,142 @@
+/**@file
+ * @brief Vectored reads, see SST25VF064C_readv.h.
+ */
+
+#include <string.h>
+#include "SST25VF064C_readv.h"
+
+sst_readv_stats_t sst_readv_stats;
+
+static sst25_sg_t m_sg[SST25_SCATTER_SEGS];
+
+/* Insertion sort by address, lists are short and often nearly sorted. */
+static void readv_sort(sst_readv_t * p_vec, uint16_t count)
+{
+    uint16_t i;
+    uint16_t j;
+
+    for (i = 1; i < count; i++)
+    {
+        sst_readv_t entry = p_vec[i];
+
+        for (j = i; (j > 0) && (p_vec[j - 1].addr > entry.addr); j--)
+        {
+            p_vec[j] = p_vec[j - 1];
+        }
+        p_vec[j] = entry;
+    }
+}
+
+/* Copies the bytes each entry shares with an earlier one. Sorted by
+ * address, the earlier entry reaching furthest covers the whole overlap
+ * and is complete by the time the later one is handled. */
+static void readv_overlaps(sst_readv_t const * p_vec, uint16_t count)
+{
+    sst_readv_t const * p_far = NULL;
+    uint16_t            i;
+
+    for (i = 0; i < count; i++)
+    {
+        unsigned long end = p_vec[i].addr + p_vec[i].len;
+
+        if (p_vec[i].len == 0)
+        {
+            continue;
+        }
+        if (p_far != NULL)
+        {
+            unsigned long far_end = p_far->addr + p_far->len;
+
+            if (far_end > p_vec[i].addr)
+            {
+                memcpy(p_vec[i].p_dst, &p_far->p_dst[p_vec[i].addr - p_far->addr],
+                       ((end < far_end) ? end : far_end) - p_vec[i].addr);
+            }
+            if (end <= far_end)
+            {
+                continue;
+            }
+        }
+        p_far = &p_vec[i];
+    }
+}
+
+uint32_t SST_Readv(sst_readv_t * p_vec, uint16_t count, uint16_t gap)
+{
+    unsigned long pos = 0;      /* end of the bytes read so far */
+    uint16_t      i;
+
+    for (i = 0; i < count; i++)
+    {
+        if ((p_vec[i].len != 0) && !SST25_RANGE_VALID(p_vec[i].addr, p_vec[i].len))
+        {
+            return NRF_ERROR_INVALID_PARAM;
+        }
+    }
+    readv_sort(p_vec, count);
+
+    i = 0;
+    while (i < count)
+    {
+        unsigned long start;
+        unsigned long limit;
+        uint8_t       segs = 0;
+
+        if ((p_vec[i].len == 0) || (p_vec[i].addr + p_vec[i].len <= pos))
+        {
+            i++;
+            continue;
+        }
+        start = (p_vec[i].addr > pos) ? p_vec[i].addr : pos;
+        limit = start + SST25_READ_BURST;
+        pos   = start;
+
+        while (i < count)
+        {
+            unsigned long end = p_vec[i].addr + p_vec[i].len;
+            unsigned long n;
+
+            if ((p_vec[i].len == 0) || (end <= pos))
+            {
+                i++;
+                continue;
+            }
+            if (p_vec[i].addr > pos)
+            {
+                if ((p_vec[i].addr - pos > gap) || (p_vec[i].addr >= limit) || (segs + 2u > SST25_SCATTER_SEGS))
+                {
+                    break;
+                }
+                m_sg[segs].p_tx = NULL;
+                m_sg[segs].p_rx = NULL;
+                m_sg[segs].len  = (uint16_t)(p_vec[i].addr - pos);
+                sst_readv_stats.gap_bytes += m_sg[segs].len;
+                segs++;
+                pos = p_vec[i].addr;
+            }
+            else if (segs == SST25_SCATTER_SEGS)
+            {
+                break;
+            }
+            n = ((end < limit) ? end : limit) - pos;
+            m_sg[segs].p_tx = NULL;
+            m_sg[segs].p_rx = &p_vec[i].p_dst[pos - p_vec[i].addr];
+            m_sg[segs].len  = (uint16_t)n;
+            segs++;
+            pos += n;
+            if (pos == limit)
+            {
+                // The rest of this entry, if any, opens the next transaction.
+                break;
+            }
+            i++;
+        }
+
+        HighSpeed_Read_Scatter(start, m_sg, segs);
+        sst_readv_stats.transactions++;
+    }
+
+    readv_overlaps(p_vec, count);
+    sst_readv_stats.entries += count;
+    return NRF_SUCCESS;
+}
@@ -0,0 +1,56 @@
+/**@file
+ * @brief Vectored reads: many small ranges in few transactions.
+ *
+ * SST_Readv takes a list of (address, length, destination) entries, sorts
+ * it by address and walks it in order. Entries that overlap, touch or lie
+ * at most gap bytes apart share one HighSpeed_Read_Scatter transaction: the
+ * bytes between them are clocked and discarded, the rest lands straight in
+ * the destinations. A transaction ends at SST25_READ_BURST bytes, at
+ * SST25_SCATTER_SEGS segments or at a wider gap. Bytes wanted by more than
+ * one entry are read once and copied to the others afterwards.
+ *
+ * A gap byte costs 8 SCK cycles, a new transaction the 4 or 5 command
+ * bytes plus the software overhead per transfer, so gaps up to a few tens
+ * of bytes are usually cheaper to read through than to skip.
+ */
+
+#ifndef SST25VF064C_READV_H__
+#define SST25VF064C_READV_H__
+
+#include <stdint.h>
+#include "SST25VF064C.h"
+
+#ifndef SST_READV_GAP
+#define SST_READV_GAP   16u     /**< Suggested gap argument of SST_Readv. */
+#endif
+
+/**@brief One range of a vectored read. */
+typedef struct
+{
+    unsigned long addr;     /**< Flash address. */
+    uint8_t *     p_dst;    /**< Destination, len bytes. */
+    uint16_t      len;      /**< Bytes to read, 0 to skip the entry. */
+} sst_readv_t;
+
+/**@brief Vectored read counters. */
+typedef struct
+{
+    unsigned long entries;          /**< Entries read. */
+    unsigned long transactions;     /**< HighSpeed_Read_Scatter calls. */
+    unsigned long gap_bytes;        /**< Bytes clocked and discarded between entries. */
+} sst_readv_stats_t;
+
+extern sst_readv_stats_t sst_readv_stats;
+
+/**@brief Read a list of ranges with as few transactions as possible.
+ *
+ * @param[in,out] p_vec  Entries. The list is sorted by address in place.
+ * @param[in]     count  Number of entries.
+ * @param[in]     gap    Largest distance in bytes between two entries read in one transaction.
+ *
+ * @retval NRF_SUCCESS              All destinations filled.
+ * @retval NRF_ERROR_INVALID_PARAM  An entry lies outside the device, nothing read.
+ */
+uint32_t SST_Readv(sst_readv_t * p_vec, uint16_t count, uint16_t gap);
+
+#endif /* SST25VF064C_READV_H__ */
@@ -0,0 +1,116 @@
+/**@file
+ * @brief Occupancy scan, see SST25VF064C_scan.h.
+ */
+
+#include "SST25VF064C_scan.h"
+
+#if ((SST_SCAN_PROBE % 4u) != 0) || ((SST_SCAN_CHUNK % 4u) != 0) || (SST_SCAN_PROBE > SST_SCAN_CHUNK)
+#error "SST_SCAN_PROBE and SST_SCAN_CHUNK must be multiples of 4, the probe no longer than a chunk"
+#endif
+
+uint32_t sst_scan_bitmap[SST_SCAN_WORDS];
+
+static uint32_t m_buf[SST_SCAN_CHUNK / 4u];
+
+/* Reads the piece and reports whether all of it is 0xFF. */
+static bool scan_blank(unsigned long Dst, unsigned long size)
+{
+    uint32_t const * p_word = m_buf;
+    uint32_t const * p_end  = &m_buf[size / 4u];
+
+    HighSpeed_Read_Data(Dst, (unsigned char *)m_buf, size);
+    while (p_word < p_end)
+    {
+        if (*p_word++ != 0xFFFFFFFFul)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+static bool scan_sector(unsigned long Dst)
+{
+    unsigned long offset;
+
+    if (!scan_blank(Dst, SST_SCAN_PROBE))
+    {
+        return false;
+    }
+    for (offset = SST_SCAN_PROBE; offset < SST25_SECTOR_SIZE; offset += SST_SCAN_CHUNK)
+    {
+        unsigned long n = SST25_SECTOR_SIZE - offset;
+
+        if (!scan_blank(Dst + offset, (n > SST_SCAN_CHUNK) ? SST_SCAN_CHUNK : n))
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+void SST_Scan_Chip(void)
+{
+    SST_Scan_Range(0, SST25_CAPACITY);
+}
+
+void SST_Scan_Range(unsigned long Dst, unsigned long size)
+{
+    unsigned long sector;
+    unsigned long last;
+
+    if ((size == 0) || !SST25_RANGE_VALID(Dst, size))
+    {
+        return;
+    }
+    last = (Dst + size - 1u) / SST25_SECTOR_SIZE;
+    for (sector = Dst / SST25_SECTOR_SIZE; sector <= last; sector++)
+    {
+        if (scan_sector(sector * SST25_SECTOR_SIZE))
+        {
+            sst_scan_bitmap[sector / 32u] &= ~(1ul << (sector % 32u));
+        }
+        else
+        {
+            sst_scan_bitmap[sector / 32u] |= (1ul << (sector % 32u));
+        }
+    }
+}
+
+bool SST_Scan_Used(unsigned long Dst)
+{
+    unsigned long sector = (Dst & SST25_ADDR_MASK) / SST25_SECTOR_SIZE;
+
+    return (sst_scan_bitmap[sector / 32u] & (1ul << (sector % 32u))) != 0;
+}
+
+unsigned long SST_Scan_Find_Blank(unsigned short count)
+{
+    unsigned long sector = 0;
+    unsigned long run    = 0;
+
+    if (count == 0)
+    {
+        return 0;
+    }
+    while (sector < SST_SCAN_SECTORS)
+    {
+        // Skip fully used words at once.
+        if (((sector % 32u) == 0) && (sst_scan_bitmap[sector / 32u] == 0xFFFFFFFFul))
+        {
+            run     = 0;
+            sector += 32u;
+            continue;
+        }
+        if (sst_scan_bitmap[sector / 32u] & (1ul << (sector % 32u)))
+        {
+            run = 0;
+        }
+        else if (++run == count)
+        {
+            return (sector + 1u - count) * SST25_SECTOR_SIZE;
+        }
+        sector++;
+    }
+    return 0xFFFFFFFFul;
+}
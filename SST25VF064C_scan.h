@@ -0,0 +1,51 @@
+/**@file
+ * @brief Occupancy scan: a RAM bitmap of blank and used 4 KByte sectors.
+ *
+ * The scan reads every sector with HighSpeed_Read_Data and compares it
+ * against 0xFF a 32-bit word at a time. A sector is marked used at its
+ * first word that is not blank: the first SST_SCAN_PROBE bytes are read on
+ * their own, so most used sectors cost one short transaction, and a blank
+ * sector is read in full in SST_SCAN_CHUNK byte pieces.
+ *
+ * SST_Scan_Chip builds the whole bitmap (2048 bits for 8 MByte).
+ * SST_Scan_Range rescans only the sectors touching a range, e.g. after an
+ * erase or after programming into sectors the bitmap holds as blank.
+ */
+
+#ifndef SST25VF064C_SCAN_H__
+#define SST25VF064C_SCAN_H__
+
+#include <stdint.h>
+#include "SST25VF064C.h"
+
+#define SST_SCAN_SECTORS    (SST25_CAPACITY / SST25_SECTOR_SIZE)    /**< Bits in the bitmap. */
+#define SST_SCAN_WORDS      ((SST_SCAN_SECTORS + 31u) / 32u)
+
+#ifndef SST_SCAN_PROBE
+#define SST_SCAN_PROBE      16u     /**< Bytes read first from every sector, a multiple of 4. */
+#endif
+#ifndef SST_SCAN_CHUNK
+#define SST_SCAN_CHUNK      256u    /**< Bytes per read for the rest of a sector, a multiple of 4. */
+#endif
+
+/**@brief Bit n set: sector n holds at least one byte other than 0xFF. */
+extern uint32_t sst_scan_bitmap[SST_SCAN_WORDS];
+
+/**@brief Scan every sector of the device. */
+void SST_Scan_Chip(void);
+
+/**@brief Rescan the sectors touching Dst to Dst + size - 1. */
+void SST_Scan_Range(unsigned long Dst, unsigned long size);
+
+/**@brief Whether the last scan found data in the sector holding Dst. */
+bool SST_Scan_Used(unsigned long Dst);
+
+/**@brief Find count blank sectors in a row.
+ *
+ * @param[in] count  Sectors needed.
+ *
+ * @return Address of the first one, or 0xFFFFFFFF if the bitmap has no such run.
+ */
+unsigned long SST_Scan_Find_Blank(unsigned short count);
+
+#endif /* SST25VF064C_SCAN_H__ */
@@ -0,0 +1,215 @@
+/**@file
+ * @brief Priority and deadline aware scheduling of SST25VF064C operations.
+ */
+
+#include <stddef.h>
+#include "SST25VF064C_sched.h"
+
+
+static sst_sched_req_t * m_queue;       /* pending requests, submission order */
+static sst_sched_req_t * m_busy_req;    /* request whose step the device is executing */
+static unsigned long     m_busy_len;
+static uint32_t          m_busy_start;  /* now when the step was issued */
+static uint32_t          m_busy_limit;  /* ticks the step may take */
+
+/* Deadline of a step whose datasheet maximum is max_us, in ticks; one more
+ * for the tick the step was issued in. */
+static uint32_t sched_limit(unsigned long max_us)
+{
+    return (uint32_t)(((uint64_t)SST25_TIMEOUT_US(max_us) * SST_SCHED_TICK_HZ + 999999u) / 1000000u) + 1u;
+}
+
+static bool sched_overdue(const sst_sched_req_t * p_req, uint32_t now)
+{
+    return (int32_t)(now - p_req->deadline) >= 0;
+}
+
+/* 0: overdue, 1: read, 2: program or erase. */
+static uint8_t sched_class(const sst_sched_req_t * p_req, uint32_t now)
+{
+    if (sched_overdue(p_req, now))
+    {
+        return 0;
+    }
+    return (p_req->op == SST_SCHED_READ) ? 1 : 2;
+}
+
+static bool sched_before(const sst_sched_req_t * p_a, const sst_sched_req_t * p_b, uint32_t now)
+{
+    uint8_t class_a = sched_class(p_a, now);
+    uint8_t class_b = sched_class(p_b, now);
+
+    if (class_a != class_b)
+    {
+        return class_a < class_b;
+    }
+    if (p_a->priority != p_b->priority)
+    {
+        return p_a->priority < p_b->priority;
+    }
+    return (int32_t)(p_a->deadline - p_b->deadline) < 0;
+}
+
+static bool sched_reads_waiting(void)
+{
+    const sst_sched_req_t * p_req;
+
+    for (p_req = m_queue; p_req != NULL; p_req = p_req->p_next)
+    {
+        if (p_req->op == SST_SCHED_READ)
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+static void sched_complete(sst_sched_req_t * p_req, uint32_t result)
+{
+    sst_sched_req_t ** pp = &m_queue;
+
+    while (*pp != p_req)
+    {
+        pp = &(*pp)->p_next;
+    }
+    *pp = p_req->p_next;
+    if (p_req->callback != NULL)
+    {
+        p_req->callback(p_req, result);
+    }
+}
+
+uint32_t SST_Sched_Submit(sst_sched_req_t * p_req)
+{
+    sst_sched_req_t ** pp = &m_queue;
+
+    if ((p_req->len == 0) ||
+        ((p_req->op == SST_SCHED_ERASE) && (((p_req->addr | p_req->len) % SST25_SECTOR_SIZE) != 0)))
+    {
+        return NRF_ERROR_INVALID_PARAM;
+    }
+    if (!SST25_RANGE_VALID(p_req->addr, p_req->len))
+    {
+        return NRF_ERROR_INVALID_ADDR;
+    }
+    p_req->done   = 0;
+    p_req->p_next = NULL;
+    while (*pp != NULL)
+    {
+        pp = &(*pp)->p_next;
+    }
+    *pp = p_req;
+    return NRF_SUCCESS;
+}
+
+bool SST_Sched_Process(uint32_t now)
+{
+    sst_sched_req_t * p_req;
+    sst_sched_req_t * p_best = NULL;
+    unsigned long     a;
+    unsigned long     n;
+    uint32_t          err_code;
+
+    if (m_busy_req != NULL)
+    {
+        if (Read_Status_Register() & 0x01)
+        {
+            if ((uint32_t)(now - m_busy_start) < m_busy_limit)
+            {
+                return true;
+            }
+            // Stuck: abort the step, the request's area is undefined.
+            sst25_health.timeouts++;
+            (void)SST25_Recover();
+            p_req      = m_busy_req;
+            m_busy_req = NULL;
+            sched_complete(p_req, NRF_ERROR_TIMEOUT);
+            return m_queue != NULL;
+        }
+        m_busy_req->done += m_busy_len;
+        if (m_busy_req->done >= m_busy_req->len)
+        {
+            sched_complete(m_busy_req, NRF_SUCCESS);
+        }
+        m_busy_req = NULL;
+    }
+
+    for (p_req = m_queue; p_req != NULL; p_req = p_req->p_next)
+    {
+        if ((p_best == NULL) || sched_before(p_req, p_best, now))
+        {
+            p_best = p_req;
+        }
+    }
+    if (p_best == NULL)
+    {
+        return false;
+    }
+
+    a = p_best->addr + p_best->done;
+    n = p_best->len - p_best->done;
+    (void)SST25_Last_Error();
+    switch (p_best->op)
+    {
+        case SST_SCHED_READ:
+            if (n > SST_SCHED_READ_STEP)
+            {
+                n = SST_SCHED_READ_STEP;
+            }
+            HighSpeed_Read_Data(a, &p_best->p_data[p_best->done], n);
+            p_best->done += n;
+            if (p_best->done >= p_best->len)
+            {
+                sched_complete(p_best, NRF_SUCCESS);
+            }
+            return m_queue != NULL;
+
+        case SST_SCHED_PROGRAM:
+            if (n > (SST25_PAGE_SIZE - (a % SST25_PAGE_SIZE)))
+            {
+                n = SST25_PAGE_SIZE - (a % SST25_PAGE_SIZE);
+            }
+            WREN();
+            Page_Program_Data(a, &p_best->p_data[p_best->done], (unsigned short)n);
+            m_busy_limit = sched_limit(SST25_T_PP_MAX_US);
+            break;
+
+        case SST_SCHED_ERASE:
+        default:
+            WREN();
+#if SST25_BLOCK_64K_SIZE
+            if (!sched_reads_waiting() && (n >= SST25_BLOCK_64K_SIZE) && ((a % SST25_BLOCK_64K_SIZE) == 0))
+            {
+                Block_Erase_64K(a);
+                n            = SST25_BLOCK_64K_SIZE;
+                m_busy_limit = sched_limit(SST25_T_BE_MAX_US);
+            }
+            else
+#endif
+#if SST25_BLOCK_32K_SIZE
+            if (!sched_reads_waiting() && (n >= SST25_BLOCK_32K_SIZE) && ((a % SST25_BLOCK_32K_SIZE) == 0))
+            {
+                Block_Erase_32K(a);
+                n            = SST25_BLOCK_32K_SIZE;
+                m_busy_limit = sched_limit(SST25_T_BE_MAX_US);
+            }
+            else
+#endif
+            {
+                Sector_Erase(a);    /* keeps the wait of newly arriving reads short */
+                n            = SST25_SECTOR_SIZE;
+                m_busy_limit = sched_limit(SST25_T_SE_MAX_US);
+            }
+            break;
+    }
+    err_code = SST25_Last_Error();
+    if (err_code != NRF_SUCCESS)
+    {
+        sched_complete(p_best, err_code);
+        return m_queue != NULL;
+    }
+    m_busy_req   = p_best;
+    m_busy_len   = n;
+    m_busy_start = now;
+    return true;
+}
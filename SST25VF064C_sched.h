@@ -0,0 +1,87 @@
+/**@file
+ * @brief Priority and deadline aware scheduling of SST25VF064C operations.
+ *
+ * Subsystems sharing the chip (logging, configuration, OTA staging) submit
+ * requests instead of calling the blocking *_Operation functions. Requests
+ * are served from SST_Sched_Process in main context, one step at a time:
+ *  - a read step moves up to SST_SCHED_READ_STEP bytes,
+ *  - a program step programs up to one page and returns while tPP elapses,
+ *  - an erase step starts one 64K, 32K or 4K erase and returns while it runs.
+ *
+ * Reads go ahead of pending program and erase work, and erase requests are
+ * issued as 4 KByte sector erases while reads are waiting. A read therefore
+ * waits for at most one page program or one sector erase (the device has no
+ * erase suspend). Overdue requests of any kind are served first; within the
+ * same class, lower priority values and earlier deadlines win.
+ *
+ * Request memory is owned by the caller and must stay valid until the
+ * callback has run.
+ */
+
+#ifndef SST25VF064C_SCHED_H__
+#define SST25VF064C_SCHED_H__
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "SST25VF064C.h"
+
+#define SST_SCHED_READ_STEP     256u    /**< Bytes read per SST_Sched_Process call. */
+
+#ifndef SST_SCHED_TICK_HZ
+#define SST_SCHED_TICK_HZ       32768u  /**< Rate of the now argument of SST_Sched_Process (RTC1 default). */
+#endif
+
+/**@brief Operation of a request. */
+typedef enum
+{
+    SST_SCHED_READ,             /**< Read len bytes into p_data. */
+    SST_SCHED_PROGRAM,          /**< Program len bytes from p_data (erased target). */
+    SST_SCHED_ERASE             /**< Erase len bytes, addr and len 4 KByte aligned. */
+} sst_sched_op_t;
+
+typedef struct sst_sched_req_s sst_sched_req_t;
+
+/**@brief Completion callback, result is an NRF error code. */
+typedef void (*sst_sched_callback_t)(sst_sched_req_t * p_req, uint32_t result);
+
+/**@brief A scheduled flash request. */
+struct sst_sched_req_s
+{
+    sst_sched_op_t       op;
+    uint8_t              priority;      /**< 0 is most urgent. */
+    uint32_t             deadline;      /**< In the caller's tick units, see SST_Sched_Process. */
+    unsigned long        addr;
+    uint8_t            * p_data;        /**< Not written for SST_SCHED_PROGRAM. */
+    unsigned long        len;
+    sst_sched_callback_t callback;
+    void               * p_context;     /**< For the caller's use. */
+
+    /* Scheduler internal. */
+    unsigned long        done;
+    sst_sched_req_t    * p_next;
+};
+
+/**@brief Queue a request.
+ *
+ * @retval NRF_SUCCESS              Queued.
+ * @retval NRF_ERROR_INVALID_PARAM  len is 0, or an erase not 4 KByte aligned.
+ * @retval NRF_ERROR_INVALID_ADDR   Range exceeds the device.
+ */
+uint32_t SST_Sched_Submit(sst_sched_req_t * p_req);
+
+/**@brief Run the next scheduling step.
+ *
+ * @param[in] now  Current time in the units of the request deadlines
+ *                 (for example the RTC1 counter), SST_SCHED_TICK_HZ ticks
+ *                 per second. Wraps like a uint32_t.
+ *
+ * A program or erase step still busy SST25_TIMEOUT_US of its datasheet
+ * maximum after it was issued is aborted with SST25_Recover, and its
+ * request completes with NRF_ERROR_TIMEOUT. A step the bus failed to
+ * issue completes its request with the SST25_Last_Error status.
+ *
+ * @return true while requests are queued or the device is busy.
+ */
+bool SST_Sched_Process(uint32_t now);
+
+#endif /* SST25VF064C_SCHED_H__ */
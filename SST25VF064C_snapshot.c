@@ -0,0 +1,294 @@
+/**@file
+ * @brief RAM state snapshots in the SST25VF064C, see SST25VF064C_snapshot.h.
+ */
+
+#include <stddef.h>
+#include <string.h>
+#include "SST25VF064C_snapshot.h"
+#include "SST25VF064C_crc32.h"
+
+#define SNAPSHOT_MAGIC  0x50414E53ul    /* "SNAP" */
+
+/* Slot header, programmed last into page 0 of the slot. */
+typedef struct
+{
+    uint32_t magic;
+    uint32_t sequence;                  /* incremented per snapshot, wraps */
+    uint32_t length;                    /* data bytes, starting at page 1 */
+    uint32_t layout;                    /* CRC-32 of the region lengths */
+    uint32_t data_crc;
+    uint32_t header_crc;                /* CRC-32 of the fields above */
+} snapshot_hdr_t;
+
+static uint8_t *        m_region_data[SST_SNAPSHOT_REGIONS];
+static uint16_t         m_region_len[SST_SNAPSHOT_REGIONS];
+static uint8_t          m_regions;
+static unsigned long    m_total;
+
+static unsigned long    m_base;
+static unsigned long    m_slot_size;    /* 0 before SST_Snapshot_Init */
+static snapshot_hdr_t   m_hdr[2];
+static bool             m_hdr_valid[2];
+static bool             m_have;         /* m_current holds a snapshot */
+static uint8_t          m_current;
+static bool             m_prepared;     /* the slot after m_current is erased */
+
+static uint8_t          m_page[SST25_PAGE_SIZE];
+
+static unsigned long slot_addr(uint8_t slot)
+{
+    return m_base + slot * m_slot_size;
+}
+
+static uint8_t next_slot(void)
+{
+    return m_have ? (uint8_t)(1u - m_current) : 0u;
+}
+
+/* Sectors a snapshot of the registered regions occupies, in bytes. */
+static unsigned long slot_span(void)
+{
+    unsigned long need = SST25_PAGE_SIZE + m_total;
+
+    return ((need + SST25_SECTOR_SIZE - 1u) / SST25_SECTOR_SIZE) * SST25_SECTOR_SIZE;
+}
+
+static uint32_t layout_crc(void)
+{
+    uint32_t crc = SST_CRC32_Compute(&m_regions, 1, NULL);
+
+    return SST_CRC32_Compute((uint8_t const *)m_region_len, m_regions * sizeof(m_region_len[0]), &crc);
+}
+
+static uint32_t header_crc(snapshot_hdr_t const * p_hdr)
+{
+    return SST_CRC32_Compute((uint8_t const *)p_hdr, offsetof(snapshot_hdr_t, header_crc), NULL);
+}
+
+static bool header_valid(snapshot_hdr_t const * p_hdr)
+{
+    return (p_hdr->magic == SNAPSHOT_MAGIC) &&
+           (p_hdr->header_crc == header_crc(p_hdr)) &&
+           (p_hdr->length <= m_slot_size - SST25_PAGE_SIZE);
+}
+
+static uint32_t slot_erase(uint8_t slot)
+{
+    unsigned long span = slot_span();
+    unsigned long offset;
+    uint32_t      err_code;
+
+    m_hdr_valid[slot] = false;
+    for (offset = 0; offset < span; offset += SST25_SECTOR_SIZE)
+    {
+        err_code = Sector_Erase_Operation(slot_addr(slot) + offset);
+        if (err_code != NRF_SUCCESS)
+        {
+            return err_code;
+        }
+    }
+    return NRF_SUCCESS;
+}
+
+uint32_t SST_Snapshot_Init(unsigned long base, unsigned long slot_size)
+{
+    uint8_t slot;
+
+    m_slot_size = 0;
+    m_have      = false;
+    m_prepared  = false;
+    if (((base % SST25_SECTOR_SIZE) != 0) || ((slot_size % SST25_SECTOR_SIZE) != 0) ||
+        (slot_size == 0) || !SST25_RANGE_VALID(base, 2u * slot_size))
+    {
+        return NRF_ERROR_INVALID_PARAM;
+    }
+    m_base      = base;
+    m_slot_size = slot_size;
+
+    for (slot = 0; slot < 2; slot++)
+    {
+        HighSpeed_Read_Data(slot_addr(slot), (unsigned char *)&m_hdr[slot], sizeof(m_hdr[slot]));
+        m_hdr_valid[slot] = header_valid(&m_hdr[slot]);
+        if (m_hdr_valid[slot] &&
+            (!m_have || ((int32_t)(m_hdr[slot].sequence - m_hdr[m_current].sequence) > 0)))
+        {
+            m_have    = true;
+            m_current = slot;
+        }
+    }
+    return NRF_SUCCESS;
+}
+
+uint32_t SST_Snapshot_Register(void * p_data, uint16_t len)
+{
+    if (m_regions == SST_SNAPSHOT_REGIONS)
+    {
+        return NRF_ERROR_NO_MEM;
+    }
+    if (len == 0)
+    {
+        return NRF_ERROR_INVALID_PARAM;
+    }
+    m_region_data[m_regions] = (uint8_t *)p_data;
+    m_region_len[m_regions]  = len;
+    m_regions++;
+    m_total   += len;
+    m_prepared = false;
+    return NRF_SUCCESS;
+}
+
+uint32_t SST_Snapshot_Save(void)
+{
+    snapshot_hdr_t hdr;
+    uint8_t        slot = next_slot();
+    unsigned long  Dst  = slot_addr(slot) + SST25_PAGE_SIZE;
+    uint32_t       crc  = 0;
+    uint16_t       fill = 0;
+    bool           busy = false;
+    uint8_t        region;
+    uint32_t       err_code;
+
+    if ((m_slot_size == 0) || (m_regions == 0))
+    {
+        return NRF_ERROR_INVALID_STATE;
+    }
+    if (SST25_PAGE_SIZE + m_total > m_slot_size)
+    {
+        return NRF_ERROR_NO_MEM;
+    }
+    err_code   = m_prepared ? NRF_SUCCESS : slot_erase(slot);
+    m_prepared = false;
+    if (err_code != NRF_SUCCESS)
+    {
+        return err_code;
+    }
+    (void)SST25_Last_Error();
+
+    // Copy each page into m_page while the previous one programs.
+    for (region = 0; region < m_regions; region++)
+    {
+        uint8_t const * p_src = m_region_data[region];
+        uint16_t        left  = m_region_len[region];
+
+        while (left)
+        {
+            uint16_t n = (uint16_t)(SST25_PAGE_SIZE - fill);
+
+            if (n > left)
+            {
+                n = left;
+            }
+            crc    = SST_CRC32_Compute_Copy(&m_page[fill], p_src, n, &crc);
+            fill  += n;
+            p_src += n;
+            left  -= n;
+
+            if ((fill == SST25_PAGE_SIZE) || ((left == 0) && (region == m_regions - 1u)))
+            {
+                if (busy)
+                {
+                    err_code = Wait_Busy_Timeout(SST25_TIMEOUT_US(SST25_T_PP_MAX_US));
+                    if (err_code != NRF_SUCCESS)
+                    {
+                        return err_code;
+                    }
+                }
+                WREN();
+                Page_Program_Data(Dst, m_page, fill);
+                err_code = SST25_Last_Error();
+                if (err_code != NRF_SUCCESS)
+                {
+                    return err_code;
+                }
+                busy = true;
+                Dst += fill;
+                fill = 0;
+            }
+        }
+    }
+    err_code = Wait_Busy_Timeout(SST25_TIMEOUT_US(SST25_T_PP_MAX_US));
+    if (err_code != NRF_SUCCESS)
+    {
+        return err_code;
+    }
+
+    // Commit.
+    hdr.magic      = SNAPSHOT_MAGIC;
+    hdr.sequence   = m_have ? m_hdr[m_current].sequence + 1u : 1u;
+    hdr.length     = m_total;
+    hdr.layout     = layout_crc();
+    hdr.data_crc   = crc;
+    hdr.header_crc = header_crc(&hdr);
+
+    err_code = Page_Program_Data_Operation(slot_addr(slot), (const unsigned char *)&hdr, sizeof(hdr));
+    if (err_code != NRF_SUCCESS)
+    {
+        m_hdr_valid[slot] = false;
+        return err_code;
+    }
+    m_hdr[slot]       = hdr;
+    m_hdr_valid[slot] = true;
+    m_have            = true;
+    m_current         = slot;
+    return NRF_SUCCESS;
+}
+
+uint32_t SST_Snapshot_Restore(void)
+{
+    uint32_t layout  = layout_crc();
+    bool     damaged = false;
+    uint8_t  order[2];
+    uint8_t  i;
+
+    if ((m_slot_size == 0) || !m_have)
+    {
+        return NRF_ERROR_NOT_FOUND;
+    }
+    order[0] = m_current;
+    order[1] = (uint8_t)(1u - m_current);
+
+    for (i = 0; i < 2; i++)
+    {
+        uint8_t       slot = order[i];
+        unsigned long Dst  = slot_addr(slot) + SST25_PAGE_SIZE;
+        uint32_t      crc  = 0;
+        uint8_t       region;
+
+        if (!m_hdr_valid[slot] || (m_hdr[slot].layout != layout) || (m_hdr[slot].length != m_total))
+        {
+            continue;
+        }
+        for (region = 0; region < m_regions; region++)
+        {
+            crc  = HighSpeed_Read_Data_CRC(Dst, m_region_data[region], m_region_len[region], &crc);
+            Dst += m_region_len[region];
+        }
+        if (crc == m_hdr[slot].data_crc)
+        {
+            m_current  = slot;
+            m_prepared = false;
+            return NRF_SUCCESS;
+        }
+        m_hdr_valid[slot] = false;
+        damaged           = true;
+    }
+    return damaged ? NRF_ERROR_INVALID_DATA : NRF_ERROR_NOT_FOUND;
+}
+
+uint32_t SST_Snapshot_Prepare(void)
+{
+    uint32_t err_code;
+
+    if ((m_slot_size == 0) || (m_regions == 0) || m_prepared)
+    {
+        return NRF_SUCCESS;
+    }
+    err_code   = slot_erase(next_slot());
+    m_prepared = (err_code == NRF_SUCCESS);
+    return err_code;
+}
+
+uint32_t SST_Snapshot_Sequence(void)
+{
+    return m_have ? m_hdr[m_current].sequence : 0;
+}
@@ -0,0 +1,81 @@
+/**@file
+ * @brief RAM state snapshots in the SST25VF064C for fast warm starts.
+ *
+ * The application registers the RAM regions that make up its state once at
+ * start-up. SST_Snapshot_Save copies them, back to back, into one of two
+ * flash slots with page programs, the CRC-32 of each page being computed
+ * while the previous one programs. The slot header (sequence number, length,
+ * region layout, data CRC) is programmed last, so a snapshot interrupted by
+ * a reset has no valid header and SST_Snapshot_Restore falls back to the
+ * snapshot in the other slot.
+ *
+ * Restore reads every region straight into RAM with HighSpeed_Read_Data_CRC,
+ * about 1 ms per KByte at 8 MHz SCK. Call SST_Snapshot_Prepare when idle
+ * after a restore or save: it erases the slot the next snapshot goes into,
+ * so SST_Snapshot_Save (e.g. from a low battery warning) only programs.
+ *
+ * Slot layout: page 0 holds the header, the region data starts at page 1.
+ */
+
+#ifndef SST25VF064C_SNAPSHOT_H__
+#define SST25VF064C_SNAPSHOT_H__
+
+#include <stdint.h>
+#include "SST25VF064C.h"
+
+#ifndef SST_SNAPSHOT_REGIONS
+#define SST_SNAPSHOT_REGIONS    8u      /**< Maximum number of registered RAM regions. */
+#endif
+
+/**@brief Set up the two slots and read their headers.
+ *
+ * Slot A is at base, slot B at base + slot_size. Registered regions are kept.
+ *
+ * @retval NRF_SUCCESS              Slots set up.
+ * @retval NRF_ERROR_INVALID_PARAM  base or slot_size not sector aligned, or the slots exceed the device.
+ */
+uint32_t SST_Snapshot_Init(unsigned long base, unsigned long slot_size);
+
+/**@brief Add a RAM region to the snapshot. Regions are saved in registration order.
+ *
+ * @retval NRF_SUCCESS              Region added.
+ * @retval NRF_ERROR_NO_MEM         SST_SNAPSHOT_REGIONS regions registered already.
+ * @retval NRF_ERROR_INVALID_PARAM  Region of length 0.
+ */
+uint32_t SST_Snapshot_Register(void * p_data, uint16_t len);
+
+/**@brief Save all registered regions into the older slot.
+ *
+ * The slot is erased first unless SST_Snapshot_Prepare has done so.
+ *
+ * @retval NRF_SUCCESS              Snapshot saved and valid.
+ * @retval NRF_ERROR_INVALID_STATE  No region registered, or SST_Snapshot_Init not called.
+ * @retval NRF_ERROR_NO_MEM         Regions do not fit a slot.
+ * @retval NRF_ERROR_INVALID_DATA   Program-verify of the header failed.
+ * @return Any other error of a failed erase, program or busy wait; the slot
+ *         keeps no valid header and the current snapshot stays in place.
+ */
+uint32_t SST_Snapshot_Save(void);
+
+/**@brief Load the newest valid snapshot into the registered regions.
+ *
+ * A snapshot only matches when it was saved with the same region count and
+ * lengths. If the newest one fails its CRC the other slot is tried.
+ *
+ * @retval NRF_SUCCESS              Regions restored.
+ * @retval NRF_ERROR_NOT_FOUND      No snapshot with a matching layout, regions untouched.
+ * @retval NRF_ERROR_INVALID_DATA   Snapshots found but corrupted, region contents undefined.
+ */
+uint32_t SST_Snapshot_Restore(void);
+
+/**@brief Erase the slot the next SST_Snapshot_Save will use. Takes n * tSE.
+ *
+ * @return NRF_SUCCESS, or the status of the failed sector erase. Save then
+ *         erases the slot again.
+ */
+uint32_t SST_Snapshot_Prepare(void);
+
+/**@brief Sequence number of the current snapshot, 0 if there is none. */
+uint32_t SST_Snapshot_Sequence(void);
+
+#endif /* SST25VF064C_SNAPSHOT_H__ */
@@ -0,0 +1,208 @@
+/**@file
+ * @brief Linux spidev transport (SST25_TRANSPORT_SPIDEV), see SST25VF064C_transport.h.
+ *
+ * The transfers of one chip select assertion are appended to one buffer
+ * and clocked as a single spi_ioc_transfer when the chip select is
+ * released, so a command costs one ioctl whatever number of segments the
+ * driver builds it from.
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <fcntl.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <linux/spi/spidev.h>
+#include "SST25VF064C_transport.h"
+
+#ifndef SST25_SPIDEV_COPIES
+#define SST25_SPIDEV_COPIES 8u      /**< Receive buffers per message. */
+#endif
+
+/* Received bytes to hand back when the message is done. */
+typedef struct
+{
+    uint8_t * p_rx;
+    uint16_t  offset;
+    uint16_t  len;
+} rx_copy_t;
+
+static int       m_fd = -1;
+static uint32_t  m_hz = 1000000ul;
+static bool      m_selected;
+static uint16_t  m_fill;
+static uint8_t   m_copies;
+static uint32_t  m_error;           /* first failed message of the assertion */
+static rx_copy_t m_copy[SST25_SPIDEV_COPIES];
+static uint8_t   m_tx[SST25_SPIDEV_BUFSIZ];
+static uint8_t   m_rx[SST25_SPIDEV_BUFSIZ];
+
+/* Clocks the collected bytes; keep leaves the chip select asserted. */
+static void flush(bool keep)
+{
+    struct spi_ioc_transfer xfer;
+    uint8_t                 i;
+
+    if (m_fill == 0)
+    {
+        return;
+    }
+    memset(&xfer, 0, sizeof(xfer));
+    xfer.tx_buf        = (unsigned long)m_tx;
+    xfer.rx_buf        = (unsigned long)m_rx;
+    xfer.len           = m_fill;
+    xfer.speed_hz      = m_hz;
+    xfer.bits_per_word = 8;
+    xfer.cs_change     = keep ? 1 : 0;
+
+    if (ioctl(m_fd, SPI_IOC_MESSAGE(1), &xfer) < 0)
+    {
+        if (m_error == NRF_SUCCESS)
+        {
+            m_error = NRF_ERROR_INTERNAL;
+        }
+    }
+    else
+    {
+        for (i = 0; i < m_copies; i++)
+        {
+            memcpy(m_copy[i].p_rx, &m_rx[m_copy[i].offset], m_copy[i].len);
+        }
+    }
+    m_fill   = 0;
+    m_copies = 0;
+}
+
+uint32_t SST25_Transport_Open(const char * p_path)
+{
+    uint8_t  mode = SPI_MODE_0;
+    uint8_t  bits = 8;
+
+    SST25_Transport_Close();
+    m_fd = open(p_path, O_RDWR);
+    if (m_fd < 0)
+    {
+        return NRF_ERROR_NOT_FOUND;
+    }
+    if ((ioctl(m_fd, SPI_IOC_WR_MODE, &mode) < 0) ||
+        (ioctl(m_fd, SPI_IOC_WR_BITS_PER_WORD, &bits) < 0) ||
+        (ioctl(m_fd, SPI_IOC_WR_MAX_SPEED_HZ, &m_hz) < 0))
+    {
+        SST25_Transport_Close();
+        return NRF_ERROR_INTERNAL;
+    }
+    m_selected = false;
+    m_fill     = 0;
+    m_copies   = 0;
+    m_error    = NRF_SUCCESS;
+    return NRF_SUCCESS;
+}
+
+void SST25_Transport_Close(void)
+{
+    if (m_fd >= 0)
+    {
+        (void)close(m_fd);
+        m_fd = -1;
+    }
+}
+
+void sst25_transport_clock(unsigned long hz)
+{
+    uint32_t max_hz = (uint32_t)hz;
+
+    m_hz = (uint32_t)hz;
+    if (m_fd >= 0)
+    {
+        (void)ioctl(m_fd, SPI_IOC_WR_MAX_SPEED_HZ, &max_hz);
+    }
+}
+
+uint32_t sst25_transport_xfer(uint8_t const * p_tx_data, uint16_t tx_len, uint8_t * p_rx_data, uint16_t rx_len)
+{
+    uint16_t len = (tx_len > rx_len) ? tx_len : rx_len;
+    uint16_t i   = 0;
+
+    if (m_fd < 0)
+    {
+        return NRF_ERROR_INTERNAL;
+    }
+    if (!m_selected)
+    {
+        (void)sst25_transport_select(true);
+        (void)sst25_transport_xfer(p_tx_data, tx_len, p_rx_data, rx_len);
+        return sst25_transport_select(false);
+    }
+
+    while (i < len)
+    {
+        uint16_t n = len - i;
+
+        if ((m_fill == SST25_SPIDEV_BUFSIZ) || ((i < rx_len) && (m_copies == SST25_SPIDEV_COPIES)))
+        {
+            flush(true);
+        }
+        if (n > SST25_SPIDEV_BUFSIZ - m_fill)
+        {
+            n = SST25_SPIDEV_BUFSIZ - m_fill;
+        }
+
+        if (i < tx_len)
+        {
+            uint16_t k = ((tx_len - i) < n) ? (tx_len - i) : n;
+
+            memcpy(&m_tx[m_fill], &p_tx_data[i], k);
+            memset(&m_tx[m_fill + k], 0xFF, n - k);
+        }
+        else
+        {
+            memset(&m_tx[m_fill], 0xFF, n);
+        }
+        if (i < rx_len)
+        {
+            m_copy[m_copies].p_rx   = &p_rx_data[i];
+            m_copy[m_copies].offset = m_fill;
+            m_copy[m_copies].len    = ((rx_len - i) < n) ? (rx_len - i) : n;
+            m_copies++;
+        }
+        m_fill += n;
+        i      += n;
+    }
+    return NRF_SUCCESS;
+}
+
+uint32_t sst25_transport_select(bool active)
+{
+    uint32_t err_code = NRF_SUCCESS;
+
+    if (active)
+    {
+        m_selected = true;
+        m_error    = NRF_SUCCESS;
+    }
+    else if (m_selected)
+    {
+        flush(false);
+        m_selected = false;
+        err_code   = m_error;
+    }
+    return err_code;
+}
+
+void sst25_transport_pin(uint8_t pin, bool high)
+{
+    // No RST#/HOLD# or WP# line on spidev, the board ties them high.
+    (void)pin;
+    (void)high;
+}
+
+void sst25_transport_delay_us(unsigned long us)
+{
+    struct timespec ts;
+
+    ts.tv_sec  = (time_t)(us / 1000000ul);
+    ts.tv_nsec = (long)(us % 1000000ul) * 1000l;
+    (void)nanosleep(&ts, NULL);
+}
@@ -0,0 +1,158 @@
+/**@file
+ * @brief SPI transaction trace recorder, see SST25VF064C_trace.h.
+ */
+
+#include <string.h>
+#include "SST25VF064C_trace.h"
+#include "SST25VF064C_put.h"
+
+#define TRACE_MASK      (SST_TRACE_RECORDS - 1u)
+#define OP_RDSR         0x05u
+
+static sst_trace_rec_t  m_ring[SST_TRACE_RECORDS];
+static uint16_t         m_head;         /* records written, wraps */
+static uint16_t         m_count;        /* valid records, at most SST_TRACE_RECORDS */
+static uint32_t         m_lost;         /* records overwritten before a dump */
+static bool             m_enabled;
+static sst_trace_time_t m_time_fn;
+static uint32_t         m_tick_hz;
+
+/* Commands after which the device is busy, so RDSR is a busy poll. */
+static bool op_sets_busy(uint8_t op)
+{
+    switch (op)
+    {
+        case 0x01:  // WRSR
+        case 0x02:  // Page-Program
+        case 0x20:  // Sector-Erase
+        case 0x52:  // Block-Erase 32K
+        case 0xD8:  // Block-Erase 64K
+        case 0x60:  // Chip-Erase
+        case 0xC7:  // Chip-Erase
+        case 0xAD:  // AAI-Word-Program
+        case 0xA5:  // Program SID
+        case 0x85:  // Lockout SID
+            return true;
+
+        default:
+            return false;
+    }
+}
+
+void SST_Trace_Init(sst_trace_time_t time_fn, uint32_t tick_hz)
+{
+    m_time_fn = time_fn;
+    m_tick_hz = tick_hz;
+    m_head    = 0;
+    m_count   = 0;
+    m_lost    = 0;
+    m_enabled = true;
+}
+
+void SST_Trace_Enable(bool enable)
+{
+    m_enabled = enable;
+}
+
+uint32_t SST_Trace_Time(void)
+{
+    return (m_time_fn != NULL) ? m_time_fn() : 0;
+}
+
+void SST_Trace_Transfer(uint8_t const * p_tx_data, uint16_t tx_len, uint16_t rx_len, uint32_t t_start)
+{
+    sst_trace_rec_t * p_last;
+    uint16_t          len = (tx_len > rx_len) ? tx_len : rx_len;
+    uint8_t           op;
+
+    if (!m_enabled)
+    {
+        return;
+    }
+
+    p_last = (m_count != 0) ? &m_ring[(uint16_t)(m_head - 1u) & TRACE_MASK] : NULL;
+    op     = ((p_tx_data != NULL) && (tx_len != 0)) ? p_tx_data[0] : SST_TRACE_OP_NONE;
+
+    if ((p_last != NULL) &&
+        ((op == SST_TRACE_OP_NONE) || ((op == OP_RDSR) && op_sets_busy((uint8_t)(p_last->op_addr >> 24)))))
+    {
+        // Continuation or busy poll of the last command.
+        if (op == SST_TRACE_OP_NONE)
+        {
+            p_last->length += len;
+        }
+        else if (p_last->polls != 0xFFFFu)
+        {
+            p_last->polls++;
+        }
+        p_last->t_end = SST_Trace_Time();
+        return;
+    }
+
+    if (m_count == SST_TRACE_RECORDS)
+    {
+        m_lost++;
+    }
+    else
+    {
+        m_count++;
+    }
+
+    p_last          = &m_ring[m_head & TRACE_MASK];
+    p_last->t_start = t_start;
+    p_last->t_end   = SST_Trace_Time();
+    p_last->op_addr = (uint32_t)op << 24;
+    if (tx_len >= 4)
+    {
+        p_last->op_addr |= ((uint32_t)p_tx_data[1] << 16) | ((uint32_t)p_tx_data[2] << 8) | p_tx_data[3];
+    }
+    p_last->length  = len;
+    p_last->polls   = 0;
+    m_head++;
+}
+
+uint16_t SST_Trace_Count(void)
+{
+    return m_count;
+}
+
+void SST_Trace_Dump(sst_trace_put_t put)
+{
+    bool     enabled = m_enabled;
+    uint16_t index   = (uint16_t)(m_head - m_count);
+
+    m_enabled = false;
+
+    sst_put_str(put, "SST25TRACE ");
+    sst_put_dec(put, SST_TRACE_VERSION);
+    put(' ');
+    sst_put_dec(put, m_tick_hz);
+    put(' ');
+    sst_put_dec(put, m_count);
+    put(' ');
+    sst_put_dec(put, m_lost);
+    sst_put_str(put, "\r\n");
+
+    while (m_count)
+    {
+        const sst_trace_rec_t * p_rec = &m_ring[index++ & TRACE_MASK];
+
+        sst_put_hex(put, p_rec->op_addr >> 24, 2);
+        put(' ');
+        sst_put_hex(put, p_rec->op_addr & 0xFFFFFFu, 6);
+        put(' ');
+        sst_put_dec(put, p_rec->length);
+        put(' ');
+        sst_put_hex(put, p_rec->t_start, 8);
+        put(' ');
+        sst_put_hex(put, p_rec->t_end, 8);
+        put(' ');
+        sst_put_dec(put, p_rec->polls);
+        sst_put_str(put, "\r\n");
+        m_count--;
+    }
+    sst_put_str(put, "END\r\n");
+
+    m_lost    = 0;
+    m_enabled = enabled;
+}
@@ -0,0 +1,86 @@
+/**@file
+ * @brief SPI transaction trace recorder for the SST25VF064C driver.
+ *
+ * Build the driver with SST25_TRACE defined and add SST25VF064C_trace.c to
+ * the project. Every SPI_Bus_Transfer is then recorded into a RAM ring of
+ * SST_TRACE_RECORDS entries (16 bytes each): opcode, address, bytes on the
+ * bus, start and end timestamp. Status register reads following a program,
+ * erase or status write are folded into that record as busy polls, and the
+ * continuation transfers of a command spanning several transfers (hold
+ * reads with SST25_MANUAL_CS) extend the record of the command. When the
+ * ring is full the oldest records are overwritten and counted as lost.
+ *
+ * SST_Trace_Dump writes the ring as text through a byte output function,
+ * e.g. simple_uart_put. tools/trace_replay.c reads such a dump, replays it
+ * against the simulator and prints per-opcode time breakdowns and a
+ * timeline.
+ *
+ * Dump format, numbers in hex unless noted:
+ *   SST25TRACE 1 <tick_hz dec> <records dec> <lost dec>
+ *   <opcode> <address> <length dec> <t_start> <t_end> <polls dec>
+ *   ...
+ *   END
+ */
+
+#ifndef SST25VF064C_TRACE_H__
+#define SST25VF064C_TRACE_H__
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#ifndef SST_TRACE_RECORDS
+#define SST_TRACE_RECORDS   128u    /**< Ring entries, power of two. */
+#endif
+
+#define SST_TRACE_VERSION   1u      /**< Dump format version. */
+#define SST_TRACE_OP_NONE   0x00u   /**< Opcode of a record without command byte. */
+
+/**@brief One recorded command. */
+typedef struct
+{
+    uint32_t t_start;               /**< Timestamp before the first byte. */
+    uint32_t t_end;                 /**< Timestamp after the last transfer or busy poll. */
+    uint32_t op_addr;               /**< Opcode in bits 31..24, address in bits 23..0. */
+    uint16_t length;                /**< Bytes clocked on the bus, command included. */
+    uint16_t polls;                 /**< Status register reads folded into the record. */
+} sst_trace_rec_t;
+
+/**@brief Timestamp source, free running, wrapping at 2^32. */
+typedef uint32_t (*sst_trace_time_t)(void);
+
+/**@brief Byte output for SST_Trace_Dump. */
+typedef void (*sst_trace_put_t)(uint8_t byte);
+
+/**@brief Empty the ring and start recording.
+ *
+ * @param[in] time_fn  Timestamp source, e.g. a TIMER capture or RTC counter.
+ * @param[in] tick_hz  Rate of time_fn, stored in the dump header.
+ */
+void SST_Trace_Init(sst_trace_time_t time_fn, uint32_t tick_hz);
+
+/**@brief Pause or resume recording. */
+void SST_Trace_Enable(bool enable);
+
+/**@brief Current timestamp, 0 before SST_Trace_Init. */
+uint32_t SST_Trace_Time(void);
+
+/**@brief Record one SPI transfer. Called by SPI_Bus_Transfer.
+ *
+ * @param[in] p_tx_data  Bytes sent, the first one is the opcode. NULL for a
+ *                       continuation of the last command.
+ * @param[in] tx_len     Bytes sent, 0 for a continuation of the last command.
+ * @param[in] rx_len     Bytes clocked in.
+ * @param[in] t_start    SST_Trace_Time() taken before the transfer started.
+ */
+void SST_Trace_Transfer(uint8_t const * p_tx_data, uint16_t tx_len, uint16_t rx_len, uint32_t t_start);
+
+/**@brief Number of records in the ring. */
+uint16_t SST_Trace_Count(void);
+
+/**@brief Write the ring, oldest record first, and empty it.
+ *
+ * Recording is paused during the dump.
+ */
+void SST_Trace_Dump(sst_trace_put_t put);
+
+#endif /* SST25VF064C_TRACE_H__ */
@@ -0,0 +1,88 @@
+/**@file
+ * @brief Host transports: SST25VF064C.c on a Linux spidev device or an image file.
+ *
+ * Below its command procedures the driver needs a few bus operations: run a
+ * transfer, assert and release the chip select, drive RST#/HOLD# and WP#,
+ * set the clock and wait. On the nRF51 they are the SDK spi_master or the
+ * SST25_SPI_DIRECT engine, both part of SST25VF064C.c. Defining one of
+ *
+ *   SST25_TRANSPORT_SPIDEV  SST25VF064C_spidev.c, a real chip on a Linux
+ *                           spidev device (e.g. /dev/spidev0.0), mode 0,
+ *   SST25_TRANSPORT_MMAP    SST25VF064C_mmap.c, an image file of
+ *                           SST25_CAPACITY bytes mapped into memory,
+ *
+ * builds the driver for a host instead, with the operations below. The
+ * driver, SST25VF064C_device.c, SST25VF064C_crc32.c and the storage
+ * modules are compiled unchanged, so images can be built, patched or
+ * checked on a PC with the same code that runs on the target:
+ *
+ *     cc -O2 -DSST25_TRANSPORT_MMAP -I. -o tool tool.c SST25VF064C.c SST25VF064C_mmap.c \
+ *         SST25VF064C_device.c SST25VF064C_crc32.c ...
+ *
+ * Both transports are synchronous, like SST25_SPI_DIRECT: SST25_MANUAL_CS is
+ * implied and HighSpeed_Read_Async completes before it returns.
+ *
+ * The spidev transport collects the transfers of one chip select assertion
+ * and sends them as one spidev message when the chip select is released, so
+ * data clocked in is only valid after CE_High. More than SST25_SPIDEV_BUFSIZ
+ * bytes under one assertion go out as several messages that rely on the
+ * controller honouring cs_change. There is no RST#/HOLD# or WP# line, so
+ * HighSpeed_Read_Hold cannot lend the bus out and SST25_Recover only resets
+ * parts with the reset commands (SST26).
+ *
+ * The mmap transport decodes the commands of the compile-time part (reads,
+ * Page-Program, erases, status register, IDs, Security ID) against the
+ * mapping with NOR semantics. The device is never busy and waits return at
+ * once; block protection is not modelled.
+ */
+
+#ifndef SST25VF064C_TRANSPORT_H__
+#define SST25VF064C_TRANSPORT_H__
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "SST25VF064C.h"
+
+#define SST25_TRANSPORT_PIN_RESET_HOLD  0u  /**< RST#/HOLD#. */
+#define SST25_TRANSPORT_PIN_WP          1u  /**< WP#. */
+
+/**@brief Open the transport, before SST25VF064C_init.
+ *
+ * @param[in] p_path  spidev device, or image file. A missing image is
+ *                    created erased, a shorter one is extended with 0xFF.
+ *
+ * @retval NRF_SUCCESS           Ready.
+ * @retval NRF_ERROR_NOT_FOUND   p_path cannot be opened.
+ * @retval NRF_ERROR_INTERNAL    Device setup or mapping failed.
+ */
+uint32_t SST25_Transport_Open(const char * p_path);
+
+/**@brief Close the transport; the image file is written back first. */
+void SST25_Transport_Close(void);
+
+/**@brief Set the SCK frequency in Hz. */
+void sst25_transport_clock(unsigned long hz);
+
+/**@brief Run one transfer, see SPI_Bus_Transfer.
+ *
+ * Bytes beyond tx_len are sent as 0xFF. Outside a chip select assertion
+ * the transfer is a transaction of its own.
+ *
+ * @return NRF_SUCCESS, or NRF_ERROR_INTERNAL if the device refused it.
+ */
+uint32_t sst25_transport_xfer(uint8_t const * p_tx_data, uint16_t tx_len, uint8_t * p_rx_data, uint16_t rx_len);
+
+/**@brief Assert (true) or release (false) the chip select.
+ *
+ * @return NRF_SUCCESS, or NRF_ERROR_INTERNAL if transfers collected under
+ *         the assertion failed.
+ */
+uint32_t sst25_transport_select(bool active);
+
+/**@brief Drive SST25_TRANSPORT_PIN_RESET_HOLD or SST25_TRANSPORT_PIN_WP. */
+void sst25_transport_pin(uint8_t pin, bool high);
+
+/**@brief Wait at least us microseconds. */
+void sst25_transport_delay_us(unsigned long us);
+
+#endif /* SST25VF064C_TRANSPORT_H__ */
@@ -0,0 +1,667 @@
+/**@file
+ * @brief Atomic multi-page transactions, see SST25VF064C_txn.h.
+ */
+
+#include <stddef.h>
+#include <string.h>
+#include "SST25VF064C_txn.h"
+#include "SST25VF064C_crc32.h"
+
+#if (SST_TXN_PAGES == 0) || (SST_TXN_PAGES > 2u * SST_TXN_ENTRIES) || (SST_TXN_JOURNAL < 2u) || \
+    (SST_TXN_WRITES == 0) || (SST_TXN_WRITES > SST_TXN_ENTRIES) || (SST_TXN_GROUP == 0) || (SST_TXN_GROUP > 255u)
+#error "SST_TXN_PAGES, SST_TXN_WRITES, SST_TXN_GROUP or SST_TXN_JOURNAL out of range"
+#endif
+
+#define RECORD_MAGIC    0x4A4E5854ul    /* "TXNJ" */
+#define RECORD_COMMIT   1u              /* entry[] holds count (logical, physical) page pairs */
+#define RECORD_MAP      2u              /* entry[] holds the physical page of every logical page */
+
+#define SECTOR_PAGES    (SST25_SECTOR_SIZE / SST25_PAGE_SIZE)
+#define UNMAPPED        0xFFFFu         /* logical page never written */
+#define NO_SECTOR       0xFFFFu
+
+#define TXN_OPEN        1u
+#define TXN_QUEUED      2u
+
+/* Journal record, one per page. */
+typedef struct
+{
+    uint32_t magic;
+    uint32_t sequence;                  /* incremented per record, wraps */
+    uint16_t type;
+    uint16_t count;
+    uint32_t crc;                       /* CRC-32 of the fields above and the used entries */
+    uint16_t entry[2u * SST_TXN_ENTRIES];
+} record_t;
+
+sst_txn_stats_t sst_txn_stats;
+
+static unsigned long m_base;
+static unsigned long m_data_base;
+static uint16_t      m_data_sectors;    /* 0 before SST_Txn_Init */
+static uint16_t      m_map[SST_TXN_PAGES];      /* committed physical page of each logical page */
+static uint16_t      m_jsector;         /* journal sector of the newest checkpoint */
+static uint16_t      m_jpos;            /* next free page in it */
+static uint32_t      m_sequence;        /* of the next record */
+static uint16_t      m_head = NO_SECTOR;    /* data sector being filled */
+static uint16_t      m_head_pos;        /* next free page in it */
+
+static sst_txn_t *   m_active;          /* open and queued transactions */
+static sst_txn_t *   m_group[SST_TXN_GROUP];    /* queued, in commit order */
+static uint8_t       m_queued;
+static uint16_t      m_group_entries;   /* pages changed by the queued transactions */
+static uint16_t      m_shadows;         /* shadow pages held by m_active */
+
+static union
+{
+    record_t record;
+    uint8_t  bytes[SST25_PAGE_SIZE];
+} m_rec;
+
+static uint8_t m_page[SST25_PAGE_SIZE];
+
+static unsigned long journal_addr(uint16_t sector, uint16_t page)
+{
+    return m_base + (unsigned long)sector * SST25_SECTOR_SIZE + (unsigned long)page * SST25_PAGE_SIZE;
+}
+
+static unsigned long data_addr(uint16_t ppage)
+{
+    return m_data_base + (unsigned long)ppage * SST25_PAGE_SIZE;
+}
+
+static uint16_t record_words(record_t const * p_rec)
+{
+    return (p_rec->type == RECORD_COMMIT) ? (uint16_t)(2u * p_rec->count) : p_rec->count;
+}
+
+static uint32_t record_crc(record_t const * p_rec)
+{
+    uint32_t crc = SST_CRC32_Compute((uint8_t const *)p_rec, offsetof(record_t, crc), NULL);
+
+    return SST_CRC32_Compute((uint8_t const *)p_rec->entry, record_words(p_rec) * sizeof(p_rec->entry[0]), &crc);
+}
+
+static bool record_valid(void)
+{
+    record_t const * p_rec = &m_rec.record;
+
+    return (p_rec->magic == RECORD_MAGIC) &&
+           (((p_rec->type == RECORD_COMMIT) && (p_rec->count <= SST_TXN_ENTRIES)) ||
+            ((p_rec->type == RECORD_MAP) && (p_rec->count == SST_TXN_PAGES))) &&
+           (p_rec->crc == record_crc(p_rec));
+}
+
+static bool record_blank(void)
+{
+    uint16_t i;
+
+    for (i = 0; i < SST25_PAGE_SIZE; i++)
+    {
+        if (m_rec.bytes[i] != 0xFF)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+/* Programs m_rec with the given entries into a journal page. The sequence
+ * number is used up even on failure: the outcome of the program is unknown. */
+static uint32_t record_program(uint16_t sector, uint16_t page, uint16_t type, uint16_t count)
+{
+    record_t * p_rec = &m_rec.record;
+
+    p_rec->magic    = RECORD_MAGIC;
+    p_rec->sequence = m_sequence++;
+    p_rec->type     = type;
+    p_rec->count    = count;
+    p_rec->crc      = record_crc(p_rec);
+
+    return Page_Program_Data_Operation(journal_addr(sector, page), m_rec.bytes,
+                                       (unsigned short)(offsetof(record_t, entry) + record_words(p_rec) * sizeof(p_rec->entry[0])));
+}
+
+/* Makes room for one record. A full journal sector is left for the next one,
+ * which is erased and starts with a checkpoint of the map; the old sector
+ * stays the valid one until the checkpoint is programmed. */
+static uint32_t journal_reserve(void)
+{
+    uint16_t sector = (uint16_t)((m_jsector + 1u) % SST_TXN_JOURNAL);
+    uint32_t err_code;
+
+    if (m_jpos < SECTOR_PAGES)
+    {
+        return NRF_SUCCESS;
+    }
+    err_code = Sector_Erase_Operation(journal_addr(sector, 0));
+    sst_txn_stats.erases++;
+    if (err_code == NRF_SUCCESS)
+    {
+        memcpy(m_rec.record.entry, m_map, sizeof(m_map));
+        err_code = record_program(sector, 0, RECORD_MAP, SST_TXN_PAGES);
+    }
+    if (err_code == NRF_SUCCESS)
+    {
+        m_jsector = sector;
+        m_jpos    = 1;
+    }
+    return err_code;
+}
+
+/* Programs the commit record with count entries filled in after
+ * journal_reserve. After a failure the journal moves on to a checkpoint of
+ * the map, so a record whose program did complete cannot apply later. */
+static uint32_t journal_commit(uint16_t count)
+{
+    uint32_t err_code = record_program(m_jsector, m_jpos++, RECORD_COMMIT, count);
+
+    if (err_code != NRF_SUCCESS)
+    {
+        m_jpos = SECTOR_PAGES;
+        (void)journal_reserve();
+        return err_code;
+    }
+    sst_txn_stats.commits++;
+    return NRF_SUCCESS;
+}
+
+static bool txn_active(sst_txn_t const * p_txn)
+{
+    sst_txn_t const * p_item;
+
+    for (p_item = m_active; p_item != NULL; p_item = p_item->p_next)
+    {
+        if (p_item == p_txn)
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+static void txn_unlink(sst_txn_t * p_txn)
+{
+    sst_txn_t ** pp_item = &m_active;
+
+    while (*pp_item != NULL)
+    {
+        if (*pp_item == p_txn)
+        {
+            *pp_item = p_txn->p_next;
+            m_shadows -= p_txn->count;
+            return;
+        }
+        pp_item = &(*pp_item)->p_next;
+    }
+}
+
+/* Committed and shadow pages in a data sector. */
+static uint16_t sector_live(uint16_t sector)
+{
+    sst_txn_t const * p_txn;
+    uint16_t          live = 0;
+    uint16_t          i;
+
+    for (i = 0; i < SST_TXN_PAGES; i++)
+    {
+        live += ((m_map[i] / SECTOR_PAGES) == sector);
+    }
+    for (p_txn = m_active; p_txn != NULL; p_txn = p_txn->p_next)
+    {
+        for (i = 0; i < p_txn->count; i++)
+        {
+            live += ((p_txn->ppage[i] / SECTOR_PAGES) == sector);
+        }
+    }
+    return live;
+}
+
+/* Copies a data page to the next page of the head sector, *p_ppage follows on success. */
+static uint32_t page_copy(uint16_t * p_ppage)
+{
+    uint16_t dst = (uint16_t)(m_head * SECTOR_PAGES + m_head_pos++);
+    uint32_t err_code;
+
+    HighSpeed_Read_Data(data_addr(*p_ppage), m_page, SST25_PAGE_SIZE);
+    sst_txn_stats.pages_written++;
+    sst_txn_stats.relocations++;
+    err_code = Page_Program_Data_Operation(data_addr(dst), m_page, SST25_PAGE_SIZE);
+    if (err_code == NRF_SUCCESS)
+    {
+        *p_ppage = dst;
+    }
+    return err_code;
+}
+
+/* Moves the live pages of the sector with the fewest into the freshly
+ * erased head sector. Committed pages change place through a commit record
+ * of their own, shadow pages are not durable and just move. */
+static uint32_t compact(void)
+{
+    uint16_t    victim = NO_SECTOR;
+    uint16_t    fewest = SECTOR_PAGES;
+    uint16_t    lpage[SECTOR_PAGES];
+    uint16_t    ppage[SECTOR_PAGES];
+    uint16_t    moved = 0;
+    sst_txn_t * p_txn;
+    uint16_t    i;
+    uint32_t    err_code;
+
+    for (i = 0; i < m_data_sectors; i++)
+    {
+        uint16_t live = (i == m_head) ? SECTOR_PAGES : sector_live(i);
+
+        if (live < fewest)
+        {
+            fewest = live;
+            victim = i;
+        }
+    }
+    if (victim == NO_SECTOR)
+    {
+        return NRF_ERROR_NO_MEM;
+    }
+
+    for (i = 0; i < SST_TXN_PAGES; i++)
+    {
+        if ((m_map[i] / SECTOR_PAGES) == victim)
+        {
+            lpage[moved] = i;
+            ppage[moved] = m_map[i];
+            err_code     = page_copy(&ppage[moved++]);
+            if (err_code != NRF_SUCCESS)
+            {
+                return err_code;
+            }
+        }
+    }
+    for (p_txn = m_active; p_txn != NULL; p_txn = p_txn->p_next)
+    {
+        for (i = 0; i < p_txn->count; i++)
+        {
+            if ((p_txn->ppage[i] / SECTOR_PAGES) == victim)
+            {
+                err_code = page_copy(&p_txn->ppage[i]);
+                if (err_code != NRF_SUCCESS)
+                {
+                    return err_code;
+                }
+            }
+        }
+    }
+    if (moved == 0)
+    {
+        return NRF_SUCCESS;
+    }
+
+    err_code = journal_reserve();
+    if (err_code != NRF_SUCCESS)
+    {
+        return err_code;
+    }
+    for (i = 0; i < moved; i++)
+    {
+        m_rec.record.entry[2u * i]      = lpage[i];
+        m_rec.record.entry[2u * i + 1u] = ppage[i];
+    }
+    err_code = journal_commit(moved);
+    if (err_code != NRF_SUCCESS)
+    {
+        return err_code;
+    }
+    for (i = 0; i < moved; i++)
+    {
+        m_map[lpage[i]] = ppage[i];
+    }
+    return NRF_SUCCESS;
+}
+
+/* Next erased data page. A new head sector is taken from the sectors
+ * without live pages; the last of them is only taken to compact into. */
+static uint32_t page_alloc(uint16_t * p_ppage)
+{
+    uint32_t err_code;
+
+    while (m_head_pos == SECTOR_PAGES)
+    {
+        uint16_t free_sector = NO_SECTOR;
+        uint16_t free_count  = 0;
+        uint16_t sector;
+
+        for (sector = 0; sector < m_data_sectors; sector++)
+        {
+            if (sector_live(sector) == 0)
+            {
+                free_sector = sector;
+                free_count++;
+            }
+        }
+        if (free_count == 0)
+        {
+            return NRF_ERROR_NO_MEM;
+        }
+        err_code = Sector_Erase_Operation(data_addr((uint16_t)(free_sector * SECTOR_PAGES)));
+        sst_txn_stats.erases++;
+        if (err_code != NRF_SUCCESS)
+        {
+            return err_code;
+        }
+        m_head     = free_sector;
+        m_head_pos = 0;
+        if (free_count == 1)
+        {
+            err_code = compact();
+            if (err_code != NRF_SUCCESS)
+            {
+                m_head_pos = SECTOR_PAGES;      /* erase again and retry next time */
+                return err_code;
+            }
+        }
+    }
+    *p_ppage = (uint16_t)(m_head * SECTOR_PAGES + m_head_pos++);
+    return NRF_SUCCESS;
+}
+
+/* Writes part of one logical page into the transaction's shadow of it. */
+static uint32_t page_write(sst_txn_t * p_txn, uint16_t lpage, uint16_t offset, uint8_t const * p_data, uint16_t len)
+{
+    uint8_t  slot;
+    uint16_t ppage;
+    uint16_t src;
+    uint16_t i;
+    uint32_t err_code;
+
+    for (slot = 0; (slot < p_txn->count) && (p_txn->lpage[slot] != lpage); slot++)
+    {
+    }
+    if (slot < p_txn->count)
+    {
+        // Only 1 to 0 bit changes: program the shadow page in place.
+        HighSpeed_Read_Data(data_addr(p_txn->ppage[slot]) + offset, m_page, len);
+        for (i = 0; (i < len) && ((m_page[i] & p_data[i]) == p_data[i]); i++)
+        {
+        }
+        if (i == len)
+        {
+            return Page_Program_Data_Operation(data_addr(p_txn->ppage[slot]) + offset, p_data, len);
+        }
+    }
+    else if ((p_txn->count == SST_TXN_WRITES) || (m_shadows == SST_TXN_SHADOWS))
+    {
+        return NRF_ERROR_NO_MEM;
+    }
+
+    err_code = page_alloc(&ppage);
+    if (err_code != NRF_SUCCESS)
+    {
+        return err_code;
+    }
+    // Looked up after the allocation, compaction may have moved the page.
+    src = (slot < p_txn->count) ? p_txn->ppage[slot] : m_map[lpage];
+    if (src == UNMAPPED)
+    {
+        memset(m_page, 0xFF, sizeof(m_page));
+    }
+    else if (len != SST25_PAGE_SIZE)
+    {
+        HighSpeed_Read_Data(data_addr(src), m_page, SST25_PAGE_SIZE);
+    }
+    memcpy(&m_page[offset], p_data, len);
+    sst_txn_stats.pages_written++;
+    err_code = Page_Program_Data_Operation(data_addr(ppage), m_page, SST25_PAGE_SIZE);
+    if (err_code != NRF_SUCCESS)
+    {
+        return err_code;
+    }
+    if (slot == p_txn->count)
+    {
+        p_txn->lpage[slot] = lpage;
+        p_txn->count++;
+        m_shadows++;
+    }
+    p_txn->ppage[slot] = ppage;
+    return NRF_SUCCESS;
+}
+
+uint32_t SST_Txn_Init(unsigned long base, unsigned long size)
+{
+    unsigned long sectors = size / SST25_SECTOR_SIZE;
+    bool          have    = false;
+    uint16_t      sector;
+    uint16_t      i;
+    uint32_t      err_code;
+
+    if (((base % SST25_SECTOR_SIZE) != 0) || ((size % SST25_SECTOR_SIZE) != 0) ||
+        (sectors < SST_TXN_JOURNAL + SST_TXN_DATA_MIN) || ((sectors - SST_TXN_JOURNAL) * SECTOR_PAGES >= UNMAPPED) ||
+        !SST25_RANGE_VALID(base, size))
+    {
+        return NRF_ERROR_INVALID_PARAM;
+    }
+    m_base          = base;
+    m_data_base     = base + SST_TXN_JOURNAL * SST25_SECTOR_SIZE;
+    m_data_sectors  = 0;
+    m_head          = NO_SECTOR;
+    m_head_pos      = SECTOR_PAGES;
+    m_active        = NULL;
+    m_queued        = 0;
+    m_group_entries = 0;
+    m_shadows       = 0;
+
+    for (sector = 0; sector < SST_TXN_JOURNAL; sector++)
+    {
+        HighSpeed_Read_Data(journal_addr(sector, 0), m_rec.bytes, SST25_PAGE_SIZE);
+        if (record_valid() && (m_rec.record.type == RECORD_MAP) &&
+            (!have || ((int32_t)(m_rec.record.sequence - m_sequence) > 0)))
+        {
+            have        = true;
+            m_jsector   = sector;
+            m_sequence  = m_rec.record.sequence;
+            memcpy(m_map, m_rec.record.entry, sizeof(m_map));
+        }
+    }
+
+    if (!have)
+    {
+        memset(m_map, 0xFF, sizeof(m_map));
+        m_sequence = 0;
+        m_jsector  = SST_TXN_JOURNAL - 1u;
+        m_jpos     = SECTOR_PAGES;
+        err_code = journal_reserve();
+        if (err_code != NRF_SUCCESS)
+        {
+            return err_code;
+        }
+    }
+    else
+    {
+        // Apply the commit records behind the checkpoint up to the first
+        // blank page, skipping pages torn by a reset.
+        m_sequence++;
+        for (m_jpos = 1; m_jpos < SECTOR_PAGES; m_jpos++)
+        {
+            HighSpeed_Read_Data(journal_addr(m_jsector, m_jpos), m_rec.bytes, SST25_PAGE_SIZE);
+            if (record_blank())
+            {
+                break;
+            }
+            if (record_valid() && (m_rec.record.type == RECORD_COMMIT) &&
+                ((int32_t)(m_rec.record.sequence - m_sequence) >= 0))
+            {
+                for (i = 0; i < m_rec.record.count; i++)
+                {
+                    if (m_rec.record.entry[2u * i] >= SST_TXN_PAGES)
+                    {
+                        return NRF_ERROR_INVALID_DATA;
+                    }
+                    m_map[m_rec.record.entry[2u * i]] = m_rec.record.entry[2u * i + 1u];
+                }
+                m_sequence = m_rec.record.sequence + 1u;
+            }
+        }
+    }
+
+    for (i = 0; i < SST_TXN_PAGES; i++)
+    {
+        if ((m_map[i] != UNMAPPED) && (m_map[i] >= (sectors - SST_TXN_JOURNAL) * SECTOR_PAGES))
+        {
+            return NRF_ERROR_INVALID_DATA;
+        }
+    }
+    m_data_sectors = (uint16_t)(sectors - SST_TXN_JOURNAL);
+    return NRF_SUCCESS;
+}
+
+uint32_t SST_Txn_Begin(sst_txn_t * p_txn)
+{
+    if ((m_data_sectors == 0) || txn_active(p_txn))
+    {
+        return NRF_ERROR_INVALID_STATE;
+    }
+    p_txn->state  = TXN_OPEN;
+    p_txn->count  = 0;
+    p_txn->p_next = m_active;
+    m_active      = p_txn;
+    return NRF_SUCCESS;
+}
+
+uint32_t SST_Txn_Write(sst_txn_t * p_txn, unsigned long offset, const void * p_data, uint16_t len)
+{
+    uint8_t const * p_src = (uint8_t const *)p_data;
+    uint32_t        err_code;
+
+    if (!txn_active(p_txn) || (p_txn->state != TXN_OPEN))
+    {
+        return NRF_ERROR_INVALID_STATE;
+    }
+    if ((offset > SST_TXN_PAGES * SST25_PAGE_SIZE) || (len > SST_TXN_PAGES * SST25_PAGE_SIZE - offset))
+    {
+        return NRF_ERROR_INVALID_PARAM;
+    }
+    while (len != 0)
+    {
+        uint16_t page_offset = (uint16_t)(offset % SST25_PAGE_SIZE);
+        uint16_t n           = (uint16_t)(SST25_PAGE_SIZE - page_offset);
+
+        n        = (n > len) ? len : n;
+        err_code = page_write(p_txn, (uint16_t)(offset / SST25_PAGE_SIZE), page_offset, p_src, n);
+        if (err_code != NRF_SUCCESS)
+        {
+            return err_code;
+        }
+        offset += n;
+        p_src  += n;
+        len    -= n;
+    }
+    return NRF_SUCCESS;
+}
+
+uint32_t SST_Txn_Commit(sst_txn_t * p_txn)
+{
+    uint32_t err_code;
+
+    if (!txn_active(p_txn) || (p_txn->state != TXN_OPEN))
+    {
+        return NRF_ERROR_INVALID_STATE;
+    }
+    if ((m_queued == SST_TXN_GROUP) || (m_group_entries + p_txn->count > SST_TXN_ENTRIES))
+    {
+        err_code = SST_Txn_Flush();
+        if (err_code != NRF_SUCCESS)
+        {
+            return err_code;
+        }
+    }
+    p_txn->state        = TXN_QUEUED;
+    m_group[m_queued++] = p_txn;
+    m_group_entries    += p_txn->count;
+    return NRF_SUCCESS;
+}
+
+void SST_Txn_Abort(sst_txn_t * p_txn)
+{
+    if (txn_active(p_txn) && (p_txn->state == TXN_OPEN))
+    {
+        txn_unlink(p_txn);
+    }
+}
+
+uint32_t SST_Txn_Flush(void)
+{
+    uint16_t n = 0;
+    uint8_t  q;
+    uint8_t  i;
+    uint32_t err_code;
+
+    if (m_queued == 0)
+    {
+        return NRF_SUCCESS;
+    }
+    if (m_group_entries != 0)
+    {
+        err_code = journal_reserve();
+        if (err_code != NRF_SUCCESS)
+        {
+            return err_code;
+        }
+        for (q = 0; q < m_queued; q++)
+        {
+            for (i = 0; i < m_group[q]->count; i++, n++)
+            {
+                m_rec.record.entry[2u * n]      = m_group[q]->lpage[i];
+                m_rec.record.entry[2u * n + 1u] = m_group[q]->ppage[i];
+            }
+        }
+        err_code = journal_commit(n);
+        if (err_code != NRF_SUCCESS)
+        {
+            return err_code;
+        }
+    }
+
+    for (q = 0; q < m_queued; q++)
+    {
+        for (i = 0; i < m_group[q]->count; i++)
+        {
+            m_map[m_group[q]->lpage[i]] = m_group[q]->ppage[i];
+        }
+        txn_unlink(m_group[q]);
+    }
+    sst_txn_stats.transactions += m_queued;
+    m_queued        = 0;
+    m_group_entries = 0;
+    return NRF_SUCCESS;
+}
+
+uint32_t SST_Txn_Read(unsigned long offset, void * p_data, uint16_t len)
+{
+    uint8_t * p_dst = (uint8_t *)p_data;
+
+    if (m_data_sectors == 0)
+    {
+        return NRF_ERROR_INVALID_STATE;
+    }
+    if ((offset > SST_TXN_PAGES * SST25_PAGE_SIZE) || (len > SST_TXN_PAGES * SST25_PAGE_SIZE - offset))
+    {
+        return NRF_ERROR_INVALID_PARAM;
+    }
+    while (len != 0)
+    {
+        uint16_t ppage = m_map[offset / SST25_PAGE_SIZE];
+        uint16_t n     = (uint16_t)(SST25_PAGE_SIZE - (offset % SST25_PAGE_SIZE));
+
+        n = (n > len) ? len : n;
+        if (ppage == UNMAPPED)
+        {
+            memset(p_dst, 0xFF, n);
+        }
+        else
+        {
+            HighSpeed_Read_Data(data_addr(ppage) + (offset % SST25_PAGE_SIZE), p_dst, n);
+        }
+        offset += n;
+        p_dst  += n;
+        len    -= n;
+    }
+    return NRF_SUCCESS;
+}
@@ -0,0 +1,143 @@
+/**@file
+ * @brief Atomic multi-page transactions with a journal and group commit.
+ *
+ * The module keeps SST_TXN_PAGES logical 256 byte pages (offsets 0 to
+ * SST_TXN_PAGES * 256 - 1) in a flash region:
+ *
+ *     | journal: SST_TXN_JOURNAL sectors | data sectors |
+ *
+ * Writes never touch the committed copy of a page. SST_Txn_Write merges the
+ * new bytes into a shadow page at the write position of the data sectors
+ * (in place when the transaction rewrites its own shadow page with 1 to 0
+ * bit changes only). SST_Txn_Commit queues the transaction; SST_Txn_Flush
+ * programs one commit record listing the new page locations of every queued
+ * transaction into the journal, so a group of small transactions costs one
+ * journal page. A transaction is durable once the flush returns: a reset
+ * before leaves all of its pages unchanged, a reset after all of them
+ * changed. SST_Txn_Commit flushes the group itself first when the
+ * transaction does not fit the record or SST_TXN_GROUP are queued already.
+ *
+ * Each journal sector starts with a checkpoint record holding the whole
+ * page map, written when the journal moves into the sector. SST_Txn_Init
+ * takes the newest checkpoint and applies the commit records behind it;
+ * a record torn by a reset fails its CRC-32 and is skipped.
+ *
+ * Data sectors are reused once they hold no committed or shadow page. When
+ * only one such sector is left, the sector with the fewest live pages is
+ * compacted into it: its committed pages are copied and published with a
+ * commit record of their own, the shadow pages are copied and moved.
+ *
+ * Reads always return committed data. Transactions writing the same page
+ * are not isolated, the one committed last wins. Call all functions from
+ * the same context.
+ */
+
+#ifndef SST25VF064C_TXN_H__
+#define SST25VF064C_TXN_H__
+
+#include <stdint.h>
+#include "SST25VF064C.h"
+
+#ifndef SST_TXN_PAGES
+#define SST_TXN_PAGES       64u     /**< Logical pages, at most 120 (the map fits a journal page). */
+#endif
+#ifndef SST_TXN_WRITES
+#define SST_TXN_WRITES      8u      /**< Pages one transaction may change. */
+#endif
+#ifndef SST_TXN_SHADOWS
+#define SST_TXN_SHADOWS     32u     /**< Shadow pages of all open and queued transactions together. */
+#endif
+#ifndef SST_TXN_GROUP
+#define SST_TXN_GROUP       8u      /**< Transactions queued before a commit record is written. */
+#endif
+#ifndef SST_TXN_JOURNAL
+#define SST_TXN_JOURNAL     2u      /**< Journal sectors, at least 2. */
+#endif
+
+/**@brief Page changes one commit record can list. */
+#define SST_TXN_ENTRIES     60u
+
+/**@brief Data sectors the region needs besides the journal. */
+#define SST_TXN_DATA_MIN    (((SST_TXN_PAGES + SST_TXN_SHADOWS + 15u) / 16u) + 2u)
+
+/**@brief Transaction, owned by the caller and kept until it is flushed or aborted. */
+typedef struct sst_txn_s
+{
+    struct sst_txn_s * p_next;              /**< Internal. */
+    uint8_t            state;               /**< Internal. */
+    uint8_t            count;               /**< Internal, pages changed. */
+    uint16_t           lpage[SST_TXN_WRITES];   /**< Internal. */
+    uint16_t           ppage[SST_TXN_WRITES];   /**< Internal, shadow page of each. */
+} sst_txn_t;
+
+/**@brief Transaction counters. */
+typedef struct
+{
+    unsigned long transactions;     /**< Transactions made durable. */
+    unsigned long commits;          /**< Commit records written, compaction records included. */
+    unsigned long pages_written;    /**< Shadow and compaction pages programmed. */
+    unsigned long relocations;      /**< Pages copied by compaction. */
+    unsigned long erases;           /**< Data and journal sectors erased. */
+} sst_txn_stats_t;
+
+extern sst_txn_stats_t sst_txn_stats;
+
+/**@brief Set up the region and recover the committed page map.
+ *
+ * An empty or foreign region is formatted: all pages read as 0xFF.
+ *
+ * @param[in] base  Region start, 4 KByte aligned.
+ * @param[in] size  Region size, a multiple of 4 KByte, holding the journal
+ *                  and at least SST_TXN_DATA_MIN data sectors.
+ *
+ * @retval NRF_SUCCESS              Region set up.
+ * @retval NRF_ERROR_INVALID_PARAM  Region not aligned, too small or exceeds the device.
+ * @retval NRF_ERROR_INVALID_DATA   Journal maps a page outside the region.
+ * @return Status of the journal erase or program otherwise, when formatting.
+ */
+uint32_t SST_Txn_Init(unsigned long base, unsigned long size);
+
+/**@brief Start a transaction.
+ *
+ * @retval NRF_SUCCESS              Transaction open.
+ * @retval NRF_ERROR_INVALID_STATE  SST_Txn_Init not called, or p_txn is open or queued.
+ */
+uint32_t SST_Txn_Begin(sst_txn_t * p_txn);
+
+/**@brief Write bytes into the transaction's view of the pages.
+ *
+ * @retval NRF_SUCCESS              Bytes in shadow pages.
+ * @retval NRF_ERROR_INVALID_STATE  Transaction not open.
+ * @retval NRF_ERROR_INVALID_PARAM  Range outside the logical pages.
+ * @retval NRF_ERROR_NO_MEM         SST_TXN_WRITES or SST_TXN_SHADOWS pages exceeded, or no data sector
+ *                                  could be freed. The transaction stays open with the bytes written before.
+ */
+uint32_t SST_Txn_Write(sst_txn_t * p_txn, unsigned long offset, const void * p_data, uint16_t len);
+
+/**@brief Queue the transaction for the next commit record.
+ *
+ * @retval NRF_SUCCESS              Queued.
+ * @retval NRF_ERROR_INVALID_STATE  Transaction not open.
+ * @return Status of the flush of a full group otherwise; the transaction stays open.
+ */
+uint32_t SST_Txn_Commit(sst_txn_t * p_txn);
+
+/**@brief Drop an open transaction and its shadow pages. */
+void SST_Txn_Abort(sst_txn_t * p_txn);
+
+/**@brief Write the queued transactions as one commit record.
+ *
+ * @retval NRF_SUCCESS  Queued transactions durable, or none queued.
+ * @return Status of the journal write otherwise; the transactions stay queued.
+ */
+uint32_t SST_Txn_Flush(void);
+
+/**@brief Read committed bytes. Pages never written read as 0xFF.
+ *
+ * @retval NRF_SUCCESS              Bytes read.
+ * @retval NRF_ERROR_INVALID_STATE  SST_Txn_Init not called.
+ * @retval NRF_ERROR_INVALID_PARAM  Range outside the logical pages.
+ */
+uint32_t SST_Txn_Read(unsigned long offset, void * p_data, uint16_t len);
+
+#endif /* SST25VF064C_TXN_H__ */
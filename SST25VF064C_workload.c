@@ -0,0 +1,269 @@
+/**@file
+ * @brief Workload engine, see SST25VF064C_workload.h.
+ */
+
+#include <string.h>
+#include "SST25VF064C_workload.h"
+#include "SST25VF064C_put.h"
+#include "SST25VF064C_readv.h"
+
+#define SLOTS_UNKNOWN   0xFFFFu     /* sector content not known, erase before use */
+
+static uint8_t     m_buf[SST_WORKLOAD_BUF];
+static uint16_t    m_fill[SST_WORKLOAD_SECTORS];    /* io_size slots written per sector */
+static sst_readv_t m_batch[SST25_SCATTER_SEGS];
+static uint32_t    m_rand;
+
+static uint32_t rand32(void)
+{
+    m_rand ^= m_rand << 13;
+    m_rand ^= m_rand >> 17;
+    m_rand ^= m_rand << 5;
+    return m_rand;
+}
+
+/* Bucket of a latency: exact below 8 ticks, then 4 per power of two. */
+static uint8_t bucket(uint32_t ticks)
+{
+    uint8_t msb = 2;
+
+    if (ticks < 8u)
+    {
+        return (uint8_t)ticks;
+    }
+    while ((ticks >> (msb + 1u)) != 0)
+    {
+        msb++;
+    }
+    if (msb > 24u)
+    {
+        return SST_WORKLOAD_BUCKETS - 1u;
+    }
+    return (uint8_t)(((msb - 1u) * 4u) + ((ticks >> (msb - 2u)) & 3u));
+}
+
+/* Largest latency that falls into bucket b. */
+static uint32_t bucket_top(uint8_t b)
+{
+    uint8_t msb = (uint8_t)((b / 4u) + 1u);
+
+    if (b < 8u)
+    {
+        return b;
+    }
+    return ((uint32_t)(4u + (b % 4u) + 1u) << (msb - 2u)) - 1u;
+}
+
+static void record(sst_workload_hist_t * p_hist, uint32_t ticks)
+{
+    p_hist->count++;
+    p_hist->bucket[bucket(ticks)]++;
+    if (ticks > p_hist->max)
+    {
+        p_hist->max = ticks;
+    }
+}
+
+static void read_batch(uint8_t count, sst_workload_time_t time_fn, sst_workload_result_t * p_result)
+{
+    uint32_t t_start = time_fn();
+    uint32_t err_code;
+    uint32_t ticks;
+    uint8_t  i;
+
+    err_code = SST_Readv(m_batch, count, SST_READV_GAP);
+    ticks    = time_fn() - t_start;
+    for (i = 0; i < count; i++)
+    {
+        record(&p_result->read, ticks);
+        p_result->bytes += m_batch[i].len;
+    }
+    if (err_code != NRF_SUCCESS)
+    {
+        p_result->errors += count;
+    }
+}
+
+static void write_op(sst_workload_desc_t const * p_desc, unsigned long sector, sst_workload_time_t time_fn,
+                     sst_workload_result_t * p_result)
+{
+    uint16_t      slots   = (uint16_t)(SST25_SECTOR_SIZE / p_desc->io_size);
+    uint32_t      t_start = time_fn();
+    uint32_t      err_code = NRF_SUCCESS;
+    unsigned long Dst;
+    unsigned long done;
+
+    if (m_fill[sector] >= slots)
+    {
+        err_code = Sector_Erase_Operation(p_desc->base + (sector * SST25_SECTOR_SIZE));
+        m_fill[sector] = 0;
+        p_result->erases++;
+    }
+    Dst = p_desc->base + (sector * SST25_SECTOR_SIZE) + ((unsigned long)m_fill[sector] * p_desc->io_size);
+    m_fill[sector]++;
+
+    m_buf[0] = (uint8_t)p_result->write.count;      /* a little variation in the data */
+    for (done = 0; (done < p_desc->io_size) && (err_code == NRF_SUCCESS); )
+    {
+        unsigned long n = SST25_PAGE_SIZE - ((Dst + done) % SST25_PAGE_SIZE);
+
+        n = (n > (p_desc->io_size - done)) ? (p_desc->io_size - done) : n;
+        err_code = Page_Program_Data_Operation(Dst + done, &m_buf[done], (unsigned short)n);
+        done += n;
+    }
+
+    record(&p_result->write, time_fn() - t_start);
+    p_result->bytes += p_desc->io_size;
+    if (err_code != NRF_SUCCESS)
+    {
+        p_result->errors++;
+    }
+}
+
+uint32_t SST_Workload_Run(sst_workload_desc_t const * p_desc, sst_workload_time_t time_fn, uint32_t tick_hz,
+                          sst_workload_result_t * p_result)
+{
+    unsigned long sectors = p_desc->span / SST25_SECTOR_SIZE;
+    unsigned long ios;
+    unsigned long read_pos  = 0;        /* next sequential read, in io_size units */
+    unsigned long write_sec = 0;        /* sector of the sequential writes */
+    uint32_t      t_start;
+    uint32_t      ops = 0;
+    uint8_t       batch = 0;
+    unsigned long i;
+
+    if (((p_desc->base % SST25_SECTOR_SIZE) != 0) || ((p_desc->span % SST25_SECTOR_SIZE) != 0) ||
+        (sectors == 0) || (sectors > SST_WORKLOAD_SECTORS) || !SST25_RANGE_VALID(p_desc->base, p_desc->span) ||
+        (p_desc->io_size == 0) || (p_desc->io_size > SST25_SECTOR_SIZE) || (p_desc->read_pct > 100u) ||
+        (p_desc->queue_depth == 0) || (p_desc->queue_depth > SST25_SCATTER_SEGS) ||
+        (((unsigned long)p_desc->queue_depth * p_desc->io_size) > sizeof(m_buf)) ||
+        ((p_desc->ops == 0) && (p_desc->duration == 0)) || (p_desc->seed == 0))
+    {
+        return NRF_ERROR_INVALID_PARAM;
+    }
+    memset(p_result, 0, sizeof(*p_result));
+    p_result->tick_hz = tick_hz;
+    for (i = 0; i < sectors; i++)
+    {
+        m_fill[i] = SLOTS_UNKNOWN;
+    }
+    for (i = 0; i < sizeof(m_buf); i++)
+    {
+        m_buf[i] = (uint8_t)(i * 7u);
+    }
+    m_rand = p_desc->seed;
+    ios    = p_desc->span / p_desc->io_size;
+
+    t_start = time_fn();
+    while (((p_desc->ops == 0) || (ops < p_desc->ops)) &&
+           ((p_desc->duration == 0) || ((time_fn() - t_start) < p_desc->duration)))
+    {
+        if ((rand32() % 100u) < p_desc->read_pct)
+        {
+            unsigned long io = p_desc->random ? (rand32() % ios) : read_pos;
+
+            read_pos = (io + 1u) % ios;
+            m_batch[batch].addr  = p_desc->base + (io * p_desc->io_size);
+            m_batch[batch].p_dst = &m_buf[batch * p_desc->io_size];
+            m_batch[batch].len   = p_desc->io_size;
+            batch++;
+            ops++;
+            if (batch == p_desc->queue_depth)
+            {
+                read_batch(batch, time_fn, p_result);
+                batch = 0;
+            }
+            continue;
+        }
+
+        if (batch != 0)
+        {
+            read_batch(batch, time_fn, p_result);     /* reads queued before the write complete first */
+            batch = 0;
+        }
+        if (p_desc->random)
+        {
+            write_op(p_desc, rand32() % sectors, time_fn, p_result);
+        }
+        else
+        {
+            if ((m_fill[write_sec] != SLOTS_UNKNOWN) && (m_fill[write_sec] >= (SST25_SECTOR_SIZE / p_desc->io_size)))
+            {
+                write_sec = (write_sec + 1u) % sectors;
+            }
+            write_op(p_desc, write_sec, time_fn, p_result);
+        }
+        ops++;
+    }
+    if (batch != 0)
+    {
+        read_batch(batch, time_fn, p_result);
+    }
+    p_result->ticks = time_fn() - t_start;
+    return NRF_SUCCESS;
+}
+
+uint32_t SST_Workload_Percentile(sst_workload_hist_t const * p_hist, uint16_t permille)
+{
+    uint32_t rank = (uint32_t)((((uint64_t)p_hist->count * permille) + 999u) / 1000u);
+    uint32_t seen = 0;
+    uint8_t  b;
+
+    for (b = 0; b < SST_WORKLOAD_BUCKETS; b++)
+    {
+        seen += p_hist->bucket[b];
+        if ((seen >= rank) && (seen != 0))
+        {
+            return (bucket_top(b) < p_hist->max) ? bucket_top(b) : p_hist->max;
+        }
+    }
+    return p_hist->max;
+}
+
+static unsigned long to_us(sst_workload_result_t const * p_result, uint32_t ticks)
+{
+    return (p_result->tick_hz == 0) ? 0 : (unsigned long)(((uint64_t)ticks * 1000000u) / p_result->tick_hz);
+}
+
+static unsigned long per_s(sst_workload_result_t const * p_result, unsigned long count)
+{
+    return (p_result->ticks == 0) ? 0 : (unsigned long)(((uint64_t)count * p_result->tick_hz) / p_result->ticks);
+}
+
+static void put_hist(sst_workload_result_t const * p_result, sst_workload_hist_t const * p_hist,
+                     const char * p_name, sst_workload_put_t put)
+{
+    static const uint16_t permille[]  = { 500u, 900u, 990u, 999u };
+    static const char *   p_labels[] = { " p50=", " p90=", " p99=", " p999=" };
+    uint8_t               i;
+
+    sst_put_str(put, "SST25WL ");
+    sst_put_str(put, p_name);
+    sst_put_str(put, " n=");
+    sst_put_dec(put, p_hist->count);
+    for (i = 0; i < 4u; i++)
+    {
+        sst_put_str(put, p_labels[i]);
+        sst_put_dec(put, to_us(p_result, SST_Workload_Percentile(p_hist, permille[i])));
+    }
+    sst_put_str(put, " max=");
+    sst_put_dec(put, to_us(p_result, p_hist->max));
+    sst_put_str(put, "\r\n");
+}
+
+void SST_Workload_Print(sst_workload_result_t const * p_result, sst_workload_put_t put)
+{
+    sst_put_str(put, "SST25WL ops=");
+    sst_put_dec(put, p_result->read.count + p_result->write.count);
+    sst_put_str(put, " ops/s=");
+    sst_put_dec(put, per_s(p_result, p_result->read.count + p_result->write.count));
+    sst_put_str(put, " kB/s=");
+    sst_put_dec(put, per_s(p_result, p_result->bytes) / 1000u);
+    sst_put_str(put, " errors=");
+    sst_put_dec(put, p_result->errors);
+    sst_put_str(put, " erases=");
+    sst_put_dec(put, p_result->erases);
+    sst_put_str(put, "\r\n");
+    put_hist(p_result, &p_result->read, "read", put);
+    put_hist(p_result, &p_result->write, "write", put);
+}
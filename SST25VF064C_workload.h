@@ -0,0 +1,101 @@
+/**@file
+ * @brief Configurable workload engine for soak and throughput tests.
+ *
+ * Runs a stream of reads and writes described by sst_workload_desc_t
+ * against a scratch span through the driver API and collects throughput
+ * and a latency histogram per operation type. The same engine runs in
+ * firmware (workload_main.c, target nrf51822_xxaa_workload of the Keil
+ * project: TIMER0 time, report over the UART) and on the host against the
+ * simulator (tools/workload.c), so access patterns seen in the field can be
+ * replayed and driver builds compared.
+ *
+ * Operations:
+ *   - read: io_size bytes at an io_size aligned offset of the span, the
+ *     next one (sequential) or a random one. The driver completes one
+ *     command at a time, so queue_depth reads in a row are collected and
+ *     issued as one SST_Readv batch; each completes with the batch.
+ *   - write: io_size bytes programmed with Page_Program_Data_Operation at
+ *     the next free io_size slot of a sector, the sector following the
+ *     last one (sequential) or a random one. A sector is erased, inside
+ *     the timed write, when the write finds it full or of unknown content.
+ *
+ * Report written by SST_Workload_Print, latencies in microseconds:
+ *   SST25WL ops=<n> ops/s=<n> kB/s=<n> errors=<n> erases=<n>
+ *   SST25WL read n=<n> p50=<us> p90=<us> p99=<us> p999=<us> max=<us>
+ *   SST25WL write n=<n> p50=<us> p90=<us> p99=<us> p999=<us> max=<us>
+ */
+
+#ifndef SST25VF064C_WORKLOAD_H__
+#define SST25VF064C_WORKLOAD_H__
+
+#include <stdint.h>
+#include "SST25VF064C.h"
+
+#ifndef SST_WORKLOAD_BUF
+#define SST_WORKLOAD_BUF        2048u   /**< RAM for data, at least queue_depth * io_size. */
+#endif
+#ifndef SST_WORKLOAD_SECTORS
+#define SST_WORKLOAD_SECTORS    256u    /**< Largest span in sectors (2 bytes of RAM each). */
+#endif
+#define SST_WORKLOAD_BUCKETS    96u     /**< Latency buckets, 4 per power of two up to 2^24 ticks. */
+
+/**@brief Timestamp source, free running, wrapping at 2^32. */
+typedef uint32_t (*sst_workload_time_t)(void);
+
+/**@brief Byte output for SST_Workload_Print. */
+typedef void (*sst_workload_put_t)(uint8_t byte);
+
+/**@brief Workload descriptor. */
+typedef struct
+{
+    unsigned long base;         /**< Start of the span, sector aligned. */
+    unsigned long span;         /**< Size of the span, a multiple of the sector size. Its content is lost. */
+    uint16_t      io_size;      /**< Bytes per operation, 1 to the sector size. */
+    uint8_t       read_pct;     /**< Share of reads in percent, the rest are writes. */
+    bool          random;       /**< Random instead of sequential offsets. */
+    uint8_t       queue_depth;  /**< Reads issued together, 1 to SST25_SCATTER_SEGS. */
+    uint32_t      ops;          /**< Stop after this many operations, 0 for no limit. */
+    uint32_t      duration;     /**< Stop after this many ticks, 0 for no limit. */
+    uint32_t      seed;         /**< Random generator seed, not 0. */
+} sst_workload_desc_t;
+
+/**@brief Latencies of one operation type. */
+typedef struct
+{
+    uint32_t count;
+    uint32_t max;                               /**< Ticks. */
+    uint32_t bucket[SST_WORKLOAD_BUCKETS];
+} sst_workload_hist_t;
+
+/**@brief Workload results. */
+typedef struct
+{
+    uint32_t            tick_hz;
+    uint32_t            ticks;          /**< Run time. */
+    unsigned long       bytes;          /**< Bytes read and written. */
+    uint32_t            erases;         /**< Sector erases done by writes. */
+    uint32_t            errors;         /**< Operations that did not return NRF_SUCCESS. */
+    sst_workload_hist_t read;
+    sst_workload_hist_t write;
+} sst_workload_result_t;
+
+/**@brief Run a workload.
+ *
+ * @param[in]  p_desc    Workload.
+ * @param[in]  time_fn   Timestamp source, e.g. a TIMER capture.
+ * @param[in]  tick_hz   Rate of time_fn.
+ * @param[out] p_result  Counters and latency histograms.
+ *
+ * @retval NRF_SUCCESS              Workload done, see p_result->errors.
+ * @retval NRF_ERROR_INVALID_PARAM  Span, io_size, queue_depth or stop condition not usable.
+ */
+uint32_t SST_Workload_Run(sst_workload_desc_t const * p_desc, sst_workload_time_t time_fn, uint32_t tick_hz,
+                          sst_workload_result_t * p_result);
+
+/**@brief Latency in ticks below which permille of the operations completed. */
+uint32_t SST_Workload_Percentile(sst_workload_hist_t const * p_hist, uint16_t permille);
+
+/**@brief Write the report through a byte output, e.g. simple_uart_put. */
+void SST_Workload_Print(sst_workload_result_t const * p_result, sst_workload_put_t put);
+
+#endif /* SST25VF064C_WORKLOAD_H__ */
@@ -0,0 +1,450 @@
+/**@file
+ * @brief Write path that skips programming bytes already in the target state.
+ */
+
+#include <stddef.h>
+#include <string.h>
+#include "SST25VF064C.h"
+#include "SST25VF064C_write.h"
+#include "SST25VF064C_crc32.h"
+
+#define PAGES_PER_SECTOR    (SST25_SECTOR_SIZE / SST25_PAGE_SIZE)
+#define DIFF_NONE           0xFFFFu
+#define NO_SPARE            0xFFFFFFFFul
+#define TAG_MAGIC           0x47415453ul    /* "STAG" */
+#define TAG_SLOT            32u             /* bytes per tag in the tag sector, divides a page */
+#define TAG_SLOTS           (SST25_SECTOR_SIZE / TAG_SLOT)
+
+/* Tag of a merged sector in the spare, programmed before the target is
+ * erased; done is cleared once the copy-back has finished. */
+typedef struct
+{
+    uint32_t magic;
+    uint32_t target;                    /* sector the spare belongs to */
+    uint32_t sequence;                  /* incremented per copy, wraps */
+    uint32_t data_crc;                  /* CRC-32 of the merged sector */
+    uint32_t tag_crc;                   /* CRC-32 of the fields above */
+    uint32_t done;
+} spare_tag_t;
+
+sst_write_stats_t sst_write_stats;
+
+static unsigned long m_spare = NO_SPARE;
+static bool          m_spare_erased;
+static uint16_t      m_tag_pos;         /* next free tag slot */
+static uint32_t      m_sequence;        /* of the next tag */
+static bool          m_pending;         /* tag m_tag_pos - 1 is not done */
+static spare_tag_t   m_tag;             /* last tag read or written */
+
+static unsigned long tag_addr(uint16_t slot)
+{
+    return m_spare + SST25_SECTOR_SIZE + (unsigned long)slot * TAG_SLOT;
+}
+
+static uint32_t tag_crc(spare_tag_t const * p_tag)
+{
+    return SST_CRC32_Compute((uint8_t const *)p_tag, offsetof(spare_tag_t, tag_crc), NULL);
+}
+
+/* Finds the end of the tag log and whether its last copy-back is unfinished. */
+static void tag_scan(void)
+{
+    spare_tag_t tag;
+    bool        foreign = false;
+
+    m_tag_pos  = 0;
+    m_sequence = 0;
+    m_pending  = false;
+    while (m_tag_pos < TAG_SLOTS)
+    {
+        HighSpeed_Read_Data(tag_addr(m_tag_pos), (unsigned char *)&tag, sizeof(tag));
+        if (tag.magic == 0xFFFFFFFFul)
+        {
+            break;
+        }
+        m_tag_pos++;
+        // A torn tag was programmed before the target erase: nothing to finish.
+        m_pending = (tag.magic == TAG_MAGIC) && (tag.tag_crc == tag_crc(&tag)) &&
+                    (tag.done == 0xFFFFFFFFul) && SST25_RANGE_VALID(tag.target, SST25_SECTOR_SIZE);
+        if (m_pending)
+        {
+            m_tag = tag;
+        }
+        if (tag.magic == TAG_MAGIC)
+        {
+            m_sequence = tag.sequence + 1u;
+        }
+        else
+        {
+            foreign = true;
+        }
+    }
+    if (foreign)
+    {
+        m_tag_pos = TAG_SLOTS;      /* erased by the next SST_Write_Prepare */
+    }
+}
+
+/* CRC-32 of a sector, read through p_page. */
+static uint32_t sector_crc(unsigned long Dst, uint8_t * p_page)
+{
+    uint32_t      crc = 0;
+    unsigned long offset;
+
+    for (offset = 0; offset < SST25_SECTOR_SIZE; offset += SST25_PAGE_SIZE)
+    {
+        crc = HighSpeed_Read_Data_CRC(Dst + offset, p_page, SST25_PAGE_SIZE, &crc);
+    }
+    return crc;
+}
+
+static bool blank(const uint8_t * p_data, unsigned short len)
+{
+    unsigned short i;
+
+    for (i = 0; i < len; i++)
+    {
+        if (p_data[i] != 0xFF)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+/* Programs a freshly erased page unless the new data is all 0xFF. */
+static uint32_t write_erased(unsigned long Dst, const uint8_t * p_data, unsigned short len)
+{
+    if (!blank(p_data, len))
+    {
+        sst_write_stats.pages_programmed++;
+        sst_write_stats.bytes_programmed += len;
+        return Page_Program_Data_Operation(Dst, p_data, len);
+    }
+    sst_write_stats.pages_skipped++;
+    sst_write_stats.bytes_elided += len;
+    return NRF_SUCCESS;
+}
+
+/* Copies a page through p_page into an erased page, skipping 0xFF pages. */
+static uint32_t copy_erased(unsigned long Dst, const uint8_t * p_page)
+{
+    if (blank(p_page, SST25_PAGE_SIZE))
+    {
+        return NRF_SUCCESS;
+    }
+    sst_write_stats.pages_programmed++;
+    sst_write_stats.bytes_programmed += SST25_PAGE_SIZE;
+    return Page_Program_Data_Operation(Dst, p_page, SST25_PAGE_SIZE);
+}
+
+/* Erases the sector the tag names and copies the spare back into it. */
+static uint32_t copy_back(unsigned long sector, uint8_t * p_page)
+{
+    unsigned long offset;
+    uint32_t      err_code;
+
+    err_code = Sector_Erase_Operation(sector);
+    if (err_code != NRF_SUCCESS)
+    {
+        return err_code;
+    }
+    sst_write_stats.sectors_erased++;
+    sst_write_stats.sectors_copied++;
+    for (offset = 0; offset < SST25_SECTOR_SIZE; offset += SST25_PAGE_SIZE)
+    {
+        HighSpeed_Read_Data(m_spare + offset, p_page, SST25_PAGE_SIZE);
+        err_code = copy_erased(sector + offset, p_page);
+        if (err_code != NRF_SUCCESS)
+        {
+            return err_code;
+        }
+    }
+    return NRF_SUCCESS;
+}
+
+/* Marks the last tag done, the spare may be erased again. */
+static uint32_t tag_done(void)
+{
+    uint32_t done = 0;
+    uint32_t err_code;
+
+    err_code = Page_Program_Data_Operation(tag_addr((uint16_t)(m_tag_pos - 1u)) + offsetof(spare_tag_t, done),
+                                           (const unsigned char *)&done, sizeof(done));
+    if (err_code == NRF_SUCCESS)
+    {
+        m_pending = false;
+    }
+    return err_code;
+}
+
+/* Rewrites a partially covered sector through the spare sector, with one
+ * page of RAM: every page of the old sector is merged with the new bytes
+ * into the spare, the merged sector is tagged, the sector is erased and the
+ * spare copied back. */
+static uint32_t write_spare(unsigned long Dst, const uint8_t * p_data, unsigned long no_bytes, uint8_t * p_page)
+{
+    unsigned long sector = Dst & ~(unsigned long)(SST25_SECTOR_SIZE - 1u);
+    unsigned long offset;
+    uint32_t      crc = 0;
+    uint32_t      err_code;
+
+    err_code = SST_Write_Prepare();
+    if (err_code != NRF_SUCCESS)
+    {
+        return err_code;
+    }
+    m_spare_erased = false;
+
+    for (offset = 0; offset < SST25_SECTOR_SIZE; offset += SST25_PAGE_SIZE)
+    {
+        unsigned long a = sector + offset;
+
+        HighSpeed_Read_Data(a, p_page, SST25_PAGE_SIZE);
+        if ((a + SST25_PAGE_SIZE > Dst) && (a < Dst + no_bytes))
+        {
+            unsigned long first = (a > Dst) ? a : Dst;
+            unsigned long end   = ((a + SST25_PAGE_SIZE) < (Dst + no_bytes)) ? (a + SST25_PAGE_SIZE) : (Dst + no_bytes);
+
+            memcpy(&p_page[first - a], &p_data[first - Dst], end - first);
+        }
+        crc      = SST_CRC32_Compute(p_page, SST25_PAGE_SIZE, &crc);
+        err_code = copy_erased(m_spare + offset, p_page);
+        if (err_code != NRF_SUCCESS)
+        {
+            return err_code;
+        }
+    }
+
+    // From here on SST_Write_Recover can finish the copy after a reset.
+    m_tag.magic    = TAG_MAGIC;
+    m_tag.target   = sector;
+    m_tag.sequence = m_sequence;
+    m_tag.data_crc = crc;
+    m_tag.tag_crc  = tag_crc(&m_tag);
+    m_tag.done     = 0xFFFFFFFFul;
+    err_code = Page_Program_Data_Operation(tag_addr(m_tag_pos), (const unsigned char *)&m_tag, sizeof(m_tag));
+    m_tag_pos++;
+    m_sequence++;
+    if (err_code != NRF_SUCCESS)
+    {
+        return err_code;
+    }
+    m_pending = true;
+
+    err_code = copy_back(sector, p_page);
+    if (err_code != NRF_SUCCESS)
+    {
+        return err_code;
+    }
+    return tag_done();
+}
+
+/* Handles the part of the range that falls into one sector. */
+static uint32_t write_sector(unsigned long Dst, const uint8_t * p_data, unsigned long no_bytes)
+{
+    uint16_t      first[PAGES_PER_SECTOR];
+    uint16_t      last[PAGES_PER_SECTOR];
+    uint8_t       old[SST25_PAGE_SIZE];
+    bool          need_erase = false;
+    unsigned long done;
+    uint8_t       page;
+    uint32_t      err_code;
+
+    /* Pass 1: classify every page segment. */
+    for (done = 0, page = 0; done < no_bytes; page++)
+    {
+        unsigned long  a   = Dst + done;
+        unsigned short len = (unsigned short)(SST25_PAGE_SIZE - (a % SST25_PAGE_SIZE));
+        unsigned short i;
+
+        if (len > (no_bytes - done))
+        {
+            len = (unsigned short)(no_bytes - done);
+        }
+        HighSpeed_Read_Data(a, old, len);
+
+        first[page] = DIFF_NONE;
+        for (i = 0; i < len; i++)
+        {
+            uint8_t n = p_data[done + i];
+            if (old[i] != n)
+            {
+                if (first[page] == DIFF_NONE)
+                {
+                    first[page] = i;
+                }
+                last[page] = i;
+                if ((old[i] & n) != n)
+                {
+                    need_erase = true;      /* a bit has to go from 0 to 1 */
+                }
+            }
+        }
+        done += len;
+    }
+
+    if (need_erase)
+    {
+        if (no_bytes != SST25_SECTOR_SIZE)
+        {
+            if (m_spare == NO_SPARE)
+            {
+                return NRF_ERROR_INVALID_STATE;
+            }
+            return write_spare(Dst, p_data, no_bytes, old);
+        }
+        err_code = Sector_Erase_Operation(Dst);
+        if (err_code != NRF_SUCCESS)
+        {
+            return err_code;
+        }
+        sst_write_stats.sectors_erased++;
+        for (done = 0; done < no_bytes; done += SST25_PAGE_SIZE)
+        {
+            err_code = write_erased(Dst + done, &p_data[done], SST25_PAGE_SIZE);
+            if (err_code != NRF_SUCCESS)
+            {
+                return err_code;
+            }
+        }
+        return NRF_SUCCESS;
+    }
+
+    /* Pass 2: program only the differing sub-range of each page. */
+    for (done = 0, page = 0; done < no_bytes; page++)
+    {
+        unsigned long  a   = Dst + done;
+        unsigned short len = (unsigned short)(SST25_PAGE_SIZE - (a % SST25_PAGE_SIZE));
+
+        if (len > (no_bytes - done))
+        {
+            len = (unsigned short)(no_bytes - done);
+        }
+        if (first[page] == DIFF_NONE)
+        {
+            sst_write_stats.pages_skipped++;
+            sst_write_stats.bytes_elided += len;
+        }
+        else
+        {
+            unsigned short n = (unsigned short)(last[page] - first[page] + 1);
+
+            sst_write_stats.pages_programmed++;
+            sst_write_stats.bytes_programmed += n;
+            sst_write_stats.bytes_elided     += (unsigned long)(len - n);
+            err_code = Page_Program_Data_Operation(a + first[page], &p_data[done + first[page]], n);
+            if (err_code != NRF_SUCCESS)
+            {
+                return err_code;
+            }
+        }
+        done += len;
+    }
+    return NRF_SUCCESS;
+}
+
+uint32_t SST_Write_Spare(unsigned long Dst)
+{
+    if (((Dst % SST25_SECTOR_SIZE) != 0) || !SST25_RANGE_VALID(Dst, SST_WRITE_SPARE_SIZE))
+    {
+        return NRF_ERROR_INVALID_PARAM;
+    }
+    m_spare        = Dst;
+    m_spare_erased = false;
+    tag_scan();
+    return NRF_SUCCESS;
+}
+
+uint32_t SST_Write_Recover(void)
+{
+    uint8_t  page[SST25_PAGE_SIZE];
+    uint32_t err_code;
+
+    if (!m_pending)
+    {
+        return NRF_SUCCESS;
+    }
+    if (sector_crc(m_spare, page) != m_tag.data_crc)
+    {
+        // The merged copy is gone; give the spare up rather than block it.
+        err_code = tag_done();
+        return (err_code == NRF_SUCCESS) ? NRF_ERROR_INVALID_DATA : err_code;
+    }
+    if (sector_crc(m_tag.target, page) != m_tag.data_crc)
+    {
+        err_code = copy_back(m_tag.target, page);
+        if (err_code != NRF_SUCCESS)
+        {
+            return err_code;
+        }
+    }
+    return tag_done();
+}
+
+uint32_t SST_Write_Prepare(void)
+{
+    uint32_t err_code;
+
+    if (m_spare == NO_SPARE)
+    {
+        return NRF_SUCCESS;
+    }
+    if (m_pending)
+    {
+        return NRF_ERROR_INVALID_STATE;
+    }
+    if (!m_spare_erased)
+    {
+        err_code = Sector_Erase_Operation(m_spare);
+        if (err_code != NRF_SUCCESS)
+        {
+            return err_code;
+        }
+        sst_write_stats.sectors_erased++;
+        m_spare_erased = true;
+    }
+    if (m_tag_pos == TAG_SLOTS)
+    {
+        err_code = Sector_Erase_Operation(m_spare + SST25_SECTOR_SIZE);
+        if (err_code != NRF_SUCCESS)
+        {
+            return err_code;
+        }
+        sst_write_stats.sectors_erased++;
+        m_tag_pos = 0;
+    }
+    return NRF_SUCCESS;
+}
+
+uint32_t SST_Write_Elide(unsigned long Dst, const uint8_t * p_data, unsigned long no_bytes)
+{
+    if (!SST25_RANGE_VALID(Dst, no_bytes) ||
+        ((m_spare != NO_SPARE) && (Dst < m_spare + SST_WRITE_SPARE_SIZE) && (Dst + no_bytes > m_spare)))
+    {
+        return NRF_ERROR_INVALID_ADDR;
+    }
+    if (m_pending)
+    {
+        return NRF_ERROR_INVALID_STATE;
+    }
+    while (no_bytes)
+    {
+        unsigned long n = SST25_SECTOR_SIZE - (Dst % SST25_SECTOR_SIZE);
+        uint32_t      err_code;
+
+        if (n > no_bytes)
+        {
+            n = no_bytes;
+        }
+        err_code = write_sector(Dst, p_data, n);
+        if (err_code != NRF_SUCCESS)
+        {
+            return err_code;
+        }
+        Dst      += n;
+        p_data   += n;
+        no_bytes -= n;
+    }
+    return NRF_SUCCESS;
+}
@@ -0,0 +1,101 @@
+/**@file
+ * @brief Write path that skips programming bytes already in the target state.
+ *
+ * NOR flash can only clear bits. Before writing, every page of the target
+ * range is read and compared with the new data:
+ *  - identical pages are not programmed at all,
+ *  - if the new data only clears bits, just the differing sub-range of the
+ *    page is programmed,
+ *  - only when a bit has to go from 0 to 1 is the sector erased and
+ *    reprogrammed (pages that are all 0xFF are not programmed after the erase).
+ *
+ * A sector that needs an erase but is only partly covered by the range is
+ * rewritten through a spare sector set with SST_Write_Spare, using one page
+ * of RAM: each page of the old sector is read, merged with the new bytes
+ * and programmed into the spare, then the sector is erased and the spare
+ * copied back. Call SST_Write_Prepare when idle to erase the used spare
+ * ahead of the next such write.
+ *
+ * The sector after the spare holds a log of 32 byte tags. Once the merged
+ * sector is complete in the spare, a tag with the target address, a
+ * sequence number and the CRC-32 of the merged data is programmed, and it
+ * is marked done after the copy-back. A reset between the sector erase and
+ * the end of the copy-back leaves the merged sector only in the spare;
+ * SST_Write_Recover, called at start-up, finds the unfinished tag and
+ * copies the spare back again.
+ */
+
+#ifndef SST25VF064C_WRITE_H__
+#define SST25VF064C_WRITE_H__
+
+#include <stdint.h>
+#include "SST25VF064C_device.h"
+
+#define SST_WRITE_SPARE_SIZE    (2u * SST25_SECTOR_SIZE)    /**< Spare sector and its tag sector. */
+
+/**@brief Counters of the work done and avoided by SST_Write_Elide. */
+typedef struct
+{
+    unsigned long pages_skipped;        /**< Pages already holding the new data. */
+    unsigned long pages_programmed;     /**< Page program commands issued. */
+    unsigned long bytes_programmed;     /**< Bytes sent with those commands. */
+    unsigned long bytes_elided;         /**< Bytes of the request not sent. */
+    unsigned long sectors_erased;       /**< Sectors that needed a 0 to 1 change, spare erases included. */
+    unsigned long sectors_copied;       /**< Partly covered sectors rewritten through the spare. */
+} sst_write_stats_t;
+
+extern sst_write_stats_t sst_write_stats;
+
+/**@brief Set the spare sector for partly covered sectors that need an erase.
+ *
+ * Dst and the sector after it (SST_WRITE_SPARE_SIZE bytes) must not hold
+ * application data; SST_Write_Elide refuses ranges that touch them. The
+ * spare is erased by the first write needing it or by SST_Write_Prepare.
+ * The tag sector is read to find an unfinished copy-back, use the same Dst
+ * on every start-up and call SST_Write_Recover before writing.
+ *
+ * @retval NRF_SUCCESS              Spare set.
+ * @retval NRF_ERROR_INVALID_PARAM  Dst not sector aligned or beyond the device.
+ */
+uint32_t SST_Write_Spare(unsigned long Dst);
+
+/**@brief Finish a copy-back from the spare interrupted by a reset.
+ *
+ * If the last tag is not done, the target sector is erased and rewritten
+ * from the spare unless it already matches the tagged CRC, then the tag is
+ * marked done.
+ *
+ * @retval NRF_SUCCESS              Nothing pending, or the copy-back finished.
+ * @retval NRF_ERROR_INVALID_DATA   The spare no longer matches its tag. The
+ *                                  target sector is undefined; the tag is
+ *                                  dropped so the spare can be reused.
+ * @return Any other error of a failed erase or program; call again.
+ */
+uint32_t SST_Write_Recover(void);
+
+/**@brief Erase the spare sector if a write has used it, and the tag sector
+ *        when it is full.
+ *
+ * @retval NRF_SUCCESS              Spare erased or unset.
+ * @retval NRF_ERROR_INVALID_STATE  A copy-back is unfinished, see SST_Write_Recover.
+ * @return Any other error of the failed sector erase.
+ */
+uint32_t SST_Write_Prepare(void);
+
+/**@brief Write a range, programming only what differs.
+ *
+ * Sectors that need an erase and are not covered completely by the range
+ * go through the spare sector. Sectors before the failing one have already
+ * been written when an error is returned.
+ *
+ * @retval NRF_SUCCESS              Flash holds the new data.
+ * @retval NRF_ERROR_INVALID_ADDR   Range exceeds the device or overlaps the spare.
+ * @retval NRF_ERROR_INVALID_STATE  A partially covered sector needs an erase and
+ *                                  no spare is set; that sector has not been modified.
+ *                                  Also returned, before anything is written, while
+ *                                  a copy-back waits for SST_Write_Recover.
+ * @retval NRF_ERROR_INVALID_DATA   Program-verify reported a mismatch.
+ */
+uint32_t SST_Write_Elide(unsigned long Dst, const uint8_t * p_data, unsigned long no_bytes);
+
+#endif /* SST25VF064C_WRITE_H__ */
@@ -0,0 +1,329 @@
+/**@file
+ * @brief Host packer for SST25VF064C_asset images.
+ *
+ * Builds an asset pack from files, with the perfect hash directory at the
+ * start and every asset on its own 256 byte page. The image is then loaded
+ * into the simulator at the given base address and every asset is looked
+ * up and verified through SST25VF064C_asset.c before the file is written.
+ *
+ * Build and run from the tools directory:
+ *     cc -O2 -DSST25VF064C_HOST -I.. -o asset_pack asset_pack.c flash_sim.c ../SST25VF064C_asset.c ../SST25VF064C_crc32.c
+ *     ./asset_pack -o pack.bin [-b base] [name=]file ...
+ *
+ * The asset name is the file name without directories unless given as
+ * name=file. Program pack.bin into the flash at base and open it with
+ * SST_Asset_Open(&pack, base).
+ */
+
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "flash_sim.h"
+#include "SST25VF064C_asset.h"
+#include "SST25VF064C_crc32.h"
+
+#define PAGE_ROUND(x)   (((x) + SST25_PAGE_SIZE - 1u) & ~(unsigned long)(SST25_PAGE_SIZE - 1u))
+
+typedef struct
+{
+    const char *  p_name;
+    const char *  p_path;
+    uint32_t      id;
+    uint32_t      slot;
+    unsigned long offset;
+    unsigned long length;
+    uint8_t *     p_data;
+} asset_t;
+
+static asset_t *  m_assets;
+static uint32_t   m_count;
+static uint32_t   m_buckets;
+static uint32_t   m_slots;
+static uint16_t * m_disp;
+static int32_t *  m_slot_owner;     /* asset index per slot, -1 free */
+
+static uint8_t * load_file(const char * p_path, unsigned long * p_len)
+{
+    FILE *    p_file = fopen(p_path, "rb");
+    uint8_t * p_data;
+    long      len;
+
+    if (p_file == NULL)
+    {
+        perror(p_path);
+        exit(1);
+    }
+    fseek(p_file, 0, SEEK_END);
+    len = ftell(p_file);
+    fseek(p_file, 0, SEEK_SET);
+    p_data = malloc(len ? (size_t)len : 1u);
+    if ((p_data == NULL) || (fread(p_data, 1, (size_t)len, p_file) != (size_t)len))
+    {
+        perror(p_path);
+        exit(1);
+    }
+    fclose(p_file);
+    *p_len = (unsigned long)len;
+    return p_data;
+}
+
+/* Bucket sizes, largest placed first. */
+static uint32_t * m_bucket_size;
+
+static int bucket_cmp(const void * p_a, const void * p_b)
+{
+    uint32_t a = *(const uint32_t *)p_a;
+    uint32_t b = *(const uint32_t *)p_b;
+
+    return (m_bucket_size[b] > m_bucket_size[a]) - (m_bucket_size[b] < m_bucket_size[a]);
+}
+
+/* Hash and displace. Returns false if some bucket found no displacement. */
+static bool build_directory(void)
+{
+    uint32_t * p_order = malloc(m_buckets * sizeof(*p_order));
+    bool       placed  = true;
+    uint32_t   b;
+    uint32_t   i;
+
+    free(m_disp);
+    free(m_slot_owner);
+    m_bucket_size = calloc(m_buckets, sizeof(*m_bucket_size));
+    m_disp        = calloc(m_buckets, sizeof(*m_disp));
+    m_slot_owner  = malloc(m_slots * sizeof(*m_slot_owner));
+    if ((p_order == NULL) || (m_bucket_size == NULL) || (m_disp == NULL) || (m_slot_owner == NULL))
+    {
+        perror("malloc");
+        exit(1);
+    }
+    for (i = 0; i < m_slots; i++)
+    {
+        m_slot_owner[i] = -1;
+    }
+    for (i = 0; i < m_count; i++)
+    {
+        m_bucket_size[SST_Asset_Bucket(m_assets[i].id, m_buckets)]++;
+    }
+    for (b = 0; b < m_buckets; b++)
+    {
+        p_order[b] = b;
+    }
+    qsort(p_order, m_buckets, sizeof(*p_order), bucket_cmp);
+
+    for (b = 0; (b < m_buckets) && placed && (m_bucket_size[p_order[b]] != 0); b++)
+    {
+        uint32_t bucket = p_order[b];
+        uint32_t d;
+
+        placed = false;
+        for (d = 0; (d <= 0xFFFFu) && !placed; d++)
+        {
+            placed = true;
+            for (i = 0; (i < m_count) && placed; i++)
+            {
+                uint32_t slot = SST_Asset_Slot(m_assets[i].id, (uint16_t)d, m_slots);
+
+                if (SST_Asset_Bucket(m_assets[i].id, m_buckets) != bucket)
+                {
+                    continue;
+                }
+                if (m_slot_owner[slot] >= 0)
+                {
+                    placed = false;
+                }
+                else
+                {
+                    m_slot_owner[slot] = (int32_t)i;
+                    m_assets[i].slot   = slot;
+                }
+            }
+            if (placed)
+            {
+                m_disp[bucket] = (uint16_t)d;
+                continue;
+            }
+            // Undo the partial placement of this bucket.
+            for (i = 0; i < m_slots; i++)
+            {
+                if ((m_slot_owner[i] >= 0) && (SST_Asset_Bucket(m_assets[m_slot_owner[i]].id, m_buckets) == bucket))
+                {
+                    m_slot_owner[i] = -1;
+                }
+            }
+        }
+    }
+    free(p_order);
+    free(m_bucket_size);
+    return placed;
+}
+
+int main(int argc, char ** argv)
+{
+    const char *       p_out = NULL;
+    unsigned long      base  = 0;
+    unsigned long      dir_end;
+    unsigned long      size;
+    unsigned long      payload = 0;
+    uint8_t *          p_image;
+    sst_asset_header_t hdr;
+    sst_asset_pack_t   pack;
+    FILE *             p_file;
+    uint32_t           i;
+    uint32_t           j;
+    int                arg;
+
+    m_assets = calloc((size_t)argc, sizeof(*m_assets));
+    if (m_assets == NULL)
+    {
+        perror("calloc");
+        return 1;
+    }
+    for (arg = 1; arg < argc; arg++)
+    {
+        if ((strcmp(argv[arg], "-o") == 0) && (arg + 1 < argc))
+        {
+            p_out = argv[++arg];
+        }
+        else if ((strcmp(argv[arg], "-b") == 0) && (arg + 1 < argc))
+        {
+            base = strtoul(argv[++arg], NULL, 0);
+        }
+        else
+        {
+            asset_t *    p_asset = &m_assets[m_count++];
+            char *       p_eq    = strchr(argv[arg], '=');
+            const char * p_slash;
+
+            if (p_eq != NULL)
+            {
+                *p_eq           = '\0';
+                p_asset->p_name = argv[arg];
+                p_asset->p_path = p_eq + 1;
+            }
+            else
+            {
+                p_slash         = strrchr(argv[arg], '/');
+                p_asset->p_name = (p_slash != NULL) ? p_slash + 1 : argv[arg];
+                p_asset->p_path = argv[arg];
+            }
+        }
+    }
+    if ((p_out == NULL) || (m_count == 0) || ((base % SST25_PAGE_SIZE) != 0))
+    {
+        fprintf(stderr, "usage: %s -o pack.bin [-b base] [name=]file ...\n", argv[0]);
+        return 1;
+    }
+
+    for (i = 0; i < m_count; i++)
+    {
+        m_assets[i].id     = SST_Asset_Id(m_assets[i].p_name);
+        m_assets[i].p_data = load_file(m_assets[i].p_path, &m_assets[i].length);
+        if (m_assets[i].id == SST_ASSET_ID_NONE)
+        {
+            fprintf(stderr, "%s: reserved ID, rename the asset\n", m_assets[i].p_name);
+            return 1;
+        }
+        for (j = 0; j < i; j++)
+        {
+            if (m_assets[j].id == m_assets[i].id)
+            {
+                fprintf(stderr, "%s and %s have the same ID %08X\n",
+                        m_assets[j].p_name, m_assets[i].p_name, m_assets[i].id);
+                return 1;
+            }
+        }
+    }
+
+    m_buckets = (m_count + SST_ASSET_BUCKET_KEYS - 1u) / SST_ASSET_BUCKET_KEYS;
+    m_slots   = m_count;
+    while (!build_directory())
+    {
+        m_slots += m_slots / 8u + 1u;
+    }
+
+    dir_end = sizeof(hdr) + ((2ul * m_buckets + 3u) & ~3ul) + m_slots * sizeof(sst_asset_entry_t);
+    size    = PAGE_ROUND(dir_end);
+    for (i = 0; i < m_count; i++)
+    {
+        m_assets[i].offset = size;
+        size              += PAGE_ROUND(m_assets[i].length);
+        payload           += m_assets[i].length;
+    }
+    if (!SST25_RANGE_VALID(base, size))
+    {
+        fprintf(stderr, "pack of %lu bytes does not fit the device at 0x%lX\n", size, base);
+        return 1;
+    }
+
+    p_image = malloc(size);
+    if (p_image == NULL)
+    {
+        perror("malloc");
+        return 1;
+    }
+    memset(p_image, 0xFF, size);
+    memcpy(&p_image[sizeof(hdr)], m_disp, 2ul * m_buckets);
+    for (i = 0; i < m_slots; i++)
+    {
+        sst_asset_entry_t entry = { SST_ASSET_ID_NONE, 0xFFFFFFFFul, 0xFFFFFFFFul, 0xFFFFFFFFul };
+
+        if (m_slot_owner[i] >= 0)
+        {
+            asset_t * p_asset = &m_assets[m_slot_owner[i]];
+
+            entry.id     = p_asset->id;
+            entry.offset = (uint32_t)p_asset->offset;
+            entry.length = (uint32_t)p_asset->length;
+            entry.crc    = SST_CRC32_Compute(p_asset->p_data, (uint32_t)p_asset->length, NULL);
+            memcpy(&p_image[p_asset->offset], p_asset->p_data, p_asset->length);
+        }
+        memcpy(&p_image[sizeof(hdr) + ((2ul * m_buckets + 3u) & ~3ul) + i * sizeof(entry)], &entry, sizeof(entry));
+    }
+
+    memset(&hdr, 0, sizeof(hdr));
+    hdr.magic       = SST_ASSET_MAGIC;
+    hdr.version     = SST_ASSET_VERSION;
+    hdr.count       = m_count;
+    hdr.buckets     = m_buckets;
+    hdr.slots       = m_slots;
+    hdr.data_offset = (uint32_t)PAGE_ROUND(dir_end);
+    hdr.dir_crc     = SST_CRC32_Compute(&p_image[sizeof(hdr)], (uint32_t)(dir_end - sizeof(hdr)), NULL);
+    hdr.header_crc  = SST_CRC32_Compute((uint8_t const *)&hdr, offsetof(sst_asset_header_t, header_crc), NULL);
+    memcpy(p_image, &hdr, sizeof(hdr));
+
+    // Check the image with the target code before writing it.
+    flash_sim_reset();
+    memcpy(&flash_sim_image[base], p_image, size);
+    if (SST_Asset_Open(&pack, base) != NRF_SUCCESS)
+    {
+        fprintf(stderr, "self check: SST_Asset_Open failed\n");
+        return 1;
+    }
+    printf("%-24s %8s %5s %8s %8s\n", "name", "id", "slot", "offset", "length");
+    for (i = 0; i < m_count; i++)
+    {
+        sst_asset_t asset;
+
+        flash_sim_stats_clear();
+        if ((SST_Asset_Find(&pack, m_assets[i].p_name, &asset) != NRF_SUCCESS) ||
+            (asset.addr != base + m_assets[i].offset) || (asset.length != m_assets[i].length) ||
+            (flash_sim_stats.transactions != 2) || (SST_Asset_Verify(&asset) != NRF_SUCCESS))
+        {
+            fprintf(stderr, "self check: lookup of %s failed\n", m_assets[i].p_name);
+            return 1;
+        }
+        printf("%-24s %08X %5u %8lX %8lu\n", m_assets[i].p_name, m_assets[i].id, m_assets[i].slot,
+               m_assets[i].offset, m_assets[i].length);
+    }
+    printf("\n%u assets, %u buckets, %u slots, directory %lu bytes, image %lu bytes (%lu payload)\n",
+           m_count, m_buckets, m_slots, dir_end, size, payload);
+
+    p_file = fopen(p_out, "wb");
+    if ((p_file == NULL) || (fwrite(p_image, 1, size, p_file) != size) || (fclose(p_file) != 0))
+    {
+        perror(p_out);
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,278 @@
+/**@file
+ * @brief Host access to flash content through the SST25VF064C driver itself.
+ *
+ * Runs SST25VF064C.c and the storage modules on a host transport (see
+ * SST25VF064C_transport.h): an image file mapped into memory, to prepare or
+ * inspect images at memory speed, or the same commands on a chip wired to
+ * a Linux spidev device.
+ *
+ * Build and run from the tools directory:
+ *     cc -O2 -DSST25_TRANSPORT_MMAP -I.. -o flash_image flash_image.c ../SST25VF064C.c ../SST25VF064C_mmap.c \
+ *         ../SST25VF064C_device.c ../SST25VF064C_crc32.c ../SST25VF064C_write.c ../SST25VF064C_patch.c ../SST25VF064C_scan.c
+ *     ./flash_image image.bin info
+ *     ./flash_image image.bin read offset length out.bin
+ *     ./flash_image image.bin write offset in.bin [spare]
+ *     ./flash_image image.bin erase offset length
+ *     ./flash_image image.bin crc offset length
+ *     ./flash_image image.bin patch patch.bin
+ *
+ * Build with -DSST25_TRANSPORT_SPIDEV and ../SST25VF064C_spidev.c instead of
+ * the mmap transport, and give e.g. /dev/spidev0.0, to work on a chip.
+ * write programs only what differs (SST25VF064C_write.c); a partly covered
+ * sector that needs an erase goes through the spare sector if one is given
+ * (two sectors: the spare and its tags), after finishing a copy-back an
+ * earlier run left behind.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "SST25VF064C.h"
+#include "SST25VF064C_transport.h"
+#include "SST25VF064C_crc32.h"
+#include "SST25VF064C_patch.h"
+#include "SST25VF064C_scan.h"
+#include "SST25VF064C_write.h"
+
+#define CHUNK   4096u
+
+static uint8_t     m_chunk[CHUNK];
+static sst_patch_t m_patch;
+
+static uint8_t * load_file(const char * p_path, unsigned long * p_len)
+{
+    FILE *    p_file = fopen(p_path, "rb");
+    uint8_t * p_data;
+    long      len;
+
+    if (p_file == NULL)
+    {
+        perror(p_path);
+        exit(1);
+    }
+    fseek(p_file, 0, SEEK_END);
+    len = ftell(p_file);
+    fseek(p_file, 0, SEEK_SET);
+    p_data = malloc(len ? (size_t)len : 1u);
+    if ((p_data == NULL) || (fread(p_data, 1, (size_t)len, p_file) != (size_t)len))
+    {
+        perror(p_path);
+        exit(1);
+    }
+    fclose(p_file);
+    *p_len = (unsigned long)len;
+    return p_data;
+}
+
+static int check(uint32_t err_code, const char * p_what)
+{
+    if (err_code != NRF_SUCCESS)
+    {
+        fprintf(stderr, "%s failed: error %u\n", p_what, (unsigned)err_code);
+        return 1;
+    }
+    return 0;
+}
+
+static int range(unsigned long offset, unsigned long len)
+{
+    if (!SST25_RANGE_VALID(offset, len))
+    {
+        fprintf(stderr, "0x%lx + %lu exceeds the %lu byte device\n", offset, len, (unsigned long)SST25_CAPACITY);
+        return 0;
+    }
+    return 1;
+}
+
+static int cmd_info(void)
+{
+    unsigned long used = 0;
+    unsigned long i;
+
+    SST_Scan_Chip();
+    for (i = 0; i < SST_SCAN_SECTORS; i++)
+    {
+        used += (sst_scan_bitmap[i / 32u] >> (i % 32u)) & 1u;
+    }
+    printf("jedec=%06lx part=%s capacity=%lu sck=%lu used=%lu/%lu sectors\n", (unsigned long)sst25_profile->jedec_id,
+           sst25_profile->p_name, (unsigned long)sst25_profile->capacity, SST25_SPI_Hz(), used,
+           (unsigned long)SST_SCAN_SECTORS);
+    return 0;
+}
+
+static int cmd_read(unsigned long offset, unsigned long len, const char * p_path)
+{
+    FILE * p_file = fopen(p_path, "wb");
+
+    if (p_file == NULL)
+    {
+        perror(p_path);
+        return 1;
+    }
+    while (len)
+    {
+        unsigned long n = (len > CHUNK) ? CHUNK : len;
+
+        HighSpeed_Read_Data(offset, m_chunk, n);
+        if (fwrite(m_chunk, 1, n, p_file) != n)
+        {
+            perror(p_path);
+            fclose(p_file);
+            return 1;
+        }
+        offset += n;
+        len    -= n;
+    }
+    fclose(p_file);
+    return check(SST25_Last_Error(), "read");
+}
+
+static int cmd_write(unsigned long offset, const char * p_path, const char * p_spare)
+{
+    unsigned long len;
+    uint8_t *     p_data = load_file(p_path, &len);
+    int           ret;
+
+    if (!range(offset, len))
+    {
+        free(p_data);
+        return 1;
+    }
+    if ((p_spare != NULL) &&
+        (check(SST_Write_Spare(strtoul(p_spare, NULL, 0)), "spare") || check(SST_Write_Recover(), "recover")))
+    {
+        free(p_data);
+        return 1;
+    }
+    ret = check(SST_Write_Elide(offset, p_data, len), "write");
+    free(p_data);
+    printf("pages programmed=%lu skipped=%lu sectors erased=%lu copied=%lu bytes elided=%lu\n",
+           sst_write_stats.pages_programmed, sst_write_stats.pages_skipped, sst_write_stats.sectors_erased,
+           sst_write_stats.sectors_copied, sst_write_stats.bytes_elided);
+    return ret;
+}
+
+static int cmd_erase(unsigned long offset, unsigned long len)
+{
+    unsigned long end = offset + len;
+
+    if (((offset % SST25_SECTOR_SIZE) != 0) || ((len % SST25_SECTOR_SIZE) != 0))
+    {
+        fprintf(stderr, "offset and length must be multiples of %u\n", SST25_SECTOR_SIZE);
+        return 1;
+    }
+    for (; offset < end; offset += SST25_SECTOR_SIZE)
+    {
+        if (check(Sector_Erase_Operation(offset), "erase"))
+        {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+static int cmd_crc(unsigned long offset, unsigned long len)
+{
+    uint32_t crc = 0;
+
+    while (len)
+    {
+        unsigned long n = (len > CHUNK) ? CHUNK : len;
+
+        crc     = HighSpeed_Read_Data_CRC(offset, m_chunk, n, &crc);
+        offset += n;
+        len    -= n;
+    }
+    printf("%08lx\n", (unsigned long)crc);
+    return check(SST25_Last_Error(), "read");
+}
+
+static int cmd_patch(const char * p_path)
+{
+    unsigned long len;
+    uint8_t *     p_data = load_file(p_path, &len);
+    int           ret;
+
+    if ((len >= sizeof(sst_patch_hdr_t)) &&
+        (SST_Patch_Check(((sst_patch_hdr_t const *)p_data)->base, ((sst_patch_hdr_t const *)p_data)->size,
+                         ((sst_patch_hdr_t const *)p_data)->old_crc) != NRF_SUCCESS))
+    {
+        fprintf(stderr, "%s: image does not match the patch's old CRC\n", p_path);
+        free(p_data);
+        return 1;
+    }
+    SST_Patch_Begin(&m_patch);
+    ret = check(SST_Patch_Write(&m_patch, p_data, len), "patch") || check(SST_Patch_End(&m_patch), "patch");
+    free(p_data);
+    if (ret == 0)
+    {
+        printf("sectors erased=%lu pages programmed=%lu\n", m_patch.erased, m_patch.programmed);
+    }
+    return ret;
+}
+
+int main(int argc, char ** argv)
+{
+    const char * p_cmd = (argc > 2) ? argv[2] : "";
+    int          ret;
+
+    if ((argc < 3) ||
+        ((strcmp(p_cmd, "read") == 0) && (argc != 6)) ||
+        ((strcmp(p_cmd, "write") == 0) && (argc != 5) && (argc != 6)) ||
+        (((strcmp(p_cmd, "erase") == 0) || (strcmp(p_cmd, "crc") == 0)) && (argc != 5)) ||
+        ((strcmp(p_cmd, "patch") == 0) && (argc != 4)))
+    {
+        fprintf(stderr, "usage: %s image|device info | read offset length out.bin | write offset in.bin [spare] |\n"
+                        "       erase offset length | crc offset length | patch patch.bin\n", argv[0]);
+        return 1;
+    }
+    if (check(SST25_Transport_Open(argv[1]), argv[1]))
+    {
+        return 1;
+    }
+    if (SST25VF064C_init() != NRF_SUCCESS)
+    {
+        fprintf(stderr, "%s: unknown JEDEC ID, assuming %s\n", argv[1], SST25_DEVICE_NAME);
+    }
+
+    if (strcmp(p_cmd, "info") == 0)
+    {
+        ret = cmd_info();
+    }
+    else if (strcmp(p_cmd, "read") == 0)
+    {
+        unsigned long offset = strtoul(argv[3], NULL, 0);
+        unsigned long len    = strtoul(argv[4], NULL, 0);
+
+        ret = range(offset, len) ? cmd_read(offset, len, argv[5]) : 1;
+    }
+    else if (strcmp(p_cmd, "write") == 0)
+    {
+        ret = cmd_write(strtoul(argv[3], NULL, 0), argv[4], (argc == 6) ? argv[5] : NULL);
+    }
+    else if (strcmp(p_cmd, "erase") == 0)
+    {
+        unsigned long offset = strtoul(argv[3], NULL, 0);
+        unsigned long len    = strtoul(argv[4], NULL, 0);
+
+        ret = range(offset, len) ? cmd_erase(offset, len) : 1;
+    }
+    else if (strcmp(p_cmd, "crc") == 0)
+    {
+        unsigned long offset = strtoul(argv[3], NULL, 0);
+        unsigned long len    = strtoul(argv[4], NULL, 0);
+
+        ret = range(offset, len) ? cmd_crc(offset, len) : 1;
+    }
+    else if (strcmp(p_cmd, "patch") == 0)
+    {
+        ret = cmd_patch(argv[3]);
+    }
+    else
+    {
+        fprintf(stderr, "unknown command %s\n", p_cmd);
+        ret = 1;
+    }
+    SST25_Transport_Close();
+    return ret;
+}
@@ -0,0 +1,489 @@
+/**@file
+ * @brief Host image builder and delta patch generator for SST25VF064C_patch.
+ *
+ * Builds the new flash image from files placed at offsets (the rest 0xFF),
+ * or takes a ready image, and compares it with the image on the devices:
+ * every sector is classified and its changed pages found by a pool of
+ * threads, then the records are emitted in address order. The patch is
+ * applied to the old image in the simulator through SST25VF064C_patch.c,
+ * in chunks of varying size, and the result checked before it is written;
+ * so is a staged apply that loses power half way and is run again.
+ *
+ * Build and run from the tools directory:
+ *     cc -O2 -pthread -DSST25VF064C_HOST -I.. -o flash_patch flash_patch.c flash_sim.c ../SST25VF064C_patch.c ../SST25VF064C_crc32.c
+ *     ./flash_patch -o patch.bin [-w new.bin] [-b base] [-s size] [-j threads] old.bin offset=file ...
+ *     ./flash_patch -o patch.bin [-b base] old.bin new.bin
+ *
+ * old.bin is the image last written to the devices, "-" for erased flash.
+ * Keep the image written with -w as old.bin of the next update.
+ */
+
+#include <pthread.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "flash_sim.h"
+#include "SST25VF064C_patch.h"
+#include "SST25VF064C_crc32.h"
+
+#define SECTOR_PAGES    (SST25_SECTOR_SIZE / SST25_PAGE_SIZE)
+#define SECTOR_ROUND(x) (((x) + SST25_SECTOR_SIZE - 1u) & ~(unsigned long)(SST25_SECTOR_SIZE - 1u))
+
+#define SECTOR_SAME     0u
+#define SECTOR_PROGRAM  1u      /* changes only clear bits, program the changed pages */
+#define SECTOR_ERASE    2u
+
+typedef struct
+{
+    unsigned long first;        /* sectors of this thread */
+    unsigned long last;
+} job_t;
+
+static uint8_t *     m_old;
+static uint8_t *     m_new;
+static uint8_t *     m_sector;          /* SECTOR_* per sector */
+static uint8_t *     m_page;            /* page to program, per page */
+static unsigned long m_size;
+
+static uint8_t *     m_patch;
+static unsigned long m_patch_len;
+static unsigned long m_patch_cap;
+static uint32_t      m_records;
+
+static uint8_t * load_file(const char * p_path, unsigned long * p_len)
+{
+    FILE *    p_file = fopen(p_path, "rb");
+    uint8_t * p_data;
+    long      len;
+
+    if (p_file == NULL)
+    {
+        perror(p_path);
+        exit(1);
+    }
+    fseek(p_file, 0, SEEK_END);
+    len = ftell(p_file);
+    fseek(p_file, 0, SEEK_SET);
+    p_data = malloc(len ? (size_t)len : 1u);
+    if ((p_data == NULL) || (fread(p_data, 1, (size_t)len, p_file) != (size_t)len))
+    {
+        perror(p_path);
+        exit(1);
+    }
+    fclose(p_file);
+    *p_len = (unsigned long)len;
+    return p_data;
+}
+
+static void save_file(const char * p_path, const uint8_t * p_data, unsigned long len)
+{
+    FILE * p_file = fopen(p_path, "wb");
+
+    if ((p_file == NULL) || (fwrite(p_data, 1, len, p_file) != len) || (fclose(p_file) != 0))
+    {
+        perror(p_path);
+        exit(1);
+    }
+}
+
+static bool blank(const uint8_t * p_data, unsigned long len)
+{
+    while (len--)
+    {
+        if (*p_data++ != 0xFF)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+static void * diff_thread(void * p_arg)
+{
+    job_t const * p_job = (job_t const *)p_arg;
+    unsigned long sector;
+
+    for (sector = p_job->first; sector < p_job->last; sector++)
+    {
+        unsigned long start   = sector * SST25_SECTOR_SIZE;
+        uint8_t       kind    = SECTOR_SAME;
+        unsigned long i;
+
+        if (memcmp(&m_old[start], &m_new[start], SST25_SECTOR_SIZE) != 0)
+        {
+            kind = SECTOR_PROGRAM;
+            for (i = start; i < start + SST25_SECTOR_SIZE; i++)
+            {
+                if ((m_old[i] & m_new[i]) != m_new[i])
+                {
+                    kind = SECTOR_ERASE;        /* a bit has to go from 0 to 1 */
+                    break;
+                }
+            }
+        }
+        m_sector[sector] = kind;
+        for (i = start; i < start + SST25_SECTOR_SIZE; i += SST25_PAGE_SIZE)
+        {
+            m_page[i / SST25_PAGE_SIZE] = (kind == SECTOR_ERASE)   ? !blank(&m_new[i], SST25_PAGE_SIZE)
+                                        : (kind == SECTOR_PROGRAM) ? (memcmp(&m_old[i], &m_new[i], SST25_PAGE_SIZE) != 0)
+                                                                   : 0;
+        }
+    }
+    return NULL;
+}
+
+static void emit(const void * p_data, unsigned long len)
+{
+    if (m_patch_len + len > m_patch_cap)
+    {
+        m_patch_cap = 2u * (m_patch_len + len);
+        m_patch     = realloc(m_patch, m_patch_cap);
+        if (m_patch == NULL)
+        {
+            perror("realloc");
+            exit(1);
+        }
+    }
+    memcpy(&m_patch[m_patch_len], p_data, len);
+    m_patch_len += len;
+}
+
+static void emit_record(uint8_t type, unsigned long offset, unsigned long count)
+{
+    sst_patch_rec_t rec;
+
+    while (count)
+    {
+        unsigned long n = (count > 0xFFFFu) ? 0xFFFFu : count;
+
+        memset(&rec, 0, sizeof(rec));
+        rec.type   = type;
+        rec.count  = (uint16_t)n;
+        rec.offset = (uint32_t)offset;
+        emit(&rec, sizeof(rec));
+        if (type == SST_PATCH_PROGRAM)
+        {
+            emit(&m_new[offset], n * SST25_PAGE_SIZE);
+        }
+        offset += n * ((type == SST_PATCH_PROGRAM) ? SST25_PAGE_SIZE : SST25_SECTOR_SIZE);
+        count  -= n;
+        m_records++;
+    }
+}
+
+/* Records in address order: an erase run, then the page runs behind it. */
+static void build_patch(void)
+{
+    unsigned long pages      = m_size / SST25_PAGE_SIZE;
+    unsigned long run_start  = 0;
+    unsigned long run_len    = 0;
+    unsigned long page;
+
+    for (page = 0; page < pages; page++)
+    {
+        if (((page % SECTOR_PAGES) == 0) && (m_sector[page / SECTOR_PAGES] == SECTOR_ERASE) &&
+            ((page == 0) || (m_sector[page / SECTOR_PAGES - 1u] != SECTOR_ERASE)))
+        {
+            unsigned long last = page / SECTOR_PAGES;
+
+            if (run_len)
+            {
+                emit_record(SST_PATCH_PROGRAM, run_start * SST25_PAGE_SIZE, run_len);
+                run_len = 0;
+            }
+            while ((last < m_size / SST25_SECTOR_SIZE) && (m_sector[last] == SECTOR_ERASE))
+            {
+                last++;
+            }
+            emit_record(SST_PATCH_ERASE, page * SST25_PAGE_SIZE, last - page / SECTOR_PAGES);
+        }
+        if (m_page[page])
+        {
+            if (run_len == 0)
+            {
+                run_start = page;
+            }
+            run_len++;
+        }
+        else if (run_len)
+        {
+            emit_record(SST_PATCH_PROGRAM, run_start * SST25_PAGE_SIZE, run_len);
+            run_len = 0;
+        }
+    }
+    if (run_len)
+    {
+        emit_record(SST_PATCH_PROGRAM, run_start * SST25_PAGE_SIZE, run_len);
+    }
+}
+
+/* Stages the patch in the simulator next to the old image, cuts the power
+ * after the first ops program and erase commands of SST_Patch_Apply and
+ * applies it again, as after a reset. */
+static bool verify_resume(unsigned long base, sst_patch_hdr_t const * p_hdr, unsigned long ops)
+{
+    unsigned long src = SST25_CAPACITY - SECTOR_ROUND(m_patch_len);
+    uint32_t      err_code;
+
+    if ((src < base + m_size) && (src + m_patch_len > base))
+    {
+        src = 0;
+        if (m_patch_len > base)
+        {
+            printf("resume: no room to stage the patch, not checked\n");
+            return true;
+        }
+    }
+    flash_sim_reset();
+    memcpy(&flash_sim_image[base], m_old, m_size);
+    memcpy(&flash_sim_image[src], m_patch, m_patch_len);
+    flash_sim_cut = ops + 2u;                       /* the applying marker and ops commands */
+    err_code      = SST_Patch_Apply(src, m_patch_len);
+    flash_sim_cut = 0;
+    if ((err_code == NRF_SUCCESS) && (p_hdr->old_crc != p_hdr->new_crc))
+    {
+        return false;
+    }
+    err_code = SST_Patch_Apply(src, m_patch_len);
+    printf("resume: cut after %lu commands, apply again %s\n", ops, (err_code == NRF_SUCCESS) ? "done" : "failed");
+    return (err_code == NRF_SUCCESS) && (memcmp(&flash_sim_image[base], m_new, m_size) == 0);
+}
+
+/* Applies the patch to the old image in the simulator with the target code. */
+static bool verify_patch(unsigned long base, sst_patch_hdr_t const * p_hdr)
+{
+    sst_patch_t   patch;
+    unsigned long done = 0;
+    unsigned long step = 1;
+    uint32_t      err_code = NRF_SUCCESS;
+
+    flash_sim_reset();
+    memcpy(&flash_sim_image[base], m_old, m_size);
+    if (SST_Patch_Check(base, m_size, p_hdr->old_crc) != NRF_SUCCESS)
+    {
+        return false;
+    }
+    flash_sim_stats_clear();
+    SST_Patch_Begin(&patch);
+    while ((done < m_patch_len) && (err_code == NRF_SUCCESS))
+    {
+        unsigned long n = (step > m_patch_len - done) ? (m_patch_len - done) : step;
+
+        err_code = SST_Patch_Write(&patch, &m_patch[done], n);
+        done    += n;
+        step     = (step * 7u + 3u) % 601u + 1u;    /* chunk sizes as from a radio link */
+    }
+    if ((err_code != NRF_SUCCESS) || (SST_Patch_End(&patch) != NRF_SUCCESS))
+    {
+        return false;
+    }
+    printf("applied: %lu sectors erased, %lu pages programmed, %.2f s flash time\n", patch.erased, patch.programmed,
+           flash_sim_stats.time_us / 1e6);
+    return (memcmp(&flash_sim_image[base], m_new, m_size) == 0) &&
+           (SST_Patch_Check(base, m_size, p_hdr->new_crc) == NRF_SUCCESS) &&
+           verify_resume(base, p_hdr, (patch.erased + patch.programmed) / 2u);
+}
+
+int main(int argc, char ** argv)
+{
+    const char *    p_out     = NULL;
+    const char *    p_write   = NULL;
+    const char *    p_old     = NULL;
+    unsigned long   base      = 0;
+    unsigned long   size      = 0;
+    unsigned long   old_len   = 0;
+    long            threads   = sysconf(_SC_NPROCESSORS_ONLN);
+    uint8_t *       p_loaded  = NULL;
+    pthread_t *     p_thread;
+    job_t *         p_job;
+    sst_patch_hdr_t hdr;
+    unsigned long   sectors;
+    unsigned long   i;
+    int             first_file;
+    int             arg;
+
+    for (arg = 1; arg < argc; arg++)
+    {
+        if ((strcmp(argv[arg], "-o") == 0) && (arg + 1 < argc))
+        {
+            p_out = argv[++arg];
+        }
+        else if ((strcmp(argv[arg], "-w") == 0) && (arg + 1 < argc))
+        {
+            p_write = argv[++arg];
+        }
+        else if ((strcmp(argv[arg], "-b") == 0) && (arg + 1 < argc))
+        {
+            base = strtoul(argv[++arg], NULL, 0);
+        }
+        else if ((strcmp(argv[arg], "-s") == 0) && (arg + 1 < argc))
+        {
+            size = strtoul(argv[++arg], NULL, 0);
+        }
+        else if ((strcmp(argv[arg], "-j") == 0) && (arg + 1 < argc))
+        {
+            threads = strtol(argv[++arg], NULL, 0);
+        }
+        else
+        {
+            break;
+        }
+    }
+    if ((p_out == NULL) || (arg + 2 > argc))
+    {
+        fprintf(stderr, "usage: %s -o patch.bin [-w new.bin] [-b base] [-s size] [-j threads] old.bin "
+                        "new.bin | offset=file ...\n", argv[0]);
+        return 1;
+    }
+    p_old      = argv[arg];
+    first_file = arg + 1;
+    threads    = (threads < 1) ? 1 : threads;
+
+    // Size of the image: given, or what the old image and the files need.
+    if (strcmp(p_old, "-") != 0)
+    {
+        p_loaded = load_file(p_old, &old_len);
+    }
+    if (size == 0)
+    {
+        size = old_len;
+        for (arg = first_file; arg < argc; arg++)
+        {
+            char *        p_eq   = strchr(argv[arg], '=');
+            unsigned long offset = (p_eq != NULL) ? strtoul(argv[arg], NULL, 0) : 0;
+            FILE *        p_file = fopen((p_eq != NULL) ? p_eq + 1 : argv[arg], "rb");
+            long          len;
+
+            if (p_file == NULL)
+            {
+                perror(argv[arg]);
+                return 1;
+            }
+            fseek(p_file, 0, SEEK_END);
+            len = ftell(p_file);
+            fclose(p_file);
+            size = (offset + (unsigned long)len > size) ? offset + (unsigned long)len : size;
+        }
+    }
+    m_size = SECTOR_ROUND(size);
+    if (((base % SST25_SECTOR_SIZE) != 0) || (m_size == 0) || !SST25_RANGE_VALID(base, m_size) || (old_len > m_size))
+    {
+        fprintf(stderr, "base must be sector aligned and base + %lu within the device, old image no larger\n", m_size);
+        return 1;
+    }
+
+    m_old    = malloc(m_size);
+    m_new    = malloc(m_size);
+    m_sector = malloc(m_size / SST25_SECTOR_SIZE);
+    m_page   = malloc(m_size / SST25_PAGE_SIZE);
+    if ((m_old == NULL) || (m_new == NULL) || (m_sector == NULL) || (m_page == NULL))
+    {
+        perror("malloc");
+        return 1;
+    }
+    memset(m_old, 0xFF, m_size);
+    memset(m_new, 0xFF, m_size);
+    if (p_loaded != NULL)
+    {
+        memcpy(m_old, p_loaded, old_len);
+        free(p_loaded);
+    }
+
+    // Build the new image.
+    for (arg = first_file; arg < argc; arg++)
+    {
+        char *        p_eq   = strchr(argv[arg], '=');
+        unsigned long offset = (p_eq != NULL) ? strtoul(argv[arg], NULL, 0) : 0;
+        unsigned long len;
+        uint8_t *     p_data = load_file((p_eq != NULL) ? p_eq + 1 : argv[arg], &len);
+
+        if ((offset > m_size) || (len > m_size - offset))
+        {
+            fprintf(stderr, "%s does not fit the image\n", argv[arg]);
+            return 1;
+        }
+        for (i = 0; i < len; i++)
+        {
+            if (m_new[offset + i] != 0xFF)
+            {
+                fprintf(stderr, "%s overlaps an earlier file at 0x%lx\n", argv[arg], offset + i);
+                return 1;
+            }
+        }
+        memcpy(&m_new[offset], p_data, len);
+        free(p_data);
+    }
+
+    // Diff, one contiguous share of the sectors per thread.
+    sectors  = m_size / SST25_SECTOR_SIZE;
+    threads  = ((unsigned long)threads > sectors) ? (long)sectors : threads;
+    p_thread = malloc((size_t)threads * sizeof(*p_thread));
+    p_job    = malloc((size_t)threads * sizeof(*p_job));
+    if ((p_thread == NULL) || (p_job == NULL))
+    {
+        perror("malloc");
+        return 1;
+    }
+    for (i = 0; i < (unsigned long)threads; i++)
+    {
+        p_job[i].first = sectors * i / (unsigned long)threads;
+        p_job[i].last  = sectors * (i + 1u) / (unsigned long)threads;
+        if (pthread_create(&p_thread[i], NULL, diff_thread, &p_job[i]) != 0)
+        {
+            perror("pthread_create");
+            return 1;
+        }
+    }
+    for (i = 0; i < (unsigned long)threads; i++)
+    {
+        pthread_join(p_thread[i], NULL);
+    }
+
+    // Header first, its CRCs once the records are known.
+    memset(&hdr, 0, sizeof(hdr));
+    emit(&hdr, sizeof(hdr));
+    build_patch();
+    hdr.magic       = SST_PATCH_MAGIC;
+    hdr.base        = (uint32_t)base;
+    hdr.size        = (uint32_t)m_size;
+    hdr.old_crc     = SST_CRC32_Compute(m_old, m_size, NULL);
+    hdr.new_crc     = SST_CRC32_Compute(m_new, m_size, NULL);
+    hdr.records     = m_records;
+    hdr.records_crc = SST_CRC32_Compute(&m_patch[sizeof(hdr)], m_patch_len - sizeof(hdr), NULL);
+    hdr.header_crc  = SST_CRC32_Compute((uint8_t const *)&hdr, offsetof(sst_patch_hdr_t, header_crc), NULL);
+    hdr.applying    = SST_PATCH_NEW;
+    memset(hdr.reserved, 0xFF, sizeof(hdr.reserved));
+    memcpy(m_patch, &hdr, sizeof(hdr));
+
+    {
+        unsigned long counts[3] = { 0, 0, 0 };
+        unsigned long pages     = 0;
+
+        for (i = 0; i < sectors; i++)
+        {
+            counts[m_sector[i]]++;
+        }
+        for (i = 0; i < m_size / SST25_PAGE_SIZE; i++)
+        {
+            pages += m_page[i];
+        }
+        printf("%lu sectors: %lu unchanged, %lu program only, %lu erase; %lu pages, %lu records, "
+               "patch %lu bytes (%.1f %% of the image), %ld threads\n", sectors, counts[SECTOR_SAME],
+               counts[SECTOR_PROGRAM], counts[SECTOR_ERASE], pages, (unsigned long)m_records, m_patch_len,
+               100.0 * m_patch_len / m_size, threads);
+    }
+
+    if (!verify_patch(base, &hdr))
+    {
+        fprintf(stderr, "patch does not reproduce the new image\n");
+        return 1;
+    }
+    save_file(p_out, m_patch, m_patch_len);
+    if (p_write != NULL)
+    {
+        save_file(p_write, m_new, m_size);
+    }
+    return 0;
+}
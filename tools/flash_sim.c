@@ -0,0 +1,534 @@
+/**@file
+ * @brief Host-side SST25VF064C simulator, see flash_sim.h.
+ */
+
+#include <assert.h>
+#include <string.h>
+#include "flash_sim.h"
+#include "SST25VF064C_crc32.h"
+
+uint8_t           flash_sim_image[FLASH_SIM_SIZE];
+flash_sim_stats_t flash_sim_stats;
+unsigned long     flash_sim_stuck;
+unsigned long     flash_sim_cut;
+sst25_health_t    sst25_health;
+
+unsigned char upper_128[SST25_PROG_CHUNK];
+unsigned char security_id_32[32];
+
+static uint8_t m_status;            /* BUSY is never observed, WEL/BP bits are kept. */
+static uint8_t m_sid[32];
+static bool    m_program_verify;
+static uint32_t m_error;
+
+static void sim_bus(unsigned long no_bytes)
+{
+    flash_sim_stats.transactions++;
+    flash_sim_stats.bus_bytes += no_bytes;
+    flash_sim_stats.time_us   += (no_bytes * 8.0 * 1000000.0) / FLASH_SIM_SPI_HZ;
+}
+
+static void sim_read(unsigned long Dst, uint8_t * p_dst, unsigned long no_bytes)
+{
+    unsigned long i;
+
+    for (i = 0; i < no_bytes; i++)
+    {
+        p_dst[i] = flash_sim_image[(Dst + i) & (FLASH_SIM_SIZE - 1)];
+    }
+    flash_sim_stats.read_bytes += no_bytes;
+}
+
+/* false once the power is cut, see flash_sim_cut. */
+static bool sim_powered(void)
+{
+    if (flash_sim_cut == 0)
+    {
+        return true;
+    }
+    if (flash_sim_cut == 1)
+    {
+        return false;
+    }
+    flash_sim_cut--;
+    return true;
+}
+
+static void sim_erase(unsigned long Dst, unsigned long size)
+{
+    if (!sim_powered())
+    {
+        return;
+    }
+    memset(&flash_sim_image[(Dst & (FLASH_SIM_SIZE - 1)) & ~(size - 1)], 0xFF, size);
+    flash_sim_stats.time_us += (size == FLASH_SIM_SIZE)    ? FLASH_SIM_T_CE_US
+                             : (size == SST25_SECTOR_SIZE) ? FLASH_SIM_T_SE_US : FLASH_SIM_T_BE_US;
+}
+
+void flash_sim_reset(void)
+{
+    memset(flash_sim_image, 0xFF, sizeof(flash_sim_image));
+    memset(m_sid, 0xFF, sizeof(m_sid));
+    m_status = 0;
+    m_error  = NRF_SUCCESS;
+    flash_sim_stuck = 0;
+    flash_sim_cut   = 0;
+    memset(&sst25_health, 0, sizeof(sst25_health));
+    flash_sim_stats_clear();
+}
+
+void flash_sim_stats_clear(void)
+{
+    memset(&flash_sim_stats, 0, sizeof(flash_sim_stats));
+}
+
+uint32_t SST25VF064C_init(void)
+{
+    return NRF_SUCCESS;
+}
+
+unsigned long SST25_SPI_Hz(void)
+{
+    return FLASH_SIM_SPI_HZ;
+}
+
+void Reset_Hold_Low(void)
+{
+}
+
+void Reset_Hold_High(void)
+{
+}
+
+void WP_Low(void)
+{
+}
+
+void WP_High(void)
+{
+}
+
+unsigned char Read_Status_Register(void)
+{
+    sim_bus(2);
+    return m_status;
+}
+
+void EWSR(void)
+{
+    sim_bus(1);
+}
+
+void WRSR(uint8_t byte)
+{
+    sim_bus(2);
+    m_status = byte & 0xBC;
+}
+
+void WREN(void)
+{
+    sim_bus(1);
+    m_status |= 0x02;
+}
+
+void WRDI(void)
+{
+    sim_bus(1);
+    m_status &= (uint8_t)~0x02;
+}
+
+unsigned long Read_ID(uint8_t ID_addr)
+{
+    sim_bus(6);
+    return (ID_addr & 0x01) ? 0x4BBFul : 0xBF4Bul;
+}
+
+unsigned long Jedec_ID_Read(void)
+{
+    sim_bus(4);
+    return 0xBF254Bul;
+}
+
+unsigned char Read(unsigned long Dst)
+{
+    uint8_t byte;
+
+    sim_bus(5);
+    sim_read(Dst, &byte, 1);
+    return byte;
+}
+
+void Read_Cont(unsigned long Dst, unsigned long no_bytes)
+{
+    assert(no_bytes <= sizeof(upper_128));
+    sim_bus(4 + no_bytes);
+    sim_read(Dst, upper_128, no_bytes);
+}
+
+unsigned char HighSpeed_Read(unsigned long Dst)
+{
+    uint8_t byte;
+
+    sim_bus(6);
+    sim_read(Dst, &byte, 1);
+    return byte;
+}
+
+void HighSpeed_Read_Cont(unsigned long Dst, unsigned long no_bytes)
+{
+    assert(no_bytes <= sizeof(upper_128));
+    sim_bus(5 + no_bytes);
+    sim_read(Dst, upper_128, no_bytes);
+}
+
+void HighSpeed_Read_Data(unsigned long Dst, unsigned char * p_data, unsigned long no_bytes)
+{
+    sim_bus(5 * ((no_bytes + SST25_READ_BURST - 1) / SST25_READ_BURST) + no_bytes);
+    sim_read(Dst, p_data, no_bytes);
+}
+
+uint32_t HighSpeed_Read_Data_CRC(unsigned long Dst, unsigned char * p_data, unsigned long no_bytes, uint32_t const * p_crc)
+{
+    HighSpeed_Read_Data(Dst, p_data, no_bytes);
+    return SST_CRC32_Compute(p_data, no_bytes, p_crc);
+}
+
+/* Completes at once, the handler runs before the call returns. */
+uint32_t HighSpeed_Read_Async(unsigned long Dst, unsigned char * p_buf, unsigned short no_bytes, sst25_async_handler_t handler)
+{
+    if (no_bytes > SST25_ASYNC_MAX)
+    {
+        return NRF_ERROR_DATA_SIZE;
+    }
+    sim_bus(SST25_ASYNC_HEADER + no_bytes);
+    memset(p_buf, 0xFF, SST25_ASYNC_HEADER);
+    sim_read(Dst, p_buf + SST25_ASYNC_HEADER, no_bytes);
+    handler();
+    return NRF_SUCCESS;
+}
+
+bool Read_Async_Busy(void)
+{
+    return false;
+}
+
+void HighSpeed_Read_Scatter(unsigned long Dst, sst25_sg_t const * p_sg, uint8_t count)
+{
+    unsigned long len = 0;
+    uint8_t       i;
+
+    assert(count <= SST25_SCATTER_SEGS);
+    for (i = 0; i < count; i++)
+    {
+        if (p_sg[i].p_rx != NULL)
+        {
+            sim_read(Dst + len, p_sg[i].p_rx, p_sg[i].len);
+        }
+        len += p_sg[i].len;
+    }
+    sim_bus(5 + len);
+}
+
+bool Verify_Data(unsigned long Dst, const unsigned char * p_data, unsigned long no_bytes)
+{
+    unsigned long i;
+
+    sim_bus(5 * ((no_bytes + SST25_READ_CHUNK - 1) / SST25_READ_CHUNK) + no_bytes);
+    for (i = 0; i < no_bytes; i++)
+    {
+        if (flash_sim_image[(Dst + i) & (FLASH_SIM_SIZE - 1)] != p_data[i])
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+void Program_Verify_Enable(bool enable)
+{
+    m_program_verify = enable;
+}
+
+void Chip_Erase(void)
+{
+    sim_bus(1);
+    sim_erase(0, FLASH_SIM_SIZE);
+    flash_sim_stats.erases_chip++;
+}
+
+void Sector_Erase(unsigned long Dst)
+{
+    sim_bus(4);
+    sim_erase(Dst, SST25_SECTOR_SIZE);
+    flash_sim_stats.erases_4k++;
+}
+
+#if SST25_BLOCK_32K_SIZE
+void Block_Erase_32K(unsigned long Dst)
+{
+    sim_bus(4);
+    sim_erase(Dst, SST25_BLOCK_32K_SIZE);
+    flash_sim_stats.erases_32k++;
+}
+#endif
+
+void Block_Erase_64K(unsigned long Dst)
+{
+    sim_bus(4);
+#if SST25_BLOCK_64K_SIZE
+    sim_erase(Dst, SST25_BLOCK_64K_SIZE);
+#else
+    sim_erase(Dst, 0x10000);                /* middle of an SST26 array */
+#endif
+    flash_sim_stats.erases_64k++;
+}
+
+void Page_Program(unsigned long Dst)
+{
+    unsigned long i;
+
+    sim_bus(4 + SST25_PROG_CHUNK);
+    if (!sim_powered())
+    {
+        return;
+    }
+    for (i = 0; i < SST25_PROG_CHUNK; i++)
+    {
+        /* Stays within the 256 byte page, like the device does. */
+        unsigned long a = (Dst & ~0xFFul) | ((Dst + i) & 0xFF);
+        flash_sim_image[a & (FLASH_SIM_SIZE - 1)] &= upper_128[i];
+    }
+    flash_sim_stats.programs++;
+    flash_sim_stats.program_bytes += SST25_PROG_CHUNK;
+    flash_sim_stats.time_us += FLASH_SIM_T_PP_US;
+}
+
+void Page_Program_Data(unsigned long Dst, const unsigned char * p_data, unsigned short no_bytes)
+{
+    unsigned short i;
+
+    if (no_bytes > SST25_PAGE_SIZE)
+    {
+        no_bytes = SST25_PAGE_SIZE;
+    }
+    sim_bus(4ul + no_bytes);
+    if (!sim_powered())
+    {
+        return;
+    }
+    for (i = 0; i < no_bytes; i++)
+    {
+        unsigned long a = (Dst & ~0xFFul) | ((Dst + i) & 0xFF);
+        flash_sim_image[a & (FLASH_SIM_SIZE - 1)] &= p_data[i];
+    }
+    flash_sim_stats.programs++;
+    flash_sim_stats.program_bytes += no_bytes;
+    flash_sim_stats.time_us += FLASH_SIM_T_PP_US;
+}
+
+uint32_t Wait_Busy(void)
+{
+    return Wait_Busy_Timeout(SST25_TIMEOUT_US(SST25_T_CE_MAX_US));
+}
+
+/* The modelled device is never busy; flash_sim_stuck makes it look stuck
+ * for the whole deadline. */
+uint32_t Wait_Busy_Timeout(unsigned long timeout_us)
+{
+    Read_Status_Register();
+    if (flash_sim_stuck)
+    {
+        flash_sim_stuck--;
+        flash_sim_stats.time_us += timeout_us;
+        sst25_health.timeouts++;
+        if (m_error == NRF_SUCCESS)
+        {
+            m_error = NRF_ERROR_TIMEOUT;
+        }
+        return NRF_ERROR_TIMEOUT;
+    }
+    return NRF_SUCCESS;
+}
+
+uint32_t SST25_Recover(void)
+{
+    sst25_health.resets++;
+    flash_sim_stats.time_us += SST25_T_RECOVERY_US;
+    m_error = NRF_SUCCESS;
+    return NRF_SUCCESS;
+}
+
+uint32_t SST25_Last_Error(void)
+{
+    uint32_t err_code = m_error;
+
+    m_error = NRF_SUCCESS;
+    return err_code;
+}
+
+/* One attempt of an *_Operation failed: true to reset and repeat it. */
+static bool sim_retry(uint32_t err_code, uint8_t * p_tries)
+{
+    if ((err_code == NRF_SUCCESS) || (*p_tries >= SST25_RETRIES))
+    {
+        return false;
+    }
+    (*p_tries)++;
+    sst25_health.retries++;
+    SST25_Recover();
+    return true;
+}
+
+void EHLD(void)
+{
+    sim_bus(1);
+}
+
+#if SST25_HAS_ULBPR
+void ULBPR(void)
+{
+    sim_bus(1);
+}
+#endif
+
+#if SST25_SID_SIZE
+void ReadSID(unsigned char Dst, unsigned char security_length)
+{
+    unsigned char i;
+
+    if (security_length > 32)
+    {
+        security_length = 32;
+    }
+    sim_bus(3 + Dst + security_length);
+    for (i = 0; i < security_length; i++)
+    {
+        security_id_32[i] = m_sid[(Dst + i) & 31];
+    }
+}
+
+void ProgSID(void)
+{
+    unsigned char i;
+
+    sim_bus(2 + 24);
+    for (i = 8; i < 32; i++)
+    {
+        m_sid[i] &= security_id_32[i];
+    }
+}
+
+void LockSID(void)
+{
+    sim_bus(1);
+}
+#endif
+
+#if SST25_BLOCK_32K_SIZE
+uint32_t Block_Erase_32K_Operation(unsigned long Dst)
+{
+    uint8_t  tries = 0;
+    uint32_t err_code;
+
+    do
+    {
+        SST25_Last_Error();
+        WREN();
+        Block_Erase_32K(Dst);
+        err_code = Wait_Busy_Timeout(SST25_TIMEOUT_US(SST25_T_BE_MAX_US));
+    } while (sim_retry(err_code, &tries));
+    return err_code;
+}
+#endif
+
+
+uint32_t Block_Erase_64K_Operation(unsigned long Dst)
+{
+    uint8_t  tries = 0;
+    uint32_t err_code;
+
+    do
+    {
+        SST25_Last_Error();
+        WREN();
+        Block_Erase_64K(Dst);
+        err_code = Wait_Busy_Timeout(SST25_TIMEOUT_US(SST25_T_BE_MAX_US));
+    } while (sim_retry(err_code, &tries));
+    return err_code;
+}
+
+uint32_t Sector_Erase_Operation(unsigned long Dst)
+{
+    uint8_t  tries = 0;
+    uint32_t err_code;
+
+    do
+    {
+        SST25_Last_Error();
+        WREN();
+        Sector_Erase(Dst);
+        err_code = Wait_Busy_Timeout(SST25_TIMEOUT_US(SST25_T_SE_MAX_US));
+    } while (sim_retry(err_code, &tries));
+    return err_code;
+}
+
+uint32_t Page_Program_Operation(unsigned long Dst)
+{
+    uint8_t  tries = 0;
+    uint32_t err_code;
+
+    do
+    {
+        SST25_Last_Error();
+        WREN();
+        Page_Program(Dst);
+        err_code = Wait_Busy_Timeout(SST25_TIMEOUT_US(SST25_T_PP_MAX_US));
+    } while (sim_retry(err_code, &tries));
+    if (err_code != NRF_SUCCESS)
+    {
+        return err_code;
+    }
+    if (m_program_verify && !Verify_Data(Dst, upper_128, SST25_PROG_CHUNK))
+    {
+        return NRF_ERROR_INVALID_DATA;
+    }
+    return NRF_SUCCESS;
+}
+
+uint32_t Page_Program_Data_Operation(unsigned long Dst, const unsigned char * p_data, unsigned short no_bytes)
+{
+    uint8_t  tries = 0;
+    uint32_t err_code;
+
+    do
+    {
+        SST25_Last_Error();
+        WREN();
+        Page_Program_Data(Dst, p_data, no_bytes);
+        err_code = Wait_Busy_Timeout(SST25_TIMEOUT_US(SST25_T_PP_MAX_US));
+    } while (sim_retry(err_code, &tries));
+    if (err_code != NRF_SUCCESS)
+    {
+        return err_code;
+    }
+    if (m_program_verify && !Verify_Data(Dst, p_data, no_bytes))
+    {
+        return NRF_ERROR_INVALID_DATA;
+    }
+    return NRF_SUCCESS;
+}
+
+uint32_t Chip_Erase_Operation(void)
+{
+    uint8_t  tries = 0;
+    uint32_t err_code;
+
+    do
+    {
+        SST25_Last_Error();
+        WREN();
+        Chip_Erase();
+        err_code = Wait_Busy_Timeout(SST25_TIMEOUT_US(SST25_T_CE_MAX_US));
+    } while (sim_retry(err_code, &tries));
+    return err_code;
+}
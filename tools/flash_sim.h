@@ -0,0 +1,50 @@
+/**@file
+ * @brief Host-side SST25VF064C simulator.
+ *
+ * Implements the driver API of SST25VF064C.h on an 8 MByte RAM image with
+ * NOR semantics (programming can only clear bits, erase sets them) and a
+ * simple timing model, so the storage layers can be exercised and
+ * benchmarked on a PC. Build with SST25VF064C_HOST defined.
+ */
+
+#ifndef FLASH_SIM_H__
+#define FLASH_SIM_H__
+
+#include <stdint.h>
+#include "SST25VF064C.h"
+
+#define FLASH_SIM_SIZE          SST25_CAPACITY      /**< Selected device, see SST25VF064C_device.h. */
+#define FLASH_SIM_SPI_HZ        8000000ul           /**< nRF51 SPI master maximum. */
+#define FLASH_SIM_T_PP_US       SST25_T_PP_TYP_US   /**< Page-Program, typical. */
+#define FLASH_SIM_T_SE_US       SST25_T_SE_TYP_US   /**< Sector-Erase, typical. */
+#define FLASH_SIM_T_BE_US       SST25_T_BE_TYP_US   /**< Block-Erase, typical. */
+#define FLASH_SIM_T_CE_US       SST25_T_CE_TYP_US   /**< Chip-Erase, typical. */
+
+/**@brief Operation counters and simulated bus/array time. */
+typedef struct
+{
+    unsigned long transactions;     /**< SPI transactions (one per chip select). */
+    unsigned long bus_bytes;        /**< Bytes clocked on the bus, header included. */
+    unsigned long read_bytes;       /**< Array bytes returned by read commands. */
+    unsigned long programs;         /**< Page program commands. */
+    unsigned long program_bytes;    /**< Bytes sent with page program commands. */
+    unsigned long erases_4k;
+    unsigned long erases_32k;
+    unsigned long erases_64k;
+    unsigned long erases_chip;
+    double        time_us;          /**< Bus time plus internal program/erase time. */
+} flash_sim_stats_t;
+
+extern uint8_t           flash_sim_image[FLASH_SIM_SIZE];
+extern flash_sim_stats_t flash_sim_stats;
+extern unsigned long     flash_sim_stuck;   /**< Busy waits still to time out, to exercise the retry path. */
+extern unsigned long     flash_sim_cut;     /**< n + 1 lets n more program and erase commands take effect, later
+                                                 ones are lost as after a power cut until it is set to 0. */
+
+/**@brief Fill the image with 0xFF and clear the counters. */
+void flash_sim_reset(void);
+
+/**@brief Clear the counters only. */
+void flash_sim_stats_clear(void);
+
+#endif /* FLASH_SIM_H__ */
@@ -0,0 +1,176 @@
+/**@file
+ * @brief Host benchmark for the SST25VF064C_lz block compression.
+ *
+ * Compresses sample data into the simulated chip, decompresses and verifies
+ * it, and prints compression ratio, codec throughput and the modelled flash
+ * time against storing the data uncompressed.
+ *
+ * Build and run from the tools directory:
+ *     cc -O2 -DSST25VF064C_HOST -I.. -o lz_bench lz_bench.c flash_sim.c ../SST25VF064C_lz.c ../SST25VF064C_crc32.c
+ *     ./lz_bench [file ...]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "flash_sim.h"
+#include "SST25VF064C_lz.h"
+
+#define SAMPLE_SIZE     (64u * 1024u)
+#define REGION_SIZE     (1024ul * 1024ul)
+
+static uint8_t m_sample[4u * 1024u * 1024u];
+static uint8_t m_check[sizeof(m_sample)];
+
+static double now_s(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static unsigned long sample_log(uint8_t * p)
+{
+    static const char * const events[] = { "adv", "conn", "disc", "temp_hi", "batt_lo" };
+    unsigned long len = 0;
+    unsigned long t   = 1000;
+
+    srand(1);
+    while (len < SAMPLE_SIZE - 80)
+    {
+        t   += (unsigned long)(rand() % 50);
+        len += (unsigned long)sprintf((char *)&p[len], "t=%lu temp=%d.%d hum=%d evt=%s\n",
+                                      t, 20 + rand() % 3, rand() % 10, 40 + rand() % 5,
+                                      events[rand() % 5]);
+    }
+    return len;
+}
+
+static unsigned long sample_sensor(uint8_t * p)
+{
+    unsigned long i;
+    int           v = 0;
+
+    srand(2);
+    for (i = 0; i < SAMPLE_SIZE; i += 2)
+    {
+        v += (rand() % 5) - 2;
+        p[i]     = (uint8_t)(v & 0xFF);
+        p[i + 1] = (uint8_t)((v >> 8) & 0xFF);
+    }
+    return SAMPLE_SIZE;
+}
+
+static unsigned long sample_snapshot(uint8_t * p)
+{
+    unsigned long i;
+
+    srand(3);
+    memset(p, 0, SAMPLE_SIZE);
+    for (i = 0; i < SAMPLE_SIZE; i += 256)
+    {
+        /* Sparse structures: a few pointers and counters per 256 bytes. */
+        uint32_t w = 0x20000000u + (uint32_t)(rand() % 0x4000);
+        memcpy(&p[i], &w, sizeof(w));
+        p[i + 8 + rand() % 64] = (uint8_t)rand();
+    }
+    return SAMPLE_SIZE;
+}
+
+static unsigned long sample_random(uint8_t * p)
+{
+    unsigned long i;
+
+    srand(4);
+    for (i = 0; i < SAMPLE_SIZE; i++)
+    {
+        p[i] = (uint8_t)rand();
+    }
+    return SAMPLE_SIZE;
+}
+
+static int bench(const char * name, const uint8_t * p_data, unsigned long len)
+{
+    static sst_lz_writer_t writer;
+    static sst_lz_reader_t reader;
+    unsigned long          sectors;
+    unsigned long          got = 0;
+    double                 t0, t_enc, t_dec, flash_lz, flash_raw, raw_erase;
+
+    flash_sim_reset();
+    t0 = now_s();
+    SST_LZ_Write_Begin(&writer, 0, REGION_SIZE);
+    SST_LZ_Write(&writer, p_data, len);
+    sectors  = SST_LZ_Write_End(&writer);
+    t_enc    = now_s() - t0;
+    flash_lz = flash_sim_stats.time_us;
+    if (sectors == 0)
+    {
+        printf("%-10s region overflow\n", name);
+        return 1;
+    }
+
+    flash_sim_stats_clear();
+    t0 = now_s();
+    if (SST_LZ_Read_Open(&reader, 0) >= 0)
+    {
+        unsigned long n;
+        while ((n = SST_LZ_Read(&reader, &m_check[got], 1000)) != 0)
+        {
+            got += n;
+        }
+    }
+    t_dec = now_s() - t0;
+    if ((got != len) || memcmp(m_check, p_data, len))
+    {
+        printf("%-10s MISMATCH (%lu of %lu bytes)\n", name, got, len);
+        return 1;
+    }
+
+    /* Uncompressed: one erase per sector, one 128 byte program per chunk. */
+    raw_erase = ((len + SST25_SECTOR_SIZE - 1) / SST25_SECTOR_SIZE) * (double)FLASH_SIM_T_SE_US;
+    flash_raw = raw_erase + ((len + 127) / 128)
+              * (FLASH_SIM_T_PP_US + (132 + 1 + 2) * 8.0 * 1e6 / FLASH_SIM_SPI_HZ);
+
+    printf("%-10s %8lu %8lu %6.3f %10.0f %10.0f %8lu %9.1f %9.1f %6.2fx\n",
+           name, len, writer.comp_total, (double)writer.comp_total / len,
+           len / t_enc, len / t_dec, sectors,
+           flash_raw / 1000.0, flash_lz / 1000.0, flash_raw / flash_lz);
+    return 0;
+}
+
+int main(int argc, char ** argv)
+{
+    int           err = 0;
+    unsigned long len;
+    int           i;
+
+    printf("%-10s %8s %8s %6s %10s %10s %8s %9s %9s %7s\n",
+           "sample", "raw", "stored", "ratio", "enc B/s", "dec B/s", "sectors",
+           "raw ms", "lz ms", "speedup");
+
+    len = sample_log(m_sample);      err |= bench("log", m_sample, len);
+    len = sample_sensor(m_sample);   err |= bench("sensor", m_sample, len);
+    len = sample_snapshot(m_sample); err |= bench("snapshot", m_sample, len);
+    len = sample_random(m_sample);   err |= bench("random", m_sample, len);
+
+    for (i = 1; i < argc; i++)
+    {
+        FILE * f = fopen(argv[i], "rb");
+        if (f == NULL)
+        {
+            perror(argv[i]);
+            err = 1;
+            continue;
+        }
+        len = (unsigned long)fread(m_sample, 1, sizeof(m_sample), f);
+        fclose(f);
+        if (len > REGION_SIZE)
+        {
+            len = REGION_SIZE;
+        }
+        err |= bench(argv[i], m_sample, len);
+    }
+    return err;
+}
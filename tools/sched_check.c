@@ -0,0 +1,109 @@
+/**@file
+ * @brief Host check of SST25VF064C_sched against the simulator.
+ *
+ * Submits requests that have to be refused (zero length, unaligned erase,
+ * range beyond the device), then an erase, a program and a read of the
+ * same area and checks that the read, queued last, completes first and
+ * the others leave the programmed data in flash. Exits with 0 when every
+ * check passes.
+ *
+ * Build and run from the tools directory:
+ *     cc -O2 -DSST25VF064C_HOST -I.. -o sched_check sched_check.c flash_sim.c ../SST25VF064C_sched.c ../SST25VF064C_crc32.c
+ *     ./sched_check
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include "flash_sim.h"
+#include "SST25VF064C_sched.h"
+
+#define AREA        0x10000ul
+#define DATA_LEN    600u
+
+static uint8_t  m_data[DATA_LEN];
+static uint8_t  m_read[DATA_LEN];
+static unsigned m_order;            /* completions so far */
+static unsigned m_failed;
+
+static void check(bool ok, const char * p_what)
+{
+    printf("%-48s %s\n", p_what, ok ? "ok" : "FAILED");
+    m_failed += ok ? 0u : 1u;
+}
+
+static void done(sst_sched_req_t * p_req, uint32_t result)
+{
+    *(unsigned *)p_req->p_context = (result == NRF_SUCCESS) ? ++m_order : 0xFFFFu;
+}
+
+static uint32_t submit(sst_sched_op_t op, unsigned long addr, unsigned long len)
+{
+    sst_sched_req_t req;
+
+    memset(&req, 0, sizeof(req));
+    req.op     = op;
+    req.addr   = addr;
+    req.len    = len;
+    req.p_data = m_read;
+    return SST_Sched_Submit(&req);
+}
+
+int main(void)
+{
+    sst_sched_req_t erase;
+    sst_sched_req_t program;
+    sst_sched_req_t read;
+    unsigned        erase_pos   = 0;
+    unsigned        program_pos = 0;
+    unsigned        read_pos    = 0;
+    uint32_t        now         = 0;
+    unsigned long   i;
+
+    flash_sim_reset();
+    memset(&flash_sim_image[AREA], 0x00, SST25_SECTOR_SIZE);
+    for (i = 0; i < DATA_LEN; i++)
+    {
+        m_data[i] = (uint8_t)(i * 7u + 1u);
+    }
+
+    check(submit(SST_SCHED_READ, AREA, 0) == NRF_ERROR_INVALID_PARAM, "read of 0 bytes refused");
+    check(submit(SST_SCHED_PROGRAM, AREA, 0) == NRF_ERROR_INVALID_PARAM, "program of 0 bytes refused");
+    check(submit(SST_SCHED_ERASE, AREA, 0) == NRF_ERROR_INVALID_PARAM, "erase of 0 bytes refused");
+    check(submit(SST_SCHED_ERASE, AREA + 1u, SST25_SECTOR_SIZE) == NRF_ERROR_INVALID_PARAM, "unaligned erase refused");
+    check(submit(SST_SCHED_READ, SST25_CAPACITY - 1u, 2) == NRF_ERROR_INVALID_ADDR, "read beyond the device refused");
+    check(!SST_Sched_Process(now), "nothing queued after refused requests");
+
+    memset(&erase, 0, sizeof(erase));
+    erase.op         = SST_SCHED_ERASE;
+    erase.addr       = AREA;
+    erase.len        = SST25_SECTOR_SIZE;
+    erase.deadline   = 1000000u;    /* none overdue, reads go first */
+    erase.callback   = done;
+    erase.p_context  = &erase_pos;
+    program          = erase;
+    program.op       = SST_SCHED_PROGRAM;
+    program.addr     = AREA + 100u;
+    program.len      = DATA_LEN;
+    program.p_data   = m_data;
+    program.p_context = &program_pos;
+    read             = erase;
+    read.op          = SST_SCHED_READ;
+    read.addr        = AREA + 2u * SST25_SECTOR_SIZE;
+    read.len         = DATA_LEN;
+    read.p_data      = m_read;
+    read.p_context   = &read_pos;
+
+    check((SST_Sched_Submit(&erase) == NRF_SUCCESS) && (SST_Sched_Submit(&program) == NRF_SUCCESS) &&
+          (SST_Sched_Submit(&read) == NRF_SUCCESS), "erase, program and read queued");
+    while (SST_Sched_Process(now) && (now < 100000u))
+    {
+        now++;
+    }
+    check(read_pos == 1u, "read queued last completed first");
+    check((erase_pos == 2u) && (program_pos == 3u), "erase completed ahead of the program");
+    check(memcmp(&flash_sim_image[AREA + 100u], m_data, DATA_LEN) == 0, "programmed data in flash");
+    check((flash_sim_image[AREA] == 0xFF) && (flash_sim_image[AREA + SST25_SECTOR_SIZE - 1u] == 0xFF),
+          "rest of the sector erased");
+
+    return (m_failed == 0) ? 0 : 1;
+}
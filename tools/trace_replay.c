@@ -0,0 +1,316 @@
+/**@file
+ * @brief Host replay and profiler for SST25VF064C_trace dumps.
+ *
+ * Reads the text dump written by SST_Trace_Dump (a UART capture, other
+ * output around the dump is skipped, several dumps are concatenated),
+ * replays every command against the simulator and prints a per-opcode
+ * breakdown of measured and modelled time followed by a timeline.
+ *
+ * Build and run from the tools directory:
+ *     cc -O2 -DSST25VF064C_HOST -I.. -o trace_replay trace_replay.c flash_sim.c ../SST25VF064C_crc32.c
+ *     ./trace_replay [-n timeline_rows] capture.txt
+ *
+ * -n 0 prints the whole timeline, the default is the first 64 records.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "flash_sim.h"
+#include "SST25VF064C_trace.h"
+
+#define BAR_WIDTH       40
+
+typedef struct
+{
+    uint8_t       op;
+    unsigned long addr;
+    unsigned long length;
+    unsigned long polls;
+    double        t_us;         /* start, relative to the first record */
+    double        dur_us;       /* measured, busy polls included */
+    double        model_us;     /* simulator time */
+} record_t;
+
+typedef struct
+{
+    unsigned long count;
+    unsigned long bytes;
+    unsigned long polls;
+    double        measured_us;
+    double        max_us;
+    double        model_us;
+} op_stats_t;
+
+static record_t *    m_recs;
+static unsigned long m_count;
+static unsigned long m_lost;
+static op_stats_t    m_ops[256];
+static uint8_t       m_buf[0x10000];
+
+static const char * op_name(uint8_t op)
+{
+    switch (op)
+    {
+        case 0x00: return "(cont)";
+        case 0x01: return "WRSR";
+        case 0x02: return "PP";
+        case 0x03: return "READ";
+        case 0x04: return "WRDI";
+        case 0x05: return "RDSR";
+        case 0x06: return "WREN";
+        case 0x0B: return "FAST_READ";
+        case 0x20: return "SE_4K";
+        case 0x50: return "EWSR";
+        case 0x52: return "BE_32K";
+        case 0x60: return "CE";
+        case 0x85: return "LOCK_SID";
+        case 0x88: return "READ_SID";
+        case 0x90: return "READ_ID";
+        case 0x9F: return "JEDEC_ID";
+        case 0xA5: return "PROG_SID";
+        case 0xAA: return "EHLD";
+        case 0xAD: return "AAI";
+        case 0xC7: return "CE";
+        case 0xD8: return "BE_64K";
+        default:   return "?";
+    }
+}
+
+static unsigned long payload(unsigned long length, unsigned long header)
+{
+    return (length > header) ? length - header : 0;
+}
+
+/* Runs one record on the simulator and returns the modelled time. */
+static double replay(const record_t * p_rec)
+{
+    double before = flash_sim_stats.time_us;
+
+    switch (p_rec->op)
+    {
+        case 0x01: WRSR(0);                                                            break;
+        case 0x02: Page_Program_Data(p_rec->addr, m_buf, (unsigned short)payload(p_rec->length, 4)); break;
+        case 0x03: HighSpeed_Read_Data(p_rec->addr, m_buf, payload(p_rec->length, 4)); break;
+        case 0x04: WRDI();                                                             break;
+        case 0x05: Read_Status_Register();                                             break;
+        case 0x06: WREN();                                                             break;
+        case 0x0B: HighSpeed_Read_Data(p_rec->addr, m_buf, payload(p_rec->length, 5)); break;
+        case 0x20: Sector_Erase(p_rec->addr);                                          break;
+        case 0x50: EWSR();                                                             break;
+#if SST25_BLOCK_32K_SIZE
+        case 0x52: Block_Erase_32K(p_rec->addr);                                       break;
+#endif
+        case 0x60:
+        case 0xC7: Chip_Erase();                                                       break;
+        case 0x90: Read_ID(0);                                                         break;
+        case 0x9F: Jedec_ID_Read();                                                    break;
+        case 0xAA: EHLD();                                                             break;
+        case 0xD8: Block_Erase_64K(p_rec->addr);                                       break;
+        default:
+            // Not modelled: bus time only.
+            flash_sim_stats.time_us += (p_rec->length * 8.0 * 1000000.0) / FLASH_SIM_SPI_HZ;
+            break;
+    }
+    return flash_sim_stats.time_us - before;
+}
+
+static void load(FILE * p_file)
+{
+    char          line[160];
+    bool          in_dump = false;
+    double        tick_us = 1.0;
+    double        t_now   = 0.0;
+    uint32_t      t_prev  = 0;
+    unsigned long size    = 0;
+
+    while (fgets(line, sizeof(line), p_file) != NULL)
+    {
+        unsigned      version, hz, n, lost, op, addr, length, polls, t_start, t_end;
+        const char *  p_hdr = strstr(line, "SST25TRACE ");
+
+        if (p_hdr != NULL)
+        {
+            if ((sscanf(p_hdr, "SST25TRACE %u %u %u %u", &version, &hz, &n, &lost) != 4) ||
+                (version != SST_TRACE_VERSION) || (hz == 0))
+            {
+                fprintf(stderr, "unsupported dump header: %s", line);
+                exit(1);
+            }
+            tick_us = 1000000.0 / hz;
+            m_lost += lost;
+            in_dump = true;
+            continue;
+        }
+        if (!in_dump)
+        {
+            continue;
+        }
+        if (strncmp(line, "END", 3) == 0)
+        {
+            in_dump = false;
+            continue;
+        }
+        if (sscanf(line, "%x %x %u %x %x %u", &op, &addr, &length, &t_start, &t_end, &polls) != 6)
+        {
+            fprintf(stderr, "skipping: %s", line);
+            continue;
+        }
+
+        if (m_count == size)
+        {
+            size   = size ? 2 * size : 1024;
+            m_recs = realloc(m_recs, size * sizeof(*m_recs));
+            if (m_recs == NULL)
+            {
+                perror("realloc");
+                exit(1);
+            }
+        }
+        if (m_count != 0)
+        {
+            t_now += (uint32_t)(t_start - t_prev) * tick_us;
+        }
+        t_prev = t_start;
+
+        m_recs[m_count].op     = (uint8_t)op;
+        m_recs[m_count].addr   = addr;
+        m_recs[m_count].length = length;
+        m_recs[m_count].polls  = polls;
+        m_recs[m_count].t_us   = t_now;
+        m_recs[m_count].dur_us = (uint32_t)(t_end - t_start) * tick_us;
+        m_count++;
+    }
+}
+
+static void print_breakdown(void)
+{
+    unsigned      op;
+    double        measured = 0.0;
+    double        model    = 0.0;
+    double        span     = m_recs[m_count - 1].t_us + m_recs[m_count - 1].dur_us;
+
+    for (op = 0; op < 256; op++)
+    {
+        measured += m_ops[op].measured_us;
+        model    += m_ops[op].model_us;
+    }
+
+    printf("%lu records, %lu lost, span %.3f ms, flash busy %.3f ms (%.1f%%)\n\n",
+           m_count, m_lost, span / 1000.0, measured / 1000.0,
+           (span > 0.0) ? 100.0 * measured / span : 0.0);
+    printf("%-12s %8s %10s %8s %11s %9s %9s %11s %7s %6s\n",
+           "opcode", "count", "bytes", "polls", "time_ms", "avg_us", "max_us", "model_ms", "x_model", "share");
+
+    for (op = 0; op < 256; op++)
+    {
+        const op_stats_t * p_op = &m_ops[op];
+
+        if (p_op->count == 0)
+        {
+            continue;
+        }
+        printf("%02X %-9s %8lu %10lu %8lu %11.3f %9.1f %9.1f %11.3f %7.2f %5.1f%%\n",
+               op, op_name((uint8_t)op), p_op->count, p_op->bytes, p_op->polls,
+               p_op->measured_us / 1000.0, p_op->measured_us / p_op->count, p_op->max_us,
+               p_op->model_us / 1000.0,
+               (p_op->model_us > 0.0) ? p_op->measured_us / p_op->model_us : 0.0,
+               (measured > 0.0) ? 100.0 * p_op->measured_us / measured : 0.0);
+    }
+    printf("%-12s %8s %10s %8s %11.3f %9s %9s %11.3f %7.2f\n\n",
+           "total", "", "", "", measured / 1000.0, "", "", model / 1000.0,
+           (model > 0.0) ? measured / model : 0.0);
+}
+
+static void print_timeline(unsigned long rows)
+{
+    unsigned long i;
+    double        max_us = 0.0;
+
+    for (i = 0; i < m_count; i++)
+    {
+        if (m_recs[i].dur_us > max_us)
+        {
+            max_us = m_recs[i].dur_us;
+        }
+    }
+    if ((rows == 0) || (rows > m_count))
+    {
+        rows = m_count;
+    }
+
+    printf("%12s %10s %10s  %-9s %6s %6s %5s %10s\n",
+           "t_us", "dur_us", "gap_us", "opcode", "addr", "len", "polls", "model_us");
+    for (i = 0; i < rows; i++)
+    {
+        const record_t * p_rec = &m_recs[i];
+        double           gap   = (i == 0) ? 0.0 : p_rec->t_us - (m_recs[i - 1].t_us + m_recs[i - 1].dur_us);
+        int              bar   = (max_us > 0.0) ? (int)(BAR_WIDTH * p_rec->dur_us / max_us + 0.5) : 0;
+
+        printf("%12.1f %10.1f %10.1f  %-9s %06lX %6lu %5lu %10.1f  %.*s\n",
+               p_rec->t_us, p_rec->dur_us, gap, op_name(p_rec->op), p_rec->addr,
+               p_rec->length, p_rec->polls, p_rec->model_us,
+               (bar > 0) ? bar : 1, "########################################");
+    }
+    if (rows < m_count)
+    {
+        printf("... %lu more records, use -n 0 for all\n", m_count - rows);
+    }
+}
+
+int main(int argc, char * argv[])
+{
+    unsigned long rows = 64;
+    unsigned long i;
+    FILE *        p_file;
+    int           arg = 1;
+
+    if ((argc > 2) && (strcmp(argv[1], "-n") == 0))
+    {
+        rows = strtoul(argv[2], NULL, 0);
+        arg  = 3;
+    }
+    if (arg != argc - 1)
+    {
+        fprintf(stderr, "usage: %s [-n timeline_rows] capture.txt\n", argv[0]);
+        return 1;
+    }
+    p_file = fopen(argv[arg], "r");
+    if (p_file == NULL)
+    {
+        perror(argv[arg]);
+        return 1;
+    }
+    load(p_file);
+    fclose(p_file);
+
+    if (m_count == 0)
+    {
+        fprintf(stderr, "no trace records found\n");
+        return 1;
+    }
+
+    flash_sim_reset();
+    memset(m_buf, 0xFF, sizeof(m_buf));
+    for (i = 0; i < m_count; i++)
+    {
+        record_t *   p_rec = &m_recs[i];
+        op_stats_t * p_op  = &m_ops[p_rec->op];
+
+        p_rec->model_us = replay(p_rec);
+        p_op->count++;
+        p_op->bytes       += p_rec->length;
+        p_op->polls       += p_rec->polls;
+        p_op->measured_us += p_rec->dur_us;
+        p_op->model_us    += p_rec->model_us;
+        if (p_rec->dur_us > p_op->max_us)
+        {
+            p_op->max_us = p_rec->dur_us;
+        }
+    }
+
+    print_breakdown();
+    print_timeline(rows);
+    free(m_recs);
+    return 0;
+}
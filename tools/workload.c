@@ -0,0 +1,134 @@
+/**@file
+ * @brief Host runner for the SST25VF064C_workload engine.
+ *
+ * Runs a workload against the simulator and prints the same report as the
+ * firmware. Time is the simulator's modelled bus and array time, so the
+ * figures show what the access pattern costs the flash, not the host.
+ * Options follow fio:
+ *     rw=read|write|rw|randread|randwrite|randrw   (default randread)
+ *     rwmixread=<percent>    reads in rw/randrw    (default 50)
+ *     bs=<bytes>             io size               (default 256)
+ *     iodepth=<n>            reads per batch       (default 1)
+ *     offset=<bytes>         start of the span     (default 0)
+ *     size=<bytes>           span                  (default 1M)
+ *     number_ios=<n>         operations            (default 10000)
+ *     runtime=<ms>           modelled time limit   (default none)
+ *     randseed=<n>                                 (default 1)
+ * Sizes take a k or M suffix.
+ *
+ * Build and run from the tools directory:
+ *     cc -O2 -DSST25VF064C_HOST -DSST_WORKLOAD_SECTORS=2048 -DSST_WORKLOAD_BUF=65536 -I.. -o workload workload.c flash_sim.c ../SST25VF064C_workload.c ../SST25VF064C_readv.c ../SST25VF064C_crc32.c
+ *     ./workload rw=randrw rwmixread=70 bs=64 iodepth=4 size=2M
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "flash_sim.h"
+#include "SST25VF064C_workload.h"
+
+static uint32_t sim_time_us(void)
+{
+    return (uint32_t)flash_sim_stats.time_us;
+}
+
+static void put(uint8_t byte)
+{
+    putchar(byte);
+}
+
+static unsigned long size_arg(const char * p_value)
+{
+    char *        p_end;
+    unsigned long value = strtoul(p_value, &p_end, 0);
+
+    if ((*p_end == 'k') || (*p_end == 'K'))
+    {
+        value *= 1024ul;
+    }
+    else if ((*p_end == 'm') || (*p_end == 'M'))
+    {
+        value *= 1024ul * 1024ul;
+    }
+    return value;
+}
+
+int main(int argc, char ** argv)
+{
+    sst_workload_desc_t   desc;
+    sst_workload_result_t result;
+    const char *          p_rw  = "randread";
+    unsigned long         mix   = 50;
+    int                   arg;
+
+    memset(&desc, 0, sizeof(desc));
+    desc.span        = 1024ul * 1024ul;
+    desc.io_size     = 256;
+    desc.queue_depth = 1;
+    desc.ops         = 10000;
+    desc.seed        = 1;
+
+    for (arg = 1; arg < argc; arg++)
+    {
+        char * p_value = strchr(argv[arg], '=');
+
+        if (p_value == NULL)
+        {
+            fprintf(stderr, "usage: %s [rw=..] [rwmixread=..] [bs=..] [iodepth=..] [offset=..] [size=..] "
+                            "[number_ios=..] [runtime=..] [randseed=..]\n", argv[0]);
+            return 1;
+        }
+        *p_value++ = '\0';
+        if (strcmp(argv[arg], "rw") == 0)               p_rw             = p_value;
+        else if (strcmp(argv[arg], "rwmixread") == 0)   mix              = strtoul(p_value, NULL, 0);
+        else if (strcmp(argv[arg], "bs") == 0)          desc.io_size     = (uint16_t)size_arg(p_value);
+        else if (strcmp(argv[arg], "iodepth") == 0)     desc.queue_depth = (uint8_t)strtoul(p_value, NULL, 0);
+        else if (strcmp(argv[arg], "offset") == 0)      desc.base        = size_arg(p_value);
+        else if (strcmp(argv[arg], "size") == 0)        desc.span        = size_arg(p_value);
+        else if (strcmp(argv[arg], "number_ios") == 0)  desc.ops         = (uint32_t)strtoul(p_value, NULL, 0);
+        else if (strcmp(argv[arg], "runtime") == 0)     desc.duration    = (uint32_t)(strtoul(p_value, NULL, 0) * 1000u);
+        else if (strcmp(argv[arg], "randseed") == 0)    desc.seed        = (uint32_t)strtoul(p_value, NULL, 0);
+        else
+        {
+            fprintf(stderr, "unknown option %s\n", argv[arg]);
+            return 1;
+        }
+    }
+    if (desc.duration != 0)
+    {
+        desc.ops = 0;
+    }
+
+    desc.random = (strncmp(p_rw, "rand", 4) == 0);
+    if (desc.random)
+    {
+        p_rw += 4;
+    }
+    if (strcmp(p_rw, "read") == 0)
+    {
+        desc.read_pct = 100;
+    }
+    else if (strcmp(p_rw, "write") == 0)
+    {
+        desc.read_pct = 0;
+    }
+    else if (strcmp(p_rw, "rw") == 0)
+    {
+        desc.read_pct = (uint8_t)mix;
+    }
+    else
+    {
+        fprintf(stderr, "unknown rw=%s\n", p_rw);
+        return 1;
+    }
+
+    flash_sim_reset();
+    if (SST_Workload_Run(&desc, sim_time_us, 1000000ul, &result) != NRF_SUCCESS)
+    {
+        fprintf(stderr, "workload rejected: check offset, size, bs and iodepth\n");
+        return 1;
+    }
+    SST_Workload_Print(&result, put);
+    printf("transactions=%lu bus_bytes=%lu\n", flash_sim_stats.transactions, flash_sim_stats.bus_bytes);
+    return (result.errors != 0);
+}
@@ -0,0 +1,124 @@
+/**@file
+ * @brief Workload firmware: runs SST25VF064C_workload on the board's flash.
+ *
+ * Target nrf51822_xxaa_workload (256K) of the Keil project. The engine is
+ * timed with TIMER0 at 1 MHz off the crystal and each report is written to
+ * the UART (TX_PIN_NUMBER, 38400 baud) with SST_Workload_Print, so runs of
+ * different driver builds can be compared with tools/workload on the host.
+ * The scratch span at WORKLOAD_BASE is erased and overwritten.
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "nrf.h"
+#include "simple_uart.h"
+#include "boards.h"
+#include "SST25VF064C.h"
+#include "SST25VF064C_workload.h"
+
+#ifndef WORKLOAD_SPAN
+#define WORKLOAD_SPAN   (SST_WORKLOAD_SECTORS * SST25_SECTOR_SIZE)  /**< Scratch span, its content is lost. */
+#endif
+#ifndef WORKLOAD_BASE
+#define WORKLOAD_BASE   (SST25_CAPACITY - WORKLOAD_SPAN)            /**< Top of the device. */
+#endif
+#ifndef WORKLOAD_OPS
+#define WORKLOAD_OPS    2000u                                       /**< Operations per workload. */
+#endif
+
+#define TIMER_HZ        1000000ul
+
+/* The workloads run in turn: random reads, sequential writes, a 70/30 mix. */
+static const sst_workload_desc_t m_desc[] =
+{
+    { WORKLOAD_BASE, WORKLOAD_SPAN, 256, 100, true,  4, WORKLOAD_OPS, 0, 1 },
+    { WORKLOAD_BASE, WORKLOAD_SPAN, 256, 0,   false, 1, WORKLOAD_OPS, 0, 1 },
+    { WORKLOAD_BASE, WORKLOAD_SPAN, 64,  70,  true,  4, WORKLOAD_OPS, 0, 1 },
+};
+
+static sst_workload_result_t m_result;
+
+/**@brief Function for error handling, which is called when an error has occurred.
+ *
+ * @param[in] error_code  Error code supplied to the handler.
+ * @param[in] line_num    Line number where the handler is called.
+ * @param[in] p_file_name Pointer to the file name.
+ */
+void app_error_handler(uint32_t error_code, uint32_t line_num, const uint8_t * p_file_name)
+{
+    for (;;)
+    {
+        //No implementation needed.
+    }
+}
+
+/* TIMER0 free running at 1 MHz, 32 bits, from the HFCLK crystal. */
+static void timer_start(void)
+{
+    NRF_CLOCK->EVENTS_HFCLKSTARTED = 0;
+    NRF_CLOCK->TASKS_HFCLKSTART    = 1;
+    while (NRF_CLOCK->EVENTS_HFCLKSTARTED == 0)
+    {
+        //Wait for the crystal.
+    }
+    NRF_TIMER0->MODE        = TIMER_MODE_MODE_Timer;
+    NRF_TIMER0->BITMODE     = TIMER_BITMODE_BITMODE_32Bit;
+    NRF_TIMER0->PRESCALER   = 4;                            /* 16 MHz / 2^4 */
+    NRF_TIMER0->TASKS_CLEAR = 1;
+    NRF_TIMER0->TASKS_START = 1;
+}
+
+static uint32_t timer_now(void)
+{
+    NRF_TIMER0->TASKS_CAPTURE[0] = 1;
+    return NRF_TIMER0->CC[0];
+}
+
+static void uart_put_str(const char * p_str)
+{
+    while (*p_str)
+    {
+        simple_uart_put((uint8_t)*p_str++);
+    }
+}
+
+/**@brief Function for application main entry. Does not return. */
+int main(void)
+{
+    uint8_t i;
+
+    simple_uart_config(RTS_PIN_NUMBER, TX_PIN_NUMBER, CTS_PIN_NUMBER, RX_PIN_NUMBER, HWFC);
+    timer_start();
+    if (SST25VF064C_init() != NRF_SUCCESS)
+    {
+        uart_put_str("SST25WL init failed\r\n");
+    }
+
+    // Clear the block protection of the scratch span.
+    WP_High();
+#if SST25_HAS_ULBPR
+    WREN();
+    ULBPR();
+#else
+    EWSR();
+    WRSR(0x00);
+#endif
+
+    for (i = 0; i < sizeof(m_desc) / sizeof(m_desc[0]); i++)
+    {
+        if (SST_Workload_Run(&m_desc[i], timer_now, TIMER_HZ, &m_result) == NRF_SUCCESS)
+        {
+            SST_Workload_Print(&m_result, simple_uart_put);
+        }
+        else
+        {
+            uart_put_str("SST25WL invalid workload\r\n");
+        }
+    }
+    uart_put_str("SST25WL done\r\n");
+
+    for (;;)
+    {
+        __WFE();
+    }
+}